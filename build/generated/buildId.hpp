@@ -0,0 +1 @@
+#define BANT_BUILD_ID "1014117931"
@@ -1,102 +1,252 @@
 #include "builtinDefinitions.hpp"
 
-const std::vector<std::string> BuiltinDefinitions::builtinNames{
-    "insert", "remove", "replace", 
-    "pushFront", "pushBack",
-    "insertInPlace", "removeInPlace", "replaceInPlace",
-    "pushFrontInPlace", "pushBackInPlace",
-    "front", "back",
-    "head", "tail",
-    "combine", "append", "size",
-    "range", "isEmpty",
-    "sum", "product", "max", "min", "sortlh", "sorthl",
-    "contains", "find",
-    "map", "filter", "foreach",
-    "generate", "fill", "reverse",
-    "foldl", "foldr",
-    "zip", "union", "intersect", "equals",
-    "intToString", "stringToInt", "stringToCharList", "charListToString",
-    "printInt", "printBool",
-    "printList", "print2Tuple", "print3Tuple", "print4Tuple",
-    "readChar", "printChar",
-    "readString", "printString",
-    "concat", "substr", "charAt",
-    "rand", "printType", "halt"
-};
-
-int
-BuiltinDefinitions::builtinNumber() {
-    return static_cast<int>(BuiltinEnums::BUILTINNUM);
-}
+#include <array>
+#include <cstdint>
+
+namespace {
+    using Definition = BuiltinDefinitions::Definition;
+
+    constexpr std::size_t BUILTIN_COUNT = static_cast<std::size_t>(BuiltinDefinitions::BuiltinEnums::BUILTINNUM);
+
+    // parameters of "[T](a: T, f: (T) -> T) -> T", commas inside brackets
+    // and parentheses belong to the parameter they are in
+    constexpr int
+    countParameters(const std::string_view & signature) {
+        std::size_t position = signature.find('(');
+        int depth = 0;
+        int parameters = 0;
+        for (++position; position < signature.size(); ++position) {
+            auto character = signature[position];
+            if (character == '(' || character == '[') {
+                ++depth;
+            } else if (character == ']' || (character == ')' && depth > 0)) {
+                --depth;
+            } else if (character == ')') {
+                break;
+            } else if (character == ':' && depth == 0) {
+                ++parameters;
+            }
+        }
+        return parameters;
+    }
+
+    // Reads a signature with the grammar the prelude builds functions from:
+    //   signature := ["[" name {"," name} "]"] "(" [name ":" type {"," name ":" type}] ")" "->" type
+    //   type      := "(" type {"," type} ")" "->" type
+    //              | ("List" | "Set") "[" type "]" | "Map" "[" type "," type "]"
+    //              | "Tuple" "[" type {"," type} "]"
+    //              | ("int" | "bool" | "char" | "string" | "null" | generic) ["->" type]
+    // so a malformed line in BANT_BUILTINS fails the build rather than a run
+    class SignatureChecker {
+        public:
+            static constexpr std::size_t MAX_GENERICS = 8;
+
+            std::string_view text;
+            std::size_t position = 0;
+            std::array<std::string_view, MAX_GENERICS> generics{};
+            std::size_t genericCount = 0;
+
+            constexpr explicit SignatureChecker(const std::string_view & text)
+            : text(text) { }
+
+            constexpr bool
+            isWellFormed() {
+                if (match("[")) {
+                    do {
+                        auto generic = readName();
+                        if (generic.empty() || genericCount == MAX_GENERICS) {
+                            return false;
+                        }
+                        generics[genericCount++] = generic;
+                    } while (match(","));
+                    if (!match("]")) {
+                        return false;
+                    }
+                }
+
+                if (!match("(")) {
+                    return false;
+                }
+                if (!match(")")) {
+                    do {
+                        if (readName().empty() || !match(":") || !isType()) {
+                            return false;
+                        }
+                    } while (match(","));
+                    if (!match(")")) {
+                        return false;
+                    }
+                }
+                return match("->") && isType() && atEnd();
+            }
+
+        private:
+            constexpr bool
+            isType() {
+                if (match("(")) {
+                    do {
+                        if (!isType()) {
+                            return false;
+                        }
+                    } while (match(","));
+                    return match(")") && match("->") && isType();
+                }
+
+                auto typeName = readName();
+                if (typeName == "List" || typeName == "Set") {
+                    return match("[") && isType() && match("]");
+                } else if (typeName == "Map") {
+                    return match("[") && isType() && match(",") && isType() && match("]");
+                } else if (typeName == "Tuple") {
+                    if (!match("[")) {
+                        return false;
+                    }
+                    do {
+                        if (!isType()) {
+                            return false;
+                        }
+                    } while (match(","));
+                    return match("]");
+                }
+
+                if (typeName != "int" && typeName != "bool" && typeName != "char" &&
+                    typeName != "string" && typeName != "null" && !isGeneric(typeName)) {
+                    return false;
+                }
+                return !match("->") || isType();
+            }
+
+            constexpr bool
+            isGeneric(const std::string_view & name) const {
+                for (std::size_t index = 0; index < genericCount; ++index) {
+                    if (generics[index] == name) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            constexpr std::string_view
+            readName() {
+                skipSpaces();
+                auto start = position;
+                while (position < text.size() && isNameCharacter(text[position])) {
+                    ++position;
+                }
+                return text.substr(start, position - start);
+            }
+
+            static constexpr bool
+            isNameCharacter(const char character) {
+                return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+                       (character >= '0' && character <= '9') || character == '_';
+            }
+
+            constexpr bool
+            match(const std::string_view & expected) {
+                skipSpaces();
+                if (text.substr(position, expected.size()) == expected) {
+                    position += expected.size();
+                    return true;
+                }
+                return false;
+            }
 
-const std::string BuiltinDefinitions::builtinDefinitions = 
-R"(func insert[T](l: List[T], e: T, index: int) -> List[T] = { 0 };
-func remove[T](l: List[T], index: int) -> List[T] = { 0 };
-func replace[T](l: List[T], e: T, index: int) -> List[T] = { 0 };
-func pushFront[T](l: List[T], e: T) -> List[T] = { 0 };
-func pushBack[T](l: List[T], e: T) -> List[T] = { 0 };
-func insertInPlace[T](l: List[T], e: T, index: int) -> List[T] = { 0 };
-func removeInPlace[T](l: List[T], index: int) -> List[T] = { 0 };
-func replaceInPlace[T](l: List[T], e: T, index: int) -> List[T] = { 0 };
-func pushFrontInPlace[T](l: List[T], e: T) -> List[T] = { 0 };
-func pushBackInPlace[T](l: List[T], e: T) -> List[T] = { 0 };
-func front[T](l: List[T]) -> T = { 0 };
-func back[T](l: List[T]) -> T = { 0 };
-func head[T](l: List[T]) -> List[T] = { 0 };
-func tail[T](l: List[T]) -> List[T] = { 0 };
-func combine[T](l1: List[T], l2: List[T]) -> List[T] = { 0 };
-func append[T](l1: List[T], l2: List[T]) -> List[T] = { 0 };
-func size[T](l: List[T]) -> int = { 0 };
-func range[T](l: List[T], i: int, j: int) -> List[T] = { 0 };
-func isEmpty[T](l: List[T]) -> bool = { 0 };
-func sum(l: List[int]) -> int = { 0 };
-func product(l: List[int]) -> int = { 0 };
-func max(l: List[int]) -> int = { 0 };
-func min(l: List[int]) -> int = { 0 };
-func sortlh(l: List[int]) -> List[int] = { 0 };
-func sorthl(l: List[int]) -> List[int] = { 0 };
-func contains[T](l: List[T], e: T) -> bool = { 0 };
-func find[T](l: List[T], e: T) -> int = { 0 };
-func map[T, U](l: List[T], f: (T) -> U) -> List[U] = { 0 };
-func filter[T](l: List[T], f: (T) -> bool) -> List[T] = { 0 };
-func foreach[T](l: List[T], f: (T) -> null) -> null = { 0 };
-func generate(l: int, u: int, f: (int) -> int) -> List[int] = { 0 };
-func fill[T](e: T, s: int) -> List[T] = { 0 };
-func reverse[T](l: List[T]) -> List[T] = { 0 };
-func foldl[T](l: List[T], i: T, f: (T, T) -> T) -> T = { 0 };
-func foldr[T](l: List[T], i: T, f: (T, T) -> T) -> T = { 0 };
-func zip[T, U](l1: List[T], l2: List[U]) -> List[Tuple[T, U]] = { 0 };
-func union[T](l1: List[T], l2: List[T]) -> List[T] = { 0 };
-func intersect[T](l1: List[T], l2: List[T]) -> List[T] = { 0 };
-func equals[T](v1: T, v2: T) -> bool = { 0 };
-func intToString(i: int) -> string = { 0 };
-func stringToInt(s: string) -> int = { 0 };
-func stringToCharList(s: string) -> List[char] = { 0 };
-func charListToString(l: List[char]) -> string = { 0 };
-func printInt(i: int) -> null = { 0 };
-func printBool(b: bool) -> null = { 0 };
-func printList[T](l: List[T]) -> null = { 0 };
-func print2Tuple[T, U](t: Tuple[T, U]) -> null = { 0 };
-func print3Tuple[T, U, V](t: Tuple[T, U, V]) -> null = { 0 };
-func print4Tuple[T, U, V, W](t: Tuple[T, U, V, W]) -> null = { 0 };
-func readChar() -> char = { 0 };
-func printChar(c: char) -> null = { 0 };
-func readString() -> string = { 0 };
-func printString(s: string) -> null = { 0 };
-func concat(s1: string, s2: string) -> string = { 0 };
-func substr(s: string, start: int, end: int) -> string = { 0 };
-func charAt(s: string, i: int) -> char = { 0 };
-func rand(l: int, u: int) -> int = { 0 };
-func printType[T](exp: T) -> null = { 0 };
-func halt() -> null = { 0 };
-)";
+            constexpr bool
+            atEnd() {
+                skipSpaces();
+                return position == text.size();
+            }
+
+            constexpr void
+            skipSpaces() {
+                while (position < text.size() && text[position] == ' ') {
+                    ++position;
+                }
+            }
+    };
+
+    #define BUILTIN_SIGNATURE_CHECK(builtinEnum, name, effects, signature) \
+        static_assert(SignatureChecker(signature).isWellFormed(), "malformed signature for builtin " #name);
+    BANT_BUILTINS(BUILTIN_SIGNATURE_CHECK)
+    #undef BUILTIN_SIGNATURE_CHECK
+
+    #define BUILTIN_DEFINITION(builtinEnum, name, effects, signature) \
+        {#name, signature, countParameters(signature), BuiltinDefinitions::Effects::effects},
+    constexpr std::array<Definition, BUILTIN_COUNT> definitions{{
+        BANT_BUILTINS(BUILTIN_DEFINITION)
+    }};
+    #undef BUILTIN_DEFINITION
+
+    // Names are found with a perfect hash: a seed, searched for at compile
+    // time, under which no two builtin names share a slot. A lookup is one
+    // hash and at most one comparison.
+    constexpr std::size_t SLOT_COUNT = 1024;
+    constexpr std::uint8_t EMPTY_SLOT = UINT8_MAX;
+    static_assert(BUILTIN_COUNT < EMPTY_SLOT, "builtin indices no longer fit a slot");
+    static_assert(BUILTIN_COUNT * 8 <= SLOT_COUNT, "too many builtins for the slots to stay sparse");
+
+    constexpr std::size_t
+    slotOf(const std::string_view & name, const std::uint64_t seed) {
+        std::uint64_t hash = 14695981039346656037ull ^ seed;
+        for (auto character : name) {
+            hash ^= static_cast<unsigned char>(character);
+            hash *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(hash ^ (hash >> 32)) & (SLOT_COUNT - 1);
+    }
+
+    class NameTable {
+        public:
+            std::uint64_t seed = 0;
+            std::array<std::uint8_t, SLOT_COUNT> slots{};
+    };
+
+    constexpr NameTable
+    makeNameTable() {
+        NameTable nameTable;
+        for (nameTable.seed = 0; nameTable.seed < 100000; ++nameTable.seed) {
+            for (auto & slot : nameTable.slots) {
+                slot = EMPTY_SLOT;
+            }
+
+            bool collided = false;
+            for (std::size_t index = 0; index < BUILTIN_COUNT && !collided; ++index) {
+                auto & slot = nameTable.slots[slotOf(definitions[index].name, nameTable.seed)];
+                collided = (slot != EMPTY_SLOT);
+                slot = static_cast<std::uint8_t>(index);
+            }
+            if (!collided) {
+                break;
+            }
+        }
+        return nameTable;
+    }
+
+    constexpr NameTable nameTable = makeNameTable();
+    static_assert(nameTable.seed < 100000, "no seed separates the builtin names");
+}
 
 bool
-BuiltinDefinitions::isBuiltin(const std::string & functionIdent) {
-    return (std::find(builtinNames.begin(), builtinNames.end(), functionIdent) != builtinNames.end());
+BuiltinDefinitions::isBuiltin(const std::string_view & functionIdent) {
+    return getBuiltin(functionIdent) != BuiltinEnums::BUILTINNUM;
 }
 
 BuiltinDefinitions::BuiltinEnums
-BuiltinDefinitions::getBuiltin(const std::string & builtinName) {
-    return (static_cast<BuiltinEnums>(std::distance(builtinNames.begin(), std::find(builtinNames.begin(), builtinNames.end(), builtinName))));
-}
\ No newline at end of file
+BuiltinDefinitions::getBuiltin(const std::string_view & builtinName) {
+    auto index = nameTable.slots[slotOf(builtinName, nameTable.seed)];
+    if (index == EMPTY_SLOT || definitions[index].name != builtinName) {
+        return BuiltinEnums::BUILTINNUM;
+    }
+    return static_cast<BuiltinEnums>(index);
+}
+
+const BuiltinDefinitions::Definition &
+BuiltinDefinitions::getDefinition(const BuiltinEnums & builtinEnum) {
+    return definitions.at(static_cast<std::size_t>(builtinEnum));
+}
+
+bool
+BuiltinDefinitions::hasEffects(const BuiltinEnums & builtinEnum) {
+    return getDefinition(builtinEnum).effects == Effects::EFFECTS;
+}
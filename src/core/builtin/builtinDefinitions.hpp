@@ -1,44 +1,125 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 
-class BuiltinDefinitions {
-    private:
-        static const std::vector<std::string> builtinNames;
+// Every builtin as BUILTIN(enum, name, effects, signature), in BuiltinEnums
+// order. The enum, the name lookup, the prelude's signatures, which builtins
+// have effects and the dispatch table of BuiltinImplementations, which calls
+// nameBuiltin, are all made from this one list, so adding a builtin is adding
+// its line and its implementation. effects is EFFECTS if calling it does
+// I/O, draws a random number or changes a list in place, so that two calls
+// with the same arguments can differ, and PURE otherwise.
+#define BANT_BUILTINS(BUILTIN) \
+    BUILTIN(INSERT, insert,                     PURE,    "[T](l: List[T], e: T, index: int) -> List[T]") \
+    BUILTIN(REMOVE, remove,                     PURE,    "[T](l: List[T], index: int) -> List[T]") \
+    BUILTIN(REPLACE, replace,                   PURE,    "[T](l: List[T], e: T, index: int) -> List[T]") \
+    BUILTIN(PUSHFRONT, pushFront,               PURE,    "[T](l: List[T], e: T) -> List[T]") \
+    BUILTIN(PUSHBACK, pushBack,                 PURE,    "[T](l: List[T], e: T) -> List[T]") \
+    BUILTIN(INSERTINPLACE, insertInPlace,       EFFECTS, "[T](l: List[T], e: T, index: int) -> List[T]") \
+    BUILTIN(REMOVEINPLACE, removeInPlace,       EFFECTS, "[T](l: List[T], index: int) -> List[T]") \
+    BUILTIN(REPLACEINPLACE, replaceInPlace,     EFFECTS, "[T](l: List[T], e: T, index: int) -> List[T]") \
+    BUILTIN(PUSHFRONTINPLACE, pushFrontInPlace, EFFECTS, "[T](l: List[T], e: T) -> List[T]") \
+    BUILTIN(PUSHBACKINPLACE, pushBackInPlace,   EFFECTS, "[T](l: List[T], e: T) -> List[T]") \
+    BUILTIN(FRONT, front,                       PURE,    "[T](l: List[T]) -> T") \
+    BUILTIN(BACK, back,                         PURE,    "[T](l: List[T]) -> T") \
+    BUILTIN(HEAD, head,                         PURE,    "[T](l: List[T]) -> List[T]") \
+    BUILTIN(TAIL, tail,                         PURE,    "[T](l: List[T]) -> List[T]") \
+    BUILTIN(COMBINE, combine,                   PURE,    "[T](l1: List[T], l2: List[T]) -> List[T]") \
+    BUILTIN(APPEND, append,                     PURE,    "[T](l1: List[T], l2: List[T]) -> List[T]") \
+    BUILTIN(SIZE, size,                         PURE,    "[T](l: List[T]) -> int") \
+    BUILTIN(RANGE, range,                       PURE,    "[T](l: List[T], i: int, j: int) -> List[T]") \
+    BUILTIN(ISEMPTY, isEmpty,                   PURE,    "[T](l: List[T]) -> bool") \
+    BUILTIN(SUM, sum,                           PURE,    "(l: List[int]) -> int") \
+    BUILTIN(PRODUCT, product,                   PURE,    "(l: List[int]) -> int") \
+    BUILTIN(MAX, max,                           PURE,    "(l: List[int]) -> int") \
+    BUILTIN(MIN, min,                           PURE,    "(l: List[int]) -> int") \
+    BUILTIN(SORTLH, sortlh,                     EFFECTS, "(l: List[int]) -> List[int]") \
+    BUILTIN(SORTHL, sorthl,                     EFFECTS, "(l: List[int]) -> List[int]") \
+    BUILTIN(CONTAINS, contains,                 PURE,    "[T](l: List[T], e: T) -> bool") \
+    BUILTIN(FIND, find,                         PURE,    "[T](l: List[T], e: T) -> int") \
+    BUILTIN(MAP, map,                           PURE,    "[T, U](l: List[T], f: (T) -> U) -> List[U]") \
+    BUILTIN(FILTER, filter,                     PURE,    "[T](l: List[T], f: (T) -> bool) -> List[T]") \
+    BUILTIN(FOREACH, foreach,                   PURE,    "[T](l: List[T], f: (T) -> null) -> null") \
+    BUILTIN(GENERATE, generate,                 PURE,    "(l: int, u: int, f: (int) -> int) -> List[int]") \
+    BUILTIN(FILL, fill,                         PURE,    "[T](e: T, s: int) -> List[T]") \
+    BUILTIN(REVERSE, reverse,                   EFFECTS, "[T](l: List[T]) -> List[T]") \
+    BUILTIN(FOLDL, foldl,                       PURE,    "[T](l: List[T], i: T, f: (T, T) -> T) -> T") \
+    BUILTIN(FOLDR, foldr,                       PURE,    "[T](l: List[T], i: T, f: (T, T) -> T) -> T") \
+    BUILTIN(PMAP, pmap,                         PURE,    "[T, U](l: List[T], f: (T) -> U) -> List[U]") \
+    BUILTIN(PFILTER, pfilter,                   PURE,    "[T](l: List[T], f: (T) -> bool) -> List[T]") \
+    BUILTIN(PGENERATE, pgenerate,               PURE,    "(l: int, u: int, f: (int) -> int) -> List[int]") \
+    BUILTIN(PREDUCE, preduce,                   PURE,    "[T](l: List[T], i: T, f: (T, T) -> T) -> T") \
+    BUILTIN(ZIP, zip,                           PURE,    "[T, U](l1: List[T], l2: List[U]) -> List[Tuple[T, U]]") \
+    BUILTIN(UNION, union,                       PURE,    "[T](l1: List[T], l2: List[T]) -> List[T]") \
+    BUILTIN(INTERSECT, intersect,               PURE,    "[T](l1: List[T], l2: List[T]) -> List[T]") \
+    BUILTIN(EQUALS, equals,                     PURE,    "[T](v1: T, v2: T) -> bool") \
+    BUILTIN(TOSET, toSet,                       PURE,    "[T](l: List[T]) -> Set[T]") \
+    BUILTIN(SETINSERT, setInsert,               PURE,    "[T](s: Set[T], e: T) -> Set[T]") \
+    BUILTIN(SETREMOVE, setRemove,               PURE,    "[T](s: Set[T], e: T) -> Set[T]") \
+    BUILTIN(SETCONTAINS, setContains,           PURE,    "[T](s: Set[T], e: T) -> bool") \
+    BUILTIN(SETSIZE, setSize,                   PURE,    "[T](s: Set[T]) -> int") \
+    BUILTIN(SETTOLIST, setToList,               PURE,    "[T](s: Set[T]) -> List[T]") \
+    BUILTIN(TOMAP, toMap,                       PURE,    "[K, V](l: List[Tuple[K, V]]) -> Map[K, V]") \
+    BUILTIN(MAPINSERT, mapInsert,               PURE,    "[K, V](m: Map[K, V], k: K, v: V) -> Map[K, V]") \
+    BUILTIN(MAPREMOVE, mapRemove,               PURE,    "[K, V](m: Map[K, V], k: K) -> Map[K, V]") \
+    BUILTIN(MAPCONTAINS, mapContains,           PURE,    "[K, V](m: Map[K, V], k: K) -> bool") \
+    BUILTIN(MAPGET, mapGet,                     PURE,    "[K, V](m: Map[K, V], k: K) -> V") \
+    BUILTIN(MAPSIZE, mapSize,                   PURE,    "[K, V](m: Map[K, V]) -> int") \
+    BUILTIN(MAPKEYS, mapKeys,                   PURE,    "[K, V](m: Map[K, V]) -> List[K]") \
+    BUILTIN(MAPVALUES, mapValues,               PURE,    "[K, V](m: Map[K, V]) -> List[V]") \
+    BUILTIN(INTTOSTRING, intToString,           PURE,    "(i: int) -> string") \
+    BUILTIN(STRINGTOINT, stringToInt,           PURE,    "(s: string) -> int") \
+    BUILTIN(STRINGTOCHARLIST, stringToCharList, PURE,    "(s: string) -> List[char]") \
+    BUILTIN(CHARLISTTOSTRING, charListToString, PURE,    "(l: List[char]) -> string") \
+    BUILTIN(PRINTINT, printInt,                 EFFECTS, "(i: int) -> null") \
+    BUILTIN(PRINTBOOL, printBool,               EFFECTS, "(b: bool) -> null") \
+    BUILTIN(PRINTLIST, printList,               EFFECTS, "[T](l: List[T]) -> null") \
+    BUILTIN(PRINT2TUPLE, print2Tuple,           EFFECTS, "[T, U](t: Tuple[T, U]) -> null") \
+    BUILTIN(PRINT3TUPLE, print3Tuple,           EFFECTS, "[T, U, V](t: Tuple[T, U, V]) -> null") \
+    BUILTIN(PRINT4TUPLE, print4Tuple,           EFFECTS, "[T, U, V, W](t: Tuple[T, U, V, W]) -> null") \
+    BUILTIN(READCHAR, readChar,                 EFFECTS, "() -> char") \
+    BUILTIN(PRINTCHAR, printChar,               EFFECTS, "(c: char) -> null") \
+    BUILTIN(READSTRING, readString,             EFFECTS, "() -> string") \
+    BUILTIN(PRINTSTRING, printString,           EFFECTS, "(s: string) -> null") \
+    BUILTIN(CONCAT, concat,                     PURE,    "(s1: string, s2: string) -> string") \
+    BUILTIN(SUBSTR, substr,                     PURE,    "(s: string, start: int, end: int) -> string") \
+    BUILTIN(CHARAT, charAt,                     PURE,    "(s: string, i: int) -> char") \
+    BUILTIN(RAND, rand,                         EFFECTS, "(l: int, u: int) -> int") \
+    BUILTIN(PRINTTYPE, printType,               EFFECTS, "[T](exp: T) -> null") \
+    BUILTIN(HALT, halt,                         EFFECTS, "() -> null") \
+    BUILTIN(READFILE, readFile,                 EFFECTS, "(path: string) -> string") \
+    BUILTIN(READLINES, readLines,               EFFECTS, "(path: string) -> List[string]") \
+    BUILTIN(WRITEFILE, writeFile,               EFFECTS, "(path: string, lines: List[string]) -> bool")
 
+class BuiltinDefinitions {
     public:
+        #define BUILTIN_ENUM(builtinEnum, name, effects, signature) builtinEnum,
         enum class BuiltinEnums {
-            INSERT, REMOVE, REPLACE,
-            PUSHFRONT, PUSHBACK,
-            INSERTINPLACE, REMOVEINPLACE, REPLACEINPLACE,
-            PUSHFRONTINPLACE, PUSHBACKINPLACE, 
-            FRONT, BACK,
-            HEAD, TAIL,
-            COMBINE, APPEND, SIZE,
-            RANGE, ISEMPTY,
-            SUM, PRODUCT, MAX, MIN, SORTLH, SORTHL,
-            CONTAINS, FIND,
-            MAP, FILTER, FOREACH,
-            GENERATE, FILL, REVERSE,
-            FOLDL, FOLDR,
-            ZIP, UNION, INTERSECT, EQUALS,
-            INTTOSTRING, STRINGTOINT, STRINGTOCHARLIST, CHARLISTTOSTRING,
-            PRINTINT,
-            PRINTBOOL,
-            PRINTLIST, PRINT2TUPLE, PRINT3TUPLE, PRINT4TUPLE,
-            READCHAR, PRINTCHAR,
-            READSTRING, PRINTSTRING,
-            CONCAT, SUBSTR, CHARAT,
-            RAND, PRINTTYPE, HALT,
-            BUILTINNUM = HALT + 1
+            BANT_BUILTINS(BUILTIN_ENUM)
+            BUILTINNUM
         };
+        #undef BUILTIN_ENUM
 
-        static int builtinNumber();
+        enum class Effects {
+            PURE,
+            EFFECTS
+        };
 
-        static const std::string builtinDefinitions;
+        class Definition {
+            public:
+                std::string_view name;
+                std::string_view signature;
+                int arity;
+                Effects effects;
+        };
 
-        static bool isBuiltin(const std::string & functionIdent);
-        static BuiltinEnums getBuiltin(const std::string & builtinName);
+        static bool isBuiltin(const std::string_view & functionIdent);
+        // BUILTINNUM if builtinName is not a builtin
+        static BuiltinEnums getBuiltin(const std::string_view & builtinName);
+        static const Definition & getDefinition(const BuiltinEnums & builtinEnum);
+        // whether it is marked EFFECTS in BANT_BUILTINS
+        static bool hasEffects(const BuiltinEnums & builtinEnum);
 };
\ No newline at end of file
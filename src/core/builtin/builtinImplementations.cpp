@@ -1,487 +1,376 @@
 #include "builtinImplementations.hpp"
-
-Interpreter BuiltinImplementations::interpreter{nullptr};
-
-Values::ValuePtr
-BuiltinImplementations::runBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::INSERT) {
-        return insertBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::REMOVE) {
-        return removeBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::REPLACE) {
-        return replaceBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PUSHFRONT) {
-        return pushFrontBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PUSHBACK) {
-        return pushBackBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::INSERTINPLACE) {
-        return insertInPlaceBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::REMOVEINPLACE) {
-        return removeInPlaceBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::REPLACEINPLACE) {
-        return replaceInPlaceBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PUSHFRONTINPLACE) {
-        return pushFrontInPlaceBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PUSHBACKINPLACE) {
-        return pushBackInPlaceBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FRONT) {
-        return frontBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::BACK) {
-        return backBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::HEAD) {
-        return headBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::TAIL) {
-        return tailBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::COMBINE) {
-        return combineBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::APPEND) {
-        return appendBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::SIZE) {
-        return sizeBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::RANGE) {
-        return rangeBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::ISEMPTY) {
-        return isEmptyBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::SUM) {
-        return sumBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRODUCT) {
-        return productBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::MAX) {
-        return maxBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::MIN) {
-        return minBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::SORTLH) {
-        return sortlhBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::SORTHL) {
-        return sorthlBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::CONTAINS) {
-        return containsBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FIND) {
-        return findBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::MAP) {
-       return mapBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FILTER) {
-       return filterBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FOREACH) {
-       return foreachBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::GENERATE) {
-        return generateBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FILL) {
-        return fillBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::REVERSE) {
-        return reverseBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FOLDL) {
-        return foldlBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::FOLDR) {
-        return foldrBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::ZIP) {
-        return zipBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::UNION) {
-        return unionBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::INTERSECT) {
-        return intersectBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::EQUALS) {
-        return equalsBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTLIST) {
-        return printListBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINT2TUPLE) {
-        return print2TupleBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINT3TUPLE) {
-        return print3TupleBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINT4TUPLE) {
-        return print4TupleBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::INTTOSTRING) {
-        return intToStringBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::STRINGTOINT) {
-        return stringToIntBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::STRINGTOCHARLIST) {
-        return stringToCharListBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::CHARLISTTOSTRING) {
-        return charListToStringBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTINT) {
-        return printIntBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTBOOL) {
-        return printBoolBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::READCHAR) {
-        return readCharBuiltin(functionValue);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTCHAR) {
-        return printCharBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::READSTRING) {
-        return readStringBuiltin(functionValue);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTSTRING) {
-        return printStringBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::CONCAT) {
-        return concatBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::SUBSTR) {
-        return substrBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::CHARAT) {
-        return charAtBuiltin(token, functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::RAND) {
-        return randBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::PRINTTYPE) {
-        return printTypeBuiltin(functionValue, environment);
-    } else if (functionValue->builtinEnum == BuiltinDefinitions::BuiltinEnums::HALT) {
-        return haltBuiltin(functionValue);
+#include "../interpreter/interpreter.hpp"
+#include "listKernels.hpp"
+#include "../../utils/mappedFile.hpp"
+#include "../../utils/output.hpp"
+
+#include <fstream>
+
+namespace {
+    // writeFile hands its lines to the file this many bytes at a time
+    constexpr std::size_t WRITE_BLOCK_SIZE = 1 << 16;
+}
+
+#define BUILTIN_IMPLEMENTATION(builtinEnum, name, effects, signature) &adapt<&name##Builtin>,
+const std::array<BuiltinImplementations::Implementation, static_cast<std::size_t>(BuiltinDefinitions::BuiltinEnums::BUILTINNUM)>
+BuiltinImplementations::implementations{{
+    BANT_BUILTINS(BUILTIN_IMPLEMENTATION)
+}};
+#undef BUILTIN_IMPLEMENTATION
+
+Values::Value
+BuiltinImplementations::runBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto index = static_cast<std::size_t>(functionValue->builtinEnum);
+    if (index >= implementations.size()) {
+        return Values::makeNull();
     }
-    return nullValue;
+    return implementations[index](token, functionValue, environment, evaluator);
+}
+
+// Runs body over [0, count) on the thread pool. Each range applies functions
+// with an evaluator of its own, forked from the one that called, so only the
+// values passed in and out are shared. The calling evaluator's frames stay
+// untouched until every range is done, which is what makes reading them
+// from the workers safe.
+void
+BuiltinImplementations::parallelFor(const Evaluator & evaluator, std::size_t count, const RangeBody & body) {
+    Collector::ParallelSection parallelSection;
+    ThreadPool::instance().parallelFor(count, [&evaluator, &body, &parallelSection](std::size_t begin, std::size_t end) {
+        Collector::ParallelSection::Range range(parallelSection);
+        auto rangeEvaluator = evaluator.fork();
+        body(*rangeEvaluator, begin, end);
+    });
 }
 
 template<class ValueType>
 std::shared_ptr<ValueType>
 BuiltinImplementations::getArgumentValue(const int & index, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    return std::static_pointer_cast<ValueType>(environment->at(functionValue->parameterNames.at(index)));
+    return environment->slots.at(index).as<ValueType>();
+}
+
+const Values::Value &
+BuiltinImplementations::getArgument(const int & index, Values::Environment & environment) {
+    return environment->slots.at(index);
 }
 
 Values::ListValuePtr
-BuiltinImplementations::makeListType(Values::ListValuePtr listValue, std::vector<Values::ValuePtr> listData) {
-    return std::make_shared<Values::ListValue>(std::make_shared<Types::ListType>(std::static_pointer_cast<Types::ListType>(listValue->type)->listType), listData);
+BuiltinImplementations::makeListType(Values::ListValuePtr listValue, const Values::ListData & listData) {
+    return std::make_shared<Values::ListValue>(Types::intern(listValue->type), listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::insertBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
-    unsigned int index = getArgumentValue<Values::IntValue>(2, functionValue, environment)->data;
+    unsigned int index = getArgument(2, environment).intData();
     
     if (!listValue->listData.empty() && index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     auto listData = listValue->listData;
-    listData.insert(listData.begin() + index, elementValue);
+    listData.insert(index, elementValue);
 
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::removeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot remove from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot remove from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    unsigned int index = getArgumentValue<Values::IntValue>(1, functionValue, environment)->data;
+    unsigned int index = getArgument(1, environment).intData();
     
     if (index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     auto listData = listValue->listData;
-    listData.erase(listData.begin() + index);
+    listData.erase(index);
 
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::replaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot replace with element in empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot replace with element in empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    unsigned int index = getArgumentValue<Values::IntValue>(2, functionValue, environment)->data;
+    unsigned int index = getArgument(2, environment).intData();
     
     if (index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
     auto listData = listValue->listData;
-    listData.at(index) = elementValue;
+    listData.set(index, elementValue);
 
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::pushFrontBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
     auto listData = listValue->listData;
-    listData.insert(listData.begin(), elementValue);
+    listData.pushFront(elementValue);
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::pushBackBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
     auto listData = listValue->listData;
-    listData.insert(listData.begin() + listData.size(), elementValue);
+    listData.pushBack(elementValue);
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::insertInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
-    unsigned int index = getArgumentValue<Values::IntValue>(2, functionValue, environment)->data;
+    unsigned int index = getArgument(2, environment).intData();
     
     if (!listValue->listData.empty() && index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    listValue->listData.insert(listValue->listData.begin() + index, elementValue);
+    listValue->listData.insert(index, elementValue);
 
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::removeInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot remove from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot remove from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    unsigned int index = getArgumentValue<Values::IntValue>(1, functionValue, environment)->data;
+    unsigned int index = getArgument(1, environment).intData();
     
     if (index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    listValue->listData.erase(listValue->listData.begin() + index);
+    listValue->listData.erase(index);
 
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::replaceInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot replace with element in empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot replace with element in empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    unsigned int index = getArgumentValue<Values::IntValue>(2, functionValue, environment)->data;
+    unsigned int index = getArgument(2, environment).intData();
     
     if (index >= listValue->listData.size()) {
-        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Out of bounds list access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
-    listValue->listData.at(index) = elementValue;
+    listValue->listData.set(index, elementValue);
 
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::pushFrontInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
-    listValue->listData.insert(listValue->listData.begin(), elementValue);
+    listValue->listData.pushFront(elementValue);
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::pushBackInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto elementValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto elementValue = getArgument(1, environment);
 
-    listValue->listData.insert(listValue->listData.begin() + listValue->listData.size(), elementValue);
+    listValue->listData.pushBack(elementValue);
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::frontBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot get element from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot get element from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     return listValue->listData.at(0);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::backBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot get element from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot get element from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     return listValue->listData.at(listValue->listData.size() - 1);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::headBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     auto listData = listValue->listData;
-    listData.pop_back();
+    listData.popBack();
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::tailBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
     auto listData = listValue->listData;
-    listData.erase(listData.begin());
+    listData.popFront();
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::combineBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue1 = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto listValue2 = getArgumentValue<Values::ListValue>(1, functionValue, environment);
 
     auto combinedListData = listValue1->listData;
-    combinedListData.insert(combinedListData.end(), listValue2->listData.begin(), listValue2->listData.end());
+    combinedListData.append(listValue2->listData);
     return makeListType(listValue1, combinedListData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::appendBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue1 = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto listValue2 = getArgumentValue<Values::ListValue>(1, functionValue, environment);
 
-    listValue1->listData.insert(listValue1->listData.end(), listValue2->listData.begin(), listValue2->listData.end());
+    listValue1->listData.append(listValue2->listData);
     return listValue1;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::sizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), listValue->listData.size());
+    return Values::makeInt(listValue->listData.size());
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::rangeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto startValue = getArgumentValue<Values::IntValue>(1, functionValue, environment);
-    auto endValue = getArgumentValue<Values::IntValue>(2, functionValue, environment);
+    auto startValue = getArgument(1, environment);
+    auto endValue = getArgument(2, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Cannot get sublist from empty list: " + token.position.currentLineText());
+        return Values::makeNull();
     }
     
-    int startIndex = std::static_pointer_cast<Values::IntValue>(startValue)->data;
-    int endIndex = std::static_pointer_cast<Values::IntValue>(endValue)->data;
+    int startIndex = startValue.intData();
+    int endIndex = endValue.intData();
 
     if (startIndex > endIndex || 
         startIndex >= (int)listValue->listData.size() || endIndex >= (int)listValue->listData.size() ||
         startIndex < 0 || endIndex < 0) {
-        printError(token, "Error: Invalid range: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Invalid range: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    std::vector<Values::ValuePtr> listData;
-    for (auto index = startIndex; index <= endIndex; ++index) {
-        listData.push_back(listValue->listData.at(index));
-    }
-    return makeListType(listValue, listData);
+    return makeListType(listValue, listValue->listData.slice(startIndex, endIndex + 1));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::isEmptyBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), listValue->listData.empty());
+    return Values::makeBool(listValue->listData.empty());
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::sumBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
-    int sum = 0;
-    for (auto & value : listValue->listData) {
-        sum += std::static_pointer_cast<Values::IntValue>(value)->data;
-    }
-
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), sum);
+    return Values::makeInt(ListKernels::sum(listValue->listData));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::productBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), 0);
-    }
-
-    int product = 1;
-    for (auto & value : listValue->listData) {
-        product *= std::static_pointer_cast<Values::IntValue>(value)->data;
+        return Values::makeInt(0);
     }
 
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), product);
+    return Values::makeInt(ListKernels::product(listValue->listData));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::maxBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: List[int] passed to max cannot be empty: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: List[int] passed to max cannot be empty: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    int max = INT_MIN;
-    for (auto & value : listValue->listData) {
-        auto intValue = std::static_pointer_cast<Values::IntValue>(value)->data;
-
-        if (max < intValue) {
-            max = intValue;
-        }
-    }
-
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), max);
+    return Values::makeInt(ListKernels::max(listValue->listData));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::minBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        printError(token, "Error: List[int] passed to min cannot be empty: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: List[int] passed to min cannot be empty: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    int min = INT_MAX;
-    for (auto & value : listValue->listData) {
-        auto intValue = std::static_pointer_cast<Values::IntValue>(value)->data;
-
-        if (min > intValue) {
-            min = intValue;
-        }
-    }
-
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), min);
+    return Values::makeInt(ListKernels::min(listValue->listData));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::sortlhBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
@@ -489,14 +378,11 @@ BuiltinImplementations::sortlhBuiltin(const Token & token, Values::FunctionValue
         return listValue;
     }
 
-    std::sort(listValue->listData.begin(), listValue->listData.end(), 
-              [](const Values::ValuePtr & lhs, const Values::ValuePtr & rhs) {
-                    return std::static_pointer_cast<Values::IntValue>(lhs)->data < std::static_pointer_cast<Values::IntValue>(rhs)->data;
-                });
+    listValue->listData = ListKernels::sorted(listValue->listData, false);
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::sorthlBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
@@ -504,126 +390,116 @@ BuiltinImplementations::sorthlBuiltin(const Token & token, Values::FunctionValue
         return listValue;
     }
 
-    std::sort(listValue->listData.begin(), listValue->listData.end(), 
-              [](const Values::ValuePtr & lhs, const Values::ValuePtr & rhs) {
-                    return std::static_pointer_cast<Values::IntValue>(lhs)->data > std::static_pointer_cast<Values::IntValue>(rhs)->data;
-                });
+    listValue->listData = ListKernels::sorted(listValue->listData, true);
     return listValue;
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::containsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listData = getArgumentValue<Values::ListValue>(0, functionValue, environment)->listData;
 
     if (listData.empty()) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), false);
+        return Values::makeBool(false);
     }
     
-    auto searchValue = getArgumentValue<Values::Value>(1, functionValue, environment);
-    if (std::any_of(listData.begin(), listData.end(), [&searchValue](Values::ValuePtr value) { return valuesEqual(value, searchValue); })) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), true);
+    auto searchValue = getArgument(1, environment);
+    if (std::any_of(listData.begin(), listData.end(), [&searchValue](Values::Value value) { return Values::valuesEqual(value, searchValue); })) {
+        return Values::makeBool(true);
     }
 
-    return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), false);
+    return Values::makeBool(false);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::findBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
     if (listValue->listData.empty()) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), false);
+        return Values::makeBool(false);
     }
     
-    auto searchValue = getArgumentValue<Values::Value>(1, functionValue, environment);
-    for (unsigned int index = 0; index < listValue->listData.size(); ++index) {
-        if (valuesEqual(listValue->listData.at(index), searchValue)) {
-            return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), index);
+    auto searchValue = getArgument(1, environment);
+    int index = 0;
+    for (const auto & value : listValue->listData) {
+        if (Values::valuesEqual(value, searchValue)) {
+            return Values::makeInt(index);
         }
+        ++index;
     }
 
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), -1);
+    return Values::makeInt(-1);
 }
 
-Values::ValuePtr
-BuiltinImplementations::mapBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+Values::Value
+BuiltinImplementations::mapBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto funcValue = getArgumentValue<Values::FunctionValue>(1, functionValue, environment);
 
-    std::vector<Values::ValuePtr> listData;
-    for (const auto value : listValue->listData) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), value);
-        listData.push_back(interpreter.interpret(funcValue->functionBody, funcEnvironment));
+    std::vector<Values::Value> listData;
+    for (const auto & value : listValue->listData) {
+        listData.push_back(evaluator.applyFunction(token, funcValue, {value}, environment));
     }
 
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
-BuiltinImplementations::filterBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+Values::Value
+BuiltinImplementations::filterBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto funcValue = getArgumentValue<Values::FunctionValue>(1, functionValue, environment);
     
-    std::vector<Values::ValuePtr> listData;
-    for (const auto value : listValue->listData) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), value);
-        auto result = std::static_pointer_cast<Values::BoolValue>(interpreter.interpret(funcValue->functionBody, funcEnvironment));
+    std::vector<Values::Value> listData;
+    for (const auto & value : listValue->listData) {
+        auto result = evaluator.applyFunction(token, funcValue, {value}, environment);
         
-        if (result->data)
+        if (result.boolData())
             listData.push_back(value);
     }
 
     return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
-BuiltinImplementations::foreachBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+Values::Value
+BuiltinImplementations::foreachBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto funcValue = getArgumentValue<Values::FunctionValue>(1, functionValue, environment);
     
-    std::vector<Values::ValuePtr> listData;
-    for (const auto value : listValue->listData) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), value);
-        interpreter.interpret(funcValue->functionBody, funcEnvironment);
+    for (const auto & value : listValue->listData) {
+        evaluator.applyFunction(token, funcValue, {value}, environment);
     }
 
-    return nullValue;
+    return Values::makeNull();
 }
 
-Values::ValuePtr
-BuiltinImplementations::generateBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto lowerBoundValue = getArgumentValue<Values::IntValue>(0, functionValue, environment)->data;
-    auto upperBoundValue = getArgumentValue<Values::IntValue>(1, functionValue, environment)->data;
+Values::Value
+BuiltinImplementations::generateBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto lowerBoundValue = getArgument(0, environment).intData();
+    auto upperBoundValue = getArgument(1, environment).intData();
     auto funcValue = getArgumentValue<Values::FunctionValue>(2, functionValue, environment);
 
-    std::vector<Values::ValuePtr> listData;
+    std::vector<Values::Value> listData;
     for (int i = lowerBoundValue; i <= upperBoundValue; ++i) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-        auto intValue = std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), i);
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), intValue);
-        listData.push_back(interpreter.interpret(funcValue->functionBody, funcEnvironment));
+        auto intValue = Values::makeInt(i);
+        listData.push_back(evaluator.applyFunction(token, funcValue, {intValue}, environment));
     }
 
-    return std::make_shared<Values::ListValue>(std::make_shared<Types::ListType>(std::make_shared<Types::IntType>()), listData);
+    return std::make_shared<Values::ListValue>(Types::listOf(Types::intType()), listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::fillBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto fillValue = getArgumentValue<Values::Value>(0, functionValue, environment);
-    auto fillAmountValue = getArgumentValue<Values::IntValue>(1, functionValue, environment);
+    auto fillValue = getArgument(0, environment);
+    auto fillAmountValue = getArgument(1, environment);
 
-    std::vector<Values::ValuePtr> listData;
-    for (int i = 0; i < fillAmountValue->data; ++i) {
+    std::vector<Values::Value> listData;
+    for (int i = 0; i < fillAmountValue.intData(); ++i) {
         listData.push_back(fillValue);
     }
 
-    return std::make_shared<Values::ListValue>(std::make_shared<Types::ListType>(fillValue->type), listData);
+    return std::make_shared<Values::ListValue>(Types::listOf(fillValue.type()), listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::reverseBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
 
@@ -631,522 +507,723 @@ BuiltinImplementations::reverseBuiltin(Values::FunctionValuePtr functionValue, V
         return listValue;
     }
 
-    std::reverse(listValue->listData.begin(), listValue->listData.end());
+    listValue->listData = ListKernels::reversed(listValue->listData);
     return listValue;
 }
 
-Values::ValuePtr
-BuiltinImplementations::foldlBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+Values::Value
+BuiltinImplementations::foldlBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
     auto listData = getArgumentValue<Values::ListValue>(0, functionValue, environment)->listData;
-    auto initialValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto initialValue = getArgument(1, environment);
     auto funcValue = getArgumentValue<Values::FunctionValue>(2, functionValue, environment);
 
-    Values::ValuePtr foldValue1 = initialValue;
-    Values::ValuePtr foldValue2;
-    for (unsigned int index = 0; index < listData.size(); ++index) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-
-        foldValue2 = listData.at(index);
-
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), foldValue1);
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(1), foldValue2);
-
-        foldValue1 = interpreter.interpret(funcValue->functionBody, funcEnvironment);
+    Values::Value foldValue1 = initialValue;
+    Values::Value foldValue2;
+    for (const auto & value : listData) {
+        foldValue2 = value;
+        foldValue1 = evaluator.applyFunction(token, funcValue, {foldValue1, foldValue2}, environment);
     }
 
     return foldValue1;
 }
 
-Values::ValuePtr
-BuiltinImplementations::foldrBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+Values::Value
+BuiltinImplementations::foldrBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
     auto listData = getArgumentValue<Values::ListValue>(0, functionValue, environment)->listData;
-    auto initialValue = getArgumentValue<Values::Value>(1, functionValue, environment);
+    auto initialValue = getArgument(1, environment);
     auto funcValue = getArgumentValue<Values::FunctionValue>(2, functionValue, environment);
 
-    Values::ValuePtr foldValue1;
-    Values::ValuePtr foldValue2 = initialValue;
+    Values::Value foldValue1;
+    Values::Value foldValue2 = initialValue;
     for (int index = listData.size() - 1; index >= 0; --index) {
-        auto funcEnvironment = funcValue->functionBodyEnvironment;
-
         foldValue1 = listData.at(index);
+        foldValue2 = evaluator.applyFunction(token, funcValue, {foldValue1, foldValue2}, environment);
+    }
+
+    return foldValue2;
+}
+
+// The parallel builtins give the same results as their serial forms as long
+// as f only computes its result: the order f runs in is not fixed, so
+// printing from it or changing shared lists in place are not.
+Values::Value
+BuiltinImplementations::pmapBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
+    auto funcValue = getArgumentValue<Values::FunctionValue>(1, functionValue, environment);
 
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(0), foldValue1);
-        interpreter.addName(funcEnvironment, funcValue->parameterNames.at(1), foldValue2);
+    auto elements = listValue->listData.toVector();
+    std::vector<Values::Value> listData(elements.size());
+    parallelFor(evaluator, elements.size(), [&](Evaluator & rangeEvaluator, std::size_t begin, std::size_t end) {
+        for (auto index = begin; index < end; ++index) {
+            listData[index] = rangeEvaluator.applyFunction(token, funcValue, {elements[index]}, environment);
+        }
+    });
+
+    return makeListType(listValue, listData);
+}
+
+Values::Value
+BuiltinImplementations::pfilterBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
+    auto funcValue = getArgumentValue<Values::FunctionValue>(1, functionValue, environment);
+
+    auto elements = listValue->listData.toVector();
+    std::vector<char> keep(elements.size());
+    parallelFor(evaluator, elements.size(), [&](Evaluator & rangeEvaluator, std::size_t begin, std::size_t end) {
+        for (auto index = begin; index < end; ++index) {
+            keep[index] = rangeEvaluator.applyFunction(token, funcValue, {elements[index]}, environment).boolData();
+        }
+    });
 
-        foldValue2 = interpreter.interpret(funcValue->functionBody, funcEnvironment);
+    std::vector<Values::Value> listData;
+    for (unsigned int index = 0; index < elements.size(); ++index) {
+        if (keep[index])
+            listData.push_back(elements[index]);
     }
 
-    return foldValue2;
+    return makeListType(listValue, listData);
 }
 
-Values::ValuePtr
+Values::Value
+BuiltinImplementations::pgenerateBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto lowerBoundValue = getArgument(0, environment).intData();
+    auto upperBoundValue = getArgument(1, environment).intData();
+    auto funcValue = getArgumentValue<Values::FunctionValue>(2, functionValue, environment);
+
+    auto count = (upperBoundValue >= lowerBoundValue) ? static_cast<std::size_t>(upperBoundValue - lowerBoundValue) + 1 : 0;
+    std::vector<Values::Value> listData(count);
+    parallelFor(evaluator, count, [&](Evaluator & rangeEvaluator, std::size_t begin, std::size_t end) {
+        for (auto index = begin; index < end; ++index) {
+            auto intValue = Values::makeInt(lowerBoundValue + static_cast<int>(index));
+            listData[index] = rangeEvaluator.applyFunction(token, funcValue, {intValue}, environment);
+        }
+    });
+
+    return std::make_shared<Values::ListValue>(Types::listOf(Types::intType()), listData);
+}
+
+// Folds each range on its own, then the range results from the initial value
+// in list order. Equal to foldl when f is associative.
+Values::Value
+BuiltinImplementations::preduceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+    auto elements = getArgumentValue<Values::ListValue>(0, functionValue, environment)->listData.toVector();
+    auto initialValue = getArgument(1, environment);
+    auto funcValue = getArgumentValue<Values::FunctionValue>(2, functionValue, environment);
+
+    std::mutex rangeValuesMutex;
+    std::vector<std::pair<std::size_t, Values::Value>> rangeValues;
+    parallelFor(evaluator, elements.size(), [&](Evaluator & rangeEvaluator, std::size_t begin, std::size_t end) {
+        Values::Value foldValue = elements[begin];
+        for (auto index = begin + 1; index < end; ++index) {
+            foldValue = rangeEvaluator.applyFunction(token, funcValue, {foldValue, elements[index]}, environment);
+        }
+
+        std::lock_guard<std::mutex> lock(rangeValuesMutex);
+        rangeValues.emplace_back(begin, foldValue);
+    });
+
+    std::sort(rangeValues.begin(), rangeValues.end(),
+              [](const std::pair<std::size_t, Values::Value> & range1, const std::pair<std::size_t, Values::Value> & range2) {
+                  return range1.first < range2.first;
+              });
+
+    Values::Value foldValue = initialValue;
+    for (const auto & rangeValue : rangeValues) {
+        foldValue = evaluator.applyFunction(token, funcValue, {foldValue, rangeValue.second}, environment);
+    }
+
+    return foldValue;
+}
+
+Values::Value
 BuiltinImplementations::zipBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue1 = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto listValue2 = getArgumentValue<Values::ListValue>(1, functionValue, environment);
 
     if (listValue1->listData.size() != listValue2->listData.size()) {
-        printError(token, "Error: zip: differing list sizes: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: zip: differing list sizes: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    auto tupleType = std::make_shared<Types::TupleType>(std::vector<Types::TypePtr>{
+    auto tupleType = Types::tupleOf(std::vector<Types::TypePtr>{
                                         std::static_pointer_cast<Types::ListType>(listValue1->type)->listType, 
                                         std::static_pointer_cast<Types::ListType>(listValue2->type)->listType
                                     });
                             
-    std::vector<Values::ValuePtr> listData;
+    std::vector<Values::Value> listData;
     for (unsigned int zipIndex = 0; zipIndex < listValue1->listData.size(); ++zipIndex) {
-        listData.push_back(std::make_shared<Values::TupleValue>(tupleType, std::vector<Values::ValuePtr>{listValue1->listData.at(zipIndex), listValue2->listData.at(zipIndex)}));
+        listData.push_back(std::make_shared<Values::TupleValue>(tupleType, std::vector<Values::Value>{listValue1->listData.at(zipIndex), listValue2->listData.at(zipIndex)}));
     }
 
-    return std::make_shared<Values::ListValue>(std::make_shared<Types::ListType>(tupleType), listData);
+    return std::make_shared<Values::ListValue>(Types::listOf(tupleType), listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::setOperation(Values::FunctionValuePtr functionValue, Values::Environment & environment, bool unionFlag) {
     auto listValue1 = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     auto listData1 = listValue1->listData;
     auto listData2 = getArgumentValue<Values::ListValue>(1, functionValue, environment)->listData;
 
-    auto comparator = [](Values::ValuePtr value1, Values::ValuePtr value2) {
-                            auto typeEnum = static_cast<int>(value1->type->dataType);
-                            switch (typeEnum) {
-                                case 0: { // INT
-                                    auto intValue1 = std::static_pointer_cast<Values::IntValue>(value1)->data;
-                                    auto intValue2 = std::static_pointer_cast<Values::IntValue>(value2)->data;
-
-                                    return (intValue1 < intValue2);
-                                }
-                                    break;
-                                case 1: { // CHAR
-                                    auto charValue1 = std::static_pointer_cast<Values::CharValue>(value1)->data;
-                                    auto charValue2 = std::static_pointer_cast<Values::CharValue>(value2)->data;
-
-                                    return (charValue1 < charValue2);
-                                }
-                                    break;
-                                case 2: { // STRING
-                                    auto stringValue1 = std::static_pointer_cast<Values::StringValue>(value2)->data;
-                                    auto stringValue2 = std::static_pointer_cast<Values::StringValue>(value2)->data;
-
-                                    return (stringValue1 < stringValue2);
-                                }
-                                    break;
-                                case 3: { // BOOL
-                                    auto boolValue1 = std::static_pointer_cast<Values::BoolValue>(value2)->data;
-                                    auto boolValue2 = std::static_pointer_cast<Values::BoolValue>(value2)->data;
-
-                                    return (boolValue1 < boolValue2);
-                                }
-                                    break;
-                                default:
-                                    break;
-                            }
-                            return false;
-                        };
-
-    auto valueSet1 = std::set<Values::ValuePtr, decltype(comparator)>(comparator);
-    auto valueSet2 = std::set<Values::ValuePtr, decltype(comparator)>(comparator);
-
-    for (auto & value : listData1)
-        valueSet1.insert(value);
-
-    for (auto & value : listData2)
-        valueSet2.insert(value);
-
-    auto valueSetResult = std::set<Values::ValuePtr, decltype(comparator)>(comparator);
-
-    if (unionFlag)
-        std::set_union(valueSet1.begin(), valueSet1.end(), valueSet2.begin(), valueSet2.end(), std::inserter(valueSetResult, valueSetResult.begin()));
-    else
-        std::set_intersection(valueSet1.begin(), valueSet1.end(), valueSet2.begin(), valueSet2.end(), std::inserter(valueSetResult, valueSetResult.begin()), comparator);
-    
-    std::vector<Values::ValuePtr> valueVector;
-    std::copy(valueSetResult.begin(), valueSetResult.end(), std::back_inserter(valueVector));
+    // elements come out in the order they are first seen, each once
+    Values::SetData seenValues;
+    std::vector<Values::Value> valueVector;
+    auto addValue = [&seenValues, &valueVector](const Values::Value & value) {
+        if (!seenValues.contains(value)) {
+            seenValues.insert(value, Values::Value());
+            valueVector.push_back(value);
+        }
+    };
+
+    if (unionFlag) {
+        for (const auto & value : listData1)
+            addValue(value);
+        for (const auto & value : listData2)
+            addValue(value);
+    } else {
+        Values::SetData valueSet2;
+        for (const auto & value : listData2)
+            valueSet2.insert(value, Values::Value());
+        for (const auto & value : listData1) {
+            if (valueSet2.contains(value))
+                addValue(value);
+        }
+    }
+
     return makeListType(listValue1, valueVector);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::unionBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     return setOperation(functionValue, environment, true);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::intersectBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     return setOperation(functionValue, environment, false);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::equalsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto listValue1 = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    auto listValue2 = getArgumentValue<Values::ListValue>(1, functionValue, environment);
+    auto value1 = getArgument(0, environment);
+    auto value2 = getArgument(1, environment);
+
+    if (value1.dataType() == Types::DataTypes::LIST && value2.dataType() == Types::DataTypes::LIST) {
+        auto listValue1 = value1.as<Values::ListValue>();
+        auto elementType = std::static_pointer_cast<Types::ListType>(listValue1->type)->listType->dataType;
+        return Values::makeBool(ListKernels::equal(listValue1->listData, value2.as<Values::ListValue>()->listData, elementType));
+    }
+    return Values::makeBool(Values::valuesEqual(value1, value2));
+}
+
+Values::Value
+BuiltinImplementations::toSetBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
+
+    Values::SetData setData;
+    for (const auto & value : listValue->listData) {
+        setData.insert(value, Values::Value());
+    }
+
+    auto elementType = std::static_pointer_cast<Types::ListType>(listValue->type)->listType;
+    return std::make_shared<Values::SetValue>(Types::setOf(elementType), setData);
+}
+
+Values::Value
+BuiltinImplementations::setInsertBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto setValue = getArgumentValue<Values::SetValue>(0, functionValue, environment);
+
+    auto setData = setValue->setData;
+    setData.insert(getArgument(1, environment), Values::Value());
+    return std::make_shared<Values::SetValue>(setValue->type, setData);
+}
+
+Values::Value
+BuiltinImplementations::setRemoveBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto setValue = getArgumentValue<Values::SetValue>(0, functionValue, environment);
+
+    auto setData = setValue->setData;
+    setData.erase(getArgument(1, environment));
+    return std::make_shared<Values::SetValue>(setValue->type, setData);
+}
+
+Values::Value
+BuiltinImplementations::setContainsBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto setValue = getArgumentValue<Values::SetValue>(0, functionValue, environment);
+    return Values::makeBool(setValue->setData.contains(getArgument(1, environment)));
+}
+
+Values::Value
+BuiltinImplementations::setSizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto setValue = getArgumentValue<Values::SetValue>(0, functionValue, environment);
+    return Values::makeInt(static_cast<int>(setValue->setData.size()));
+}
+
+Values::Value
+BuiltinImplementations::setToListBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto setValue = getArgumentValue<Values::SetValue>(0, functionValue, environment);
+
+    std::vector<Values::Value> listData;
+    setValue->setData.forEach([&listData](const Values::Value & element, const Values::Value &) {
+        listData.push_back(element);
+    });
+
+    auto elementType = std::static_pointer_cast<Types::SetType>(setValue->type)->setType;
+    return std::make_shared<Values::ListValue>(Types::listOf(elementType), listData);
+}
+
+Values::Value
+BuiltinImplementations::toMapBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
+
+    // later pairs replace earlier ones with the same key
+    Values::MapData mapData;
+    for (const auto & value : listValue->listData) {
+        const auto & tupleData = value.as<Values::TupleValue>()->tupleData;
+        mapData.insert(tupleData.at(0), tupleData.at(1));
+    }
+
+    auto tupleType = std::static_pointer_cast<Types::TupleType>(std::static_pointer_cast<Types::ListType>(listValue->type)->listType);
+    return std::make_shared<Values::MapValue>(Types::mapOf(tupleType->tupleTypes.at(0), tupleType->tupleTypes.at(1)), mapData);
+}
+
+Values::Value
+BuiltinImplementations::mapInsertBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+
+    auto mapData = mapValue->mapData;
+    mapData.insert(getArgument(1, environment), getArgument(2, environment));
+    return std::make_shared<Values::MapValue>(mapValue->type, mapData);
+}
+
+Values::Value
+BuiltinImplementations::mapRemoveBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+
+    auto mapData = mapValue->mapData;
+    mapData.erase(getArgument(1, environment));
+    return std::make_shared<Values::MapValue>(mapValue->type, mapData);
+}
+
+Values::Value
+BuiltinImplementations::mapContainsBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+    return Values::makeBool(mapValue->mapData.contains(getArgument(1, environment)));
+}
+
+Values::Value
+BuiltinImplementations::mapGetBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+
+    auto mappedValue = mapValue->mapData.find(getArgument(1, environment));
+    if (!mappedValue) {
+        printError(token, "Error: mapGet: key not in map: " + token.position.currentLineText());
+        return Values::makeNull();
+    }
+    return *mappedValue;
+}
+
+Values::Value
+BuiltinImplementations::mapSizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+    return Values::makeInt(static_cast<int>(mapValue->mapData.size()));
+}
+
+Values::Value
+BuiltinImplementations::mapKeysBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+
+    std::vector<Values::Value> listData;
+    mapValue->mapData.forEach([&listData](const Values::Value & key, const Values::Value &) {
+        listData.push_back(key);
+    });
 
-    return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(), valuesEqual(listValue1, listValue2));
+    auto keyType = std::static_pointer_cast<Types::MapType>(mapValue->type)->keyType;
+    return std::make_shared<Values::ListValue>(Types::listOf(keyType), listData);
 }
 
-Values::ValuePtr
+Values::Value
+BuiltinImplementations::mapValuesBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto mapValue = getArgumentValue<Values::MapValue>(0, functionValue, environment);
+
+    // in the same order as mapKeys
+    std::vector<Values::Value> listData;
+    mapValue->mapData.forEach([&listData](const Values::Value &, const Values::Value & mappedValue) {
+        listData.push_back(mappedValue);
+    });
+
+    auto valueType = std::static_pointer_cast<Types::MapType>(mapValue->type)->valueType;
+    return std::make_shared<Values::ListValue>(Types::listOf(valueType), listData);
+}
+
+Values::Value
 BuiltinImplementations::intToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto intData = getArgumentValue<Values::IntValue>(0, functionValue, environment)->data;
-    return std::make_shared<Values::StringValue>(std::make_shared<Types::StringType>(), std::to_string(intData));
+    auto intData = getArgument(0, environment).intData();
+    return std::make_shared<Values::StringValue>(Types::stringType(), std::to_string(intData));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::stringToIntBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto stringData = getArgumentValue<Values::StringValue>(0, functionValue, environment)->data;
+    auto stringData = getArgumentValue<Values::StringValue>(0, functionValue, environment)->str();
 
     int intData = 0;
     try {
         intData = std::stoi(stringData);
     } catch (...) {
-        printError(token, "Error: stringToInt: Given string is not an integer: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: stringToInt: Given string is not an integer: " + token.position.currentLineText());
+        return Values::makeNull();
     }
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), intData);
+    return Values::makeInt(intData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::stringToCharListBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto stringData = getArgumentValue<Values::StringValue>(0, functionValue, environment)->data;
-    std::vector<Values::ValuePtr> listData{};
+    auto stringValue = getArgumentValue<Values::StringValue>(0, functionValue, environment);
+    auto stringData = stringValue->view();
+    std::vector<Values::Value> listData{};
+    listData.reserve(stringData.size());
 
     std::transform(stringData.begin(), stringData.end(), std::back_inserter(listData),
-                   [](char character) -> Values::ValuePtr { 
-                       return std::make_shared<Values::CharValue>(std::make_shared<Types::CharType>(), character); 
+                   [](char character) -> Values::Value { 
+                       return Values::makeChar(character); 
                     });
 
-    return std::make_shared<Values::ListValue>(std::make_shared<Types::ListType>(std::make_shared<Types::CharType>()), listData);
+    return std::make_shared<Values::ListValue>(Types::listOf(Types::charType()), listData);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::charListToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
     std::string stringValue;
+    stringValue.reserve(listValue->listData.size());
     for (auto & value : listValue->listData) {
-        stringValue += std::string(1, std::static_pointer_cast<Values::CharValue>(value)->data);
+        stringValue += value.charData();
     }
-    return std::make_shared<Values::StringValue>(std::make_shared<Types::StringType>(), stringValue);
+    return std::make_shared<Values::StringValue>(Types::stringType(), stringValue);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printIntBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto intValue = getArgumentValue<Values::IntValue>(0, functionValue, environment)->data;
-    std::cout << intValue << std::endl;
-    return nullValue;
+    auto intValue = getArgument(0, environment).intData();
+    Output::write(std::to_string(intValue) + '\n');
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printBoolBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto boolValue = getArgumentValue<Values::BoolValue>(0, functionValue, environment)->data;
-    std::cout << ((boolValue) ? std::string("true") : std::string("false")) << std::endl;
-    return nullValue;
+    auto boolValue = getArgument(0, environment).boolData();
+    Output::write((boolValue) ? std::string("true\n") : std::string("false\n"));
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printListBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto listValue = getArgumentValue<Values::ListValue>(0, functionValue, environment);
-    printValue(token, listValue, "printList");
-    std::cout << std::endl;
+    std::string output;
+    printValue(output, token, listValue, "printList");
+    Output::write(output + '\n');
 
-    return nullValue;
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::print2TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    printValue(token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print2Tuple");
-    std::cout << std::endl;
-    return nullValue;
+    std::string output;
+    printValue(output, token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print2Tuple");
+    Output::write(output + '\n');
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::print3TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    printValue(token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print3Tuple");
-    std::cout << std::endl;
-    return nullValue;
+    std::string output;
+    printValue(output, token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print3Tuple");
+    Output::write(output + '\n');
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::print4TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    printValue(token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print4Tuple");
-    std::cout << std::endl;
-    return nullValue;
+    std::string output;
+    printValue(output, token, getArgumentValue<Values::TupleValue>(0, functionValue, environment), "print4Tuple");
+    Output::write(output + '\n');
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::readCharBuiltin(Values::FunctionValuePtr functionValue) {
+    Output::flush();
     char charValue;
     std::cin >> charValue;
-    return std::make_shared<Values::CharValue>(std::make_shared<Types::CharType>(), charValue);
+    return Values::makeChar(charValue);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printCharBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto charValue = getArgumentValue<Values::CharValue>(0, functionValue, environment)->data;
-    std::cout << charValue << std::endl;
-    return nullValue;
+    auto charValue = getArgument(0, environment).charData();
+    Output::write(std::string({charValue, '\n'}));
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::readStringBuiltin(Values::FunctionValuePtr functionValue) {
+    Output::flush();
     std::string stringValue;
     std::cin >> stringValue;
-    return std::make_shared<Values::StringValue>(std::make_shared<Types::StringType>(), stringValue);
+    return std::make_shared<Values::StringValue>(Types::stringType(), stringValue);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printStringBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto stringValue = getArgumentValue<Values::StringValue>(0, functionValue, environment)->data;
+    auto string = getArgumentValue<Values::StringValue>(0, functionValue, environment);
+    auto stringValue = string->view();
 
+    std::string output;
+    output.reserve(stringValue.length() + 1);
     for (unsigned int i = 0; i < stringValue.length(); ++i) {
         if (stringValue.at(i) == '\\' && i <= stringValue.length() - 1) {
             switch (stringValue.at(i + 1)) {
                 case '?':
-                    std::cout << "?";
+                    output += '?';
                     break;
                 case '\\':
-                    std::cout << "\\";
+                    output += '\\';
                     break;
                 case 'b':
-                    std::cout << "\b";
+                    output += '\b';
                     break;
                 case 'n':
-                    std::cout << "\n";
+                    output += '\n';
                     break;
                 case 'r':
-                    std::cout << "\r";
+                    output += '\r';
                     break;
                 case 't':
-                    std::cout << "\t";
+                    output += '\t';
                     break;
                 case 's':
-                    std::cout << " ";
+                    output += ' ';
                     break;
                 default:
+                    // after what came before it, as it was written unbuffered
+                    Output::write(output);
+                    output.clear();
                     printError(token, std::string("Error: invalid escape sequence: ") + std::string({stringValue.at(i + 1)}));
             }
             i++;
         } 
         else if (stringValue.at(i) == '\\' && i == stringValue.length()) {
+            Output::write(output);
             printError(token, "Error: escape slash requires escape character");
-            return nullValue;
+            return Values::makeNull();
         }
         else {
-            std::cout << std::string({stringValue.at(i)});
+            output += stringValue.at(i);
         }
     }
 
-    std::cout << std::endl;
+    Output::write(output + '\n');
 
-    return nullValue;
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::concatBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto stringValue1 = getArgumentValue<Values::StringValue>(0, functionValue, environment);
     auto stringValue2 = getArgumentValue<Values::StringValue>(1, functionValue, environment);
 
-    return std::make_shared<Values::StringValue>(std::make_shared<Types::StringType>(), stringValue1->data + stringValue2->data);
+    return Values::StringValue::concat(stringValue1, stringValue2);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::substrBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto stringValue = getArgumentValue<Values::StringValue>(0, functionValue, environment);
-    auto startValue = getArgumentValue<Values::IntValue>(1, functionValue, environment);
-    auto endValue = getArgumentValue<Values::IntValue>(2, functionValue, environment);
+    auto startValue = getArgument(1, environment);
+    auto endValue = getArgument(2, environment);
 
-    if (stringValue->data == "") {
-        printError(token, "Error: Cannot get substring from empty string: " + token.position.currentLineText);
-        return nullValue;
+    if (stringValue->empty()) {
+        printError(token, "Error: Cannot get substring from empty string: " + token.position.currentLineText());
+        return Values::makeNull();
     }
     
-    int startIndex = std::static_pointer_cast<Values::IntValue>(startValue)->data;
-    int endIndex = std::static_pointer_cast<Values::IntValue>(endValue)->data;
+    int startIndex = startValue.intData();
+    int endIndex = endValue.intData();
 
     if (startIndex > endIndex || 
-        startIndex >= (int)stringValue->data.length() || endIndex >= (int)stringValue->data.length() ||
+        startIndex >= (int)stringValue->size() || endIndex >= (int)stringValue->size() ||
         startIndex < 0 || endIndex < 0) {
-        printError(token, "Error: Invalid range: " + token.position.currentLineText);
-        return nullValue;
+        printError(token, "Error: Invalid range: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    return std::make_shared<Values::StringValue>(std::make_shared<Types::StringType>(), stringValue->data.substr(startIndex, endIndex - startIndex));
+    return Values::StringValue::slice(stringValue, startIndex, endIndex - startIndex);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::charAtBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
     auto stringValue = getArgumentValue<Values::StringValue>(0, functionValue, environment);
-    auto index = getArgumentValue<Values::IntValue>(1, functionValue, environment)->data;
+    auto index = getArgument(1, environment).intData();
 
-    if (index < 0 || index >= (int)stringValue->data.length()) {
-        printError(token, "Error: Invalid string access: " + token.position.currentLineText);
-        return nullValue;
+    if (index < 0 || index >= (int)stringValue->size()) {
+        printError(token, "Error: Invalid string access: " + token.position.currentLineText());
+        return Values::makeNull();
     }
 
-    return std::make_shared<Values::CharValue>(std::make_shared<Types::CharType>(), stringValue->data.at(index));
+    return Values::makeChar(stringValue->view()[index]);
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::randBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto lowerBoundValue = getArgumentValue<Values::IntValue>(0, functionValue, environment)->data;
-    auto upperBoundValue = getArgumentValue<Values::IntValue>(1, functionValue, environment)->data;
+    auto lowerBoundValue = getArgument(0, environment).intData();
+    auto upperBoundValue = getArgument(1, environment).intData();
 
     std::random_device seed;
     std::mt19937 generator(seed());
     std::uniform_int_distribution<> distribution(lowerBoundValue, upperBoundValue);
 
-    return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(), distribution(generator));
+    return Values::makeInt(distribution(generator));
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::printTypeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment) {
-    auto value = getArgumentValue<Values::Value>(0, functionValue, environment);
-    std::cout << value->type->toString() << std::endl;
-    return nullValue;
+    auto value = getArgument(0, environment);
+    Output::write(value.type()->toString() + '\n');
+    return Values::makeNull();
 }
 
-Values::ValuePtr
+Values::Value
 BuiltinImplementations::haltBuiltin(Values::FunctionValuePtr functionValue) {
     throw HaltException();
-    return nullValue;
+    return Values::makeNull();
 }
 
-// private
-std::shared_ptr<Values::NullValue> BuiltinImplementations::nullValue = std::make_shared<Values::NullValue>(std::make_shared<Types::NullType>());
-bool BuiltinImplementations::error = false;
-
-bool
-BuiltinImplementations::valuesEqual(Values::ValuePtr value1, Values::ValuePtr value2) {
-    auto typeEnum = static_cast<int>(value1->type->dataType);
-    switch (typeEnum) {
-        case 0: { // INT
-            auto intValue1 = std::static_pointer_cast<Values::IntValue>(value1)->data;
-            auto intValue2 = std::static_pointer_cast<Values::IntValue>(value2)->data;
-
-            return (intValue1 == intValue2);
-        }
-            break;
-        case 1: { // CHAR
-            auto charValue1 = std::static_pointer_cast<Values::CharValue>(value1)->data;
-            auto charValue2 = std::static_pointer_cast<Values::CharValue>(value2)->data;
+Values::Value
+BuiltinImplementations::readFileBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto path = getArgumentValue<Values::StringValue>(0, functionValue, environment)->str();
 
-            return (charValue1 == charValue2);
-        }
-            break;
-        case 2: { // STRING
-            auto stringValue1 = std::static_pointer_cast<Values::StringValue>(value1)->data;
-            auto stringValue2 = std::static_pointer_cast<Values::StringValue>(value2)->data;
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        printError(token, "Error: Could not open file: " + path);
+    }
+    return std::make_shared<Values::StringValue>(Types::stringType(), std::string(file.data()));
+}
 
-            return (stringValue1 == stringValue2);
-        }
-            break;
-        case 3: { // BOOL
-            auto boolValue1 = std::static_pointer_cast<Values::BoolValue>(value1)->data;
-            auto boolValue2 = std::static_pointer_cast<Values::BoolValue>(value2)->data;
+// Lines end at \n or \r\n, which are not part of them; a last line without
+// an end is still one
+Values::Value
+BuiltinImplementations::readLinesBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto path = getArgumentValue<Values::StringValue>(0, functionValue, environment)->str();
 
-            return (boolValue1 == boolValue2);
+    MappedFile file(path);
+    if (!file.isOpen()) {
+        printError(token, "Error: Could not open file: " + path);
+    }
+
+    // the lines are slices of one copy of the file
+    auto contentsValue = std::make_shared<Values::StringValue>(Types::stringType(), std::string(file.data()));
+    auto contents = contentsValue->view();
+    std::vector<Values::Value> lines;
+    std::size_t lineStart = 0;
+    while (lineStart < contents.size()) {
+        auto lineEnd = contents.find('\n', lineStart);
+        auto next = (lineEnd == std::string_view::npos) ? contents.size() : lineEnd + 1;
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = contents.size();
         }
-            break;
-        case 4: { // NULLVAL
-            return true;
+        if (lineEnd > lineStart && contents[lineEnd - 1] == '\r') {
+            --lineEnd;
         }
-            break;
-        case 5: { // LIST
-            auto listData1 = std::static_pointer_cast<Values::ListValue>(value1)->listData;
-            auto listData2 = std::static_pointer_cast<Values::ListValue>(value2)->listData;
 
-            if (listData1.size() != listData2.size()) {
-                return false;
-            }
-
-            for (unsigned int listIndex = 0; listIndex < listData1.size(); ++listIndex) {
-                if (!valuesEqual(listData1.at(listIndex), listData2.at(listIndex))) {
-                    return false;
-                }
-            }
-
-            return true;
-        }
-            break;
-        case 6: { // TUPLE
-            auto tupleData1 = std::static_pointer_cast<Values::TupleValue>(value1)->tupleData;
-            auto tupleData2 = std::static_pointer_cast<Values::TupleValue>(value2)->tupleData;
+        lines.push_back(Values::StringValue::slice(contentsValue, lineStart, lineEnd - lineStart));
+        lineStart = next;
+    }
+    return std::make_shared<Values::ListValue>(Types::listOf(Types::stringType()), lines);
+}
 
-            if (tupleData1.size() != tupleData2.size()) {
-                return false;
-            }
+// Each line followed by \n, replacing what the file held; false if it could
+// not be written
+Values::Value
+BuiltinImplementations::writeFileBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment) {
+    auto path = getArgumentValue<Values::StringValue>(0, functionValue, environment)->str();
+    auto listValue = getArgumentValue<Values::ListValue>(1, functionValue, environment);
 
-            for (unsigned int tupleIndex = 0; tupleIndex < tupleData1.size(); ++tupleIndex) {
-                if (!valuesEqual(tupleData1.at(tupleIndex), tupleData2.at(tupleIndex))) {
-                    return false;
-                }
-            }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        printError(token, "Error: Could not write file: " + path);
+        return Values::makeBool(false);
+    }
 
-            return true;
+    std::string block;
+    for (const auto & line : listValue->listData) {
+        block += line.as<Values::StringValue>()->view();
+        block += '\n';
+        if (block.size() >= WRITE_BLOCK_SIZE) {
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+            block.clear();
         }
-            break;
-        default: // function or typeclass equality support for now
-            return false;
-            break;
     }
+    file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    file.close();
 
-    return false;
+    return Values::makeBool(!file.fail());
 }
 
+// private
 void
-BuiltinImplementations::printValue(const Token & token, Values::ValuePtr value, const std::string & collectionType) {
-    if (value->type->dataType == Types::DataTypes::INT) {
-        std::cout << std::static_pointer_cast<Values::IntValue>(value)->data;
-    } else if (value->type->dataType == Types::DataTypes::CHAR) {
-        std::cout << std::string("'") << std::string(1, std::static_pointer_cast<Values::CharValue>(value)->data)
-                  << std::string("'");
-    } else if (value->type->dataType == Types::DataTypes::STRING) {
-        std::cout << std::string("\"") << std::static_pointer_cast<Values::StringValue>(value)->data
-                  << std::string("\"");
-    } else if (value->type->dataType == Types::DataTypes::BOOL) {
-        std::cout << ((std::static_pointer_cast<Values::BoolValue>(value)->data) ? std::string("true") : std::string("false"));
-    } else if (value->type->dataType == Types::DataTypes::NULLVAL) {
-        std::cout << "null";
-    } else if (value->type->dataType == Types::DataTypes::LIST) {
-        auto listData = std::static_pointer_cast<Values::ListValue>(value)->listData;
-
-        std::cout << "(";
+BuiltinImplementations::printValue(std::string & output, const Token & token, Values::Value value, const std::string & collectionType) {
+    if (value.dataType() == Types::DataTypes::INT) {
+        output += std::to_string(value.intData());
+    } else if (value.dataType() == Types::DataTypes::CHAR) {
+        output += std::string("'") + std::string(1, value.charData()) + std::string("'");
+    } else if (value.dataType() == Types::DataTypes::STRING) {
+        output += '"';
+        output += value.as<Values::StringValue>()->view();
+        output += '"';
+    } else if (value.dataType() == Types::DataTypes::BOOL) {
+        output += (value.boolData()) ? std::string("true") : std::string("false");
+    } else if (value.dataType() == Types::DataTypes::NULLVAL) {
+        output += "null";
+    } else if (value.dataType() == Types::DataTypes::LIST) {
+        auto listData = value.as<Values::ListValue>()->listData;
+
+        output += "(";
         if (listData.empty()) {
-            std::cout << ")";
+            output += ")";
         }
 
         for (unsigned int listIndex = 0; listIndex < listData.size() - 1; ++listIndex) {
-            printValue(token, listData.at(listIndex), collectionType);
-            std::cout << ", ";
+            printValue(output, token, listData.at(listIndex), collectionType);
+            output += ", ";
         }
-        printValue(token, listData.at(listData.size() - 1), collectionType);
-        std::cout << ")";
-    } else if (value->type->dataType == Types::DataTypes::TUPLE) {
-        auto tupleData = std::static_pointer_cast<Values::TupleValue>(value)->tupleData;
+        printValue(output, token, listData.at(listData.size() - 1), collectionType);
+        output += ")";
+    } else if (value.dataType() == Types::DataTypes::TUPLE) {
+        auto tupleData = value.as<Values::TupleValue>()->tupleData;
 
-        std::cout << "(";
+        output += "(";
         for (unsigned int tupleIndex = 0; tupleIndex < tupleData.size() - 1; ++tupleIndex) {
-            printValue(token, tupleData.at(tupleIndex), collectionType);
-            std::cout << ", ";
+            printValue(output, token, tupleData.at(tupleIndex), collectionType);
+            output += ", ";
         }
-        printValue(token, tupleData.at(tupleData.size() - 1), collectionType);
-        std::cout << ")";
-    } else if (value->type->dataType == Types::DataTypes::FUNC) {
-        auto funcType = std::static_pointer_cast<Types::FuncType>(value->type);
-
-        std::cout << funcType->toString();
-    } /* else if (value->type->dataType == Types::DataTypes::TYPECLASS) {
-        auto typeclassValue = std::static_pointer_cast<Values::TypeclassValue>(value);
+        printValue(output, token, tupleData.at(tupleData.size() - 1), collectionType);
+        output += ")";
+    } else if (value.dataType() == Types::DataTypes::FUNC) {
+        auto funcType = std::static_pointer_cast<Types::FuncType>(value.type());
+
+        output += funcType->toString();
+    } /* else if (value.dataType() == Types::DataTypes::TYPECLASS) {
+        auto typeclassValue = value.as<Values::TypeclassValue>();
         // TODO
     } */
 }
 
 void
 BuiltinImplementations::printError(const Token & token, const std::string & errorMessage) {
-    error = true;
-
     std::stringstream errorStream;
-    errorStream << "Line: " << token.position.fileLine - BuiltinDefinitions::builtinNumber()
+    errorStream << "Line: " << token.position.fileLine
                 << ", Column: " << token.position.fileColumn << std::endl
                 << errorMessage << std::endl 
-                << token.position.currentLineText << std::endl;
+                << token.position.currentLineText() << std::endl;
     ERROR(errorStream.str());
+
+    throw RuntimeException();
 }
\ No newline at end of file
@@ -3,94 +3,138 @@
 #include "../../defs/values.hpp"
 #include "../../defs/token.hpp"
 #include "../../utils/logger.hpp"
+#include "../../utils/threadPool.hpp"
 #include "builtinDefinitions.hpp"
-#include "../interpreter/interpreter.hpp"
+#include "../runtime/evaluator.hpp"
 
+#include <array>
 #include <climits>
 #include <algorithm>
 #include <random>
 
-class Interpreter;
-
 class BuiltinImplementations {
     private:
+        // every builtin called the same way, indexed by its BuiltinEnums
+        using Implementation = Values::Value (*)(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static const std::array<Implementation, static_cast<std::size_t>(BuiltinDefinitions::BuiltinEnums::BUILTINNUM)> implementations;
+
+        // An Implementation calling a builtin that takes fewer of its parameters
+        template<Values::Value (*builtin)(Values::FunctionValuePtr)>
+        static Values::Value adapt(const Token &, Values::FunctionValuePtr functionValue, Values::Environment &, Evaluator &) {
+            return builtin(functionValue);
+        }
+        template<Values::Value (*builtin)(Values::FunctionValuePtr, Values::Environment &)>
+        static Values::Value adapt(const Token &, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator &) {
+            return builtin(functionValue, environment);
+        }
+        template<Values::Value (*builtin)(const Token &, Values::FunctionValuePtr, Values::Environment &)>
+        static Values::Value adapt(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator &) {
+            return builtin(token, functionValue, environment);
+        }
+        template<Values::Value (*builtin)(const Token &, Values::FunctionValuePtr, Values::Environment &, Evaluator &)>
+        static Values::Value adapt(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator) {
+            return builtin(token, functionValue, environment, evaluator);
+        }
+
         template<class ValueType>
         static std::shared_ptr<ValueType> getArgumentValue(const int & index, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        
-        static Values::ListValuePtr makeListType(Values::ListValuePtr listValue, std::vector<Values::ValuePtr> listData);
+        static const Values::Value & getArgument(const int & index, Values::Environment & environment);
 
-        static Values::ValuePtr insertBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr removeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr replaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr pushFrontBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr pushBackBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr insertInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr removeInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr replaceInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr pushFrontInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr pushBackInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr frontBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr backBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr headBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr tailBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr combineBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr appendBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr sizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr rangeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr isEmptyBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr sumBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr productBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr maxBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr minBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr sortlhBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr sorthlBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr containsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr findBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr mapBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr filterBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr foreachBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr generateBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr fillBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr reverseBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr foldlBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr foldrBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr zipBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr setOperation(Values::FunctionValuePtr functionValue, Values::Environment & environment, bool unionFlag);
-        static Values::ValuePtr unionBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr intersectBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr equalsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr intToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr stringToIntBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr stringToCharListBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr charListToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr printIntBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr printBoolBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr printListBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr print2TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr print3TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr print4TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr readCharBuiltin(Values::FunctionValuePtr functionValue);
-        static Values::ValuePtr printCharBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr readStringBuiltin(Values::FunctionValuePtr functionValue);
-        static Values::ValuePtr printStringBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr concatBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr substrBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr charAtBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr randBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr printTypeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
-        static Values::ValuePtr haltBuiltin(Values::FunctionValuePtr functionValue);
+        using RangeBody = std::function<void(Evaluator & rangeEvaluator, std::size_t begin, std::size_t end)>;
+        static void parallelFor(const Evaluator & evaluator, std::size_t count, const RangeBody & body);
 
-        static std::shared_ptr<Values::NullValue> nullValue;
-        static bool error;
+        static Values::ListValuePtr makeListType(Values::ListValuePtr listValue, const Values::ListData & listData);
 
-        static bool valuesEqual(Values::ValuePtr value1, Values::ValuePtr value2);
+        static Values::Value insertBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value removeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value replaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value pushFrontBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value pushBackBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value insertInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value removeInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value replaceInPlaceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value pushFrontInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value pushBackInPlaceBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value frontBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value backBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value headBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value tailBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value combineBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value appendBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value sizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value rangeBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value isEmptyBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value sumBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value productBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value maxBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value minBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value sortlhBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value sorthlBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value containsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value findBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value filterBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value foreachBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value generateBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value fillBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value reverseBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value foldlBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value foldrBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value pmapBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value pfilterBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value pgenerateBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value preduceBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
+        static Values::Value zipBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setOperation(Values::FunctionValuePtr functionValue, Values::Environment & environment, bool unionFlag);
+        static Values::Value unionBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value intersectBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value equalsBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value toSetBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setInsertBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setRemoveBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setContainsBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setSizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value setToListBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value toMapBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapInsertBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapRemoveBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapContainsBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapGetBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapSizeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapKeysBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value mapValuesBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value intToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value stringToIntBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value stringToCharListBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value charListToStringBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value printIntBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value printBoolBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value printListBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value print2TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value print3TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value print4TupleBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value readCharBuiltin(Values::FunctionValuePtr functionValue);
+        static Values::Value printCharBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value readStringBuiltin(Values::FunctionValuePtr functionValue);
+        static Values::Value printStringBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value concatBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value substrBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value charAtBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value randBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value printTypeBuiltin(Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value haltBuiltin(Values::FunctionValuePtr functionValue);
+        static Values::Value readFileBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value readLinesBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        static Values::Value writeFileBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
 
-        static void printTuple(const Token & token, const std::vector<Values::ValuePtr> & tupleData, const std::string & collectionType);
-        static void printValue(const Token & token, Values::ValuePtr value, const std::string & collectionType);
+        static void printTuple(const Token & token, const std::vector<Values::Value> & tupleData, const std::string & collectionType);
+        // appends what value prints as to output
+        static void printValue(std::string & output, const Token & token, Values::Value value, const std::string & collectionType);
         
         static void printError(const Token & token, const std::string & errorMessage);
 
     public:
-        static Interpreter interpreter;
-        static Values::ValuePtr runBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment);
+        // evaluator is the interpreter or VM making the call, builtins that
+        // take a function apply it through evaluator
+        static Values::Value runBuiltin(const Token & token, Values::FunctionValuePtr functionValue, Values::Environment & environment, Evaluator & evaluator);
 };
\ No newline at end of file
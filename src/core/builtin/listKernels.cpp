@@ -0,0 +1,172 @@
+#include "listKernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    // no leaf holds more, so one leaf always fits
+    constexpr std::size_t GATHER_SIZE = 64;
+
+    // below this many, comparison sorting beats the radix sort's passes
+    constexpr std::size_t RADIX_SORT_MIN_SIZE = 256;
+
+    // calls reduce(ints, count) with the ints of each leaf of listData
+    template<typename Reduce>
+    void
+    forEachIntLeaf(const Values::ListData & listData, const Reduce & reduce) {
+        std::array<int, GATHER_SIZE> ints;
+        listData.forEachLeaf([&ints, &reduce](const Values::Value * elements, std::size_t count) {
+            while (count > 0) {
+                auto gathered = std::min(count, GATHER_SIZE);
+                for (std::size_t index = 0; index < gathered; ++index) {
+                    ints[index] = elements[index].intData();
+                }
+                reduce(ints.data(), gathered);
+                elements += gathered;
+                count -= gathered;
+            }
+        });
+    }
+
+    std::vector<int>
+    toInts(const Values::ListData & listData) {
+        std::vector<int> ints;
+        ints.reserve(listData.size());
+        forEachIntLeaf(listData, [&ints](const int * leafInts, std::size_t count) {
+            ints.insert(ints.end(), leafInts, leafInts + count);
+        });
+        return ints;
+    }
+
+    // least significant byte first; flipping the sign bit orders negative
+    // ints below positive ones. A pass is skipped when every int has the
+    // same byte there, as ints in a small range do in their high bytes.
+    void
+    radixSort(std::vector<int> & ints) {
+        std::vector<std::uint32_t> keys(ints.size());
+        std::transform(ints.begin(), ints.end(), keys.begin(),
+                       [](const int value) { return static_cast<std::uint32_t>(value) ^ 0x80000000u; });
+        std::vector<std::uint32_t> sortedKeys(keys.size());
+
+        for (unsigned int shift = 0; shift < 32; shift += 8) {
+            std::array<std::size_t, 256> offsets{};
+            for (auto key : keys) {
+                ++offsets[(key >> shift) & 0xff];
+            }
+            if (offsets[(keys.front() >> shift) & 0xff] == keys.size()) {
+                continue;
+            }
+
+            std::size_t offset = 0;
+            for (auto & bucketOffset : offsets) {
+                auto bucketSize = bucketOffset;
+                bucketOffset = offset;
+                offset += bucketSize;
+            }
+            for (auto key : keys) {
+                sortedKeys[offsets[(key >> shift) & 0xff]++] = key;
+            }
+            keys.swap(sortedKeys);
+        }
+
+        std::transform(keys.begin(), keys.end(), ints.begin(),
+                       [](const std::uint32_t key) { return static_cast<int>(key ^ 0x80000000u); });
+    }
+}
+
+int
+ListKernels::sum(const Values::ListData & listData) {
+    unsigned int sum = 0;
+    forEachIntLeaf(listData, [&sum](const int * ints, std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            sum += static_cast<unsigned int>(ints[index]);
+        }
+    });
+    return static_cast<int>(sum);
+}
+
+int
+ListKernels::product(const Values::ListData & listData) {
+    unsigned int product = 1;
+    forEachIntLeaf(listData, [&product](const int * ints, std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            product *= static_cast<unsigned int>(ints[index]);
+        }
+    });
+    return static_cast<int>(product);
+}
+
+int
+ListKernels::max(const Values::ListData & listData) {
+    int max = listData.at(0).intData();
+    forEachIntLeaf(listData, [&max](const int * ints, std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            max = (ints[index] > max) ? ints[index] : max;
+        }
+    });
+    return max;
+}
+
+int
+ListKernels::min(const Values::ListData & listData) {
+    int min = listData.at(0).intData();
+    forEachIntLeaf(listData, [&min](const int * ints, std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            min = (ints[index] < min) ? ints[index] : min;
+        }
+    });
+    return min;
+}
+
+Values::ListData
+ListKernels::sorted(const Values::ListData & listData, const bool descending) {
+    auto ints = toInts(listData);
+    if (ints.size() < RADIX_SORT_MIN_SIZE) {
+        std::sort(ints.begin(), ints.end());
+    } else {
+        radixSort(ints);
+    }
+
+    std::vector<Values::Value> sortedData(ints.size());
+    if (descending) {
+        std::transform(ints.rbegin(), ints.rend(), sortedData.begin(), Values::makeInt);
+    } else {
+        std::transform(ints.begin(), ints.end(), sortedData.begin(), Values::makeInt);
+    }
+    return sortedData;
+}
+
+Values::ListData
+ListKernels::reversed(const Values::ListData & listData) {
+    std::vector<Values::Value> reversedData(listData.size());
+    auto position = reversedData.rbegin();
+    listData.forEachLeaf([&position](const Values::Value * elements, std::size_t count) {
+        position = std::copy(elements, elements + count, position);
+    });
+    return reversedData;
+}
+
+bool
+ListKernels::equal(const Values::ListData & listData1, const Values::ListData & listData2, const Types::DataTypes & elementType) {
+    if (listData1.sharesAllWith(listData2)) {
+        return true;
+    } else if (listData1.size() != listData2.size()) {
+        return false;
+    }
+
+    switch (elementType) {
+        case Types::DataTypes::INT:
+            return std::equal(listData1.begin(), listData1.end(), listData2.begin(),
+                              [](const Values::Value & value1, const Values::Value & value2) { return value1.intData() == value2.intData(); });
+        case Types::DataTypes::CHAR:
+            return std::equal(listData1.begin(), listData1.end(), listData2.begin(),
+                              [](const Values::Value & value1, const Values::Value & value2) { return value1.charData() == value2.charData(); });
+        case Types::DataTypes::BOOL:
+            return std::equal(listData1.begin(), listData1.end(), listData2.begin(),
+                              [](const Values::Value & value1, const Values::Value & value2) { return value1.boolData() == value2.boolData(); });
+        default:
+            return std::equal(listData1.begin(), listData1.end(), listData2.begin(), Values::ValueEqual());
+    }
+}
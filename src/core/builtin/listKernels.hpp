@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../../defs/types.hpp"
+#include "../../defs/values.hpp"
+
+// The loops behind the List[int] builtins, and the comparison of lists of
+// primitives. Each runs over the raw data of one leaf of the list at a time
+// rather than stepping an iterator from Value to Value: the ints of a leaf
+// are gathered into a plain array and reduced there, and sorting is a radix
+// sort over the ints alone, with the Values made once at the end.
+class ListKernels {
+    public:
+        // sum and product wrap on overflow as int arithmetic does
+        static int sum(const Values::ListData & listData);
+        static int product(const Values::ListData & listData);
+        // listData is not empty
+        static int max(const Values::ListData & listData);
+        static int min(const Values::ListData & listData);
+
+        static Values::ListData sorted(const Values::ListData & listData, const bool descending);
+        static Values::ListData reversed(const Values::ListData & listData);
+
+        // elementType is the lists' static element type, their elements are
+        // compared by raw data when it is int, char or bool
+        static bool equal(const Values::ListData & listData1, const Values::ListData & listData2, const Types::DataTypes & elementType);
+};
@@ -0,0 +1,175 @@
+#include "prelude.hpp"
+
+#include <cctype>
+#include <stdexcept>
+
+Prelude::Prelude(const std::string_view & name, const std::string_view & signature, const ArenaPtr & arena)
+: arena(arena),
+  token(Token::TokenType::IDENT, FilePosition(0, 0, signature), name),
+  text(signature) { }
+
+std::vector<std::shared_ptr<Function>>
+Prelude::makeFunctions(const ArenaPtr & arena) {
+    std::vector<std::shared_ptr<Function>> functions;
+    functions.reserve(static_cast<size_t>(BuiltinDefinitions::BuiltinEnums::BUILTINNUM));
+    for (size_t index = 0; index < static_cast<size_t>(BuiltinDefinitions::BuiltinEnums::BUILTINNUM); ++index) {
+        const auto & definition = BuiltinDefinitions::getDefinition(static_cast<BuiltinDefinitions::BuiltinEnums>(index));
+        functions.push_back(Prelude(definition.name, definition.signature, arena).makeFunction());
+    }
+    return functions;
+}
+
+void
+Prelude::seed(const ExpPtr & rootExpression, const ArenaPtr & arena) {
+    auto program = std::static_pointer_cast<Program>(rootExpression);
+    auto builtins = makeFunctions(arena);
+    program->functions.insert(program->functions.begin(), builtins.begin(), builtins.end());
+}
+
+// Builds the same nodes the parser makes for "func name<signature> = { 0 };"
+std::shared_ptr<Function>
+Prelude::makeFunction() {
+    if (match("[")) {
+        do {
+            genericTypes.push_back(makeInArena<Types::GenType>(arena, readName()));
+        } while (match(","));
+        expect("]");
+    }
+
+    expect("(");
+    std::vector<std::shared_ptr<Argument>> arguments;
+    if (!match(")")) {
+        do {
+            arguments.push_back(readArgument());
+        } while (match(","));
+        expect(")");
+    }
+
+    expect("->");
+    Types::TypePtr functionReturnType = readType();
+    skipSpaces();
+    if (position != text.size()) {
+        fail("the end of the signature");
+    }
+
+    std::vector<Types::TypePtr> functionTypeArgumentTypes;
+    std::vector<std::string> functionArgumentNames;
+    for (const auto & argument : arguments) {
+        functionTypeArgumentTypes.push_back(argument->returnType);
+        functionArgumentNames.push_back(argument->name);
+    }
+
+    ExpPtr functionBody = makeInArena<Literal>(arena, token, Types::intType(), 0);
+    Types::FuncTypePtr functionType = makeInArena<Types::FuncType>(arena, genericTypes, functionTypeArgumentTypes, functionReturnType);
+    functionType->functionBody = functionBody;
+    functionType->argumentNames = functionArgumentNames;
+
+    return makeInArena<Function>(arena, token, functionType, std::string(token.text), genericTypes, arguments, functionBody);
+}
+
+std::shared_ptr<Argument>
+Prelude::readArgument() {
+    const std::string argumentName = readName();
+    expect(":");
+    return makeInArena<Argument>(arena, token, readType(), argumentName);
+}
+
+Types::TypePtr
+Prelude::readType() {
+    if (match("(")) {
+        std::vector<Types::TypePtr> functionArgumentTypes{readType()};
+        while (match(",")) {
+            functionArgumentTypes.push_back(readType());
+        }
+        expect(")");
+        expect("->");
+        return makeInArena<Types::FuncType>(arena, genericTypes, functionArgumentTypes, readType());
+    }
+
+    const std::string typeName = readName();
+    if (typeName == "List") {
+        expect("[");
+        Types::TypePtr listDataType = readType();
+        expect("]");
+        return Types::listOf(listDataType);
+    } else if (typeName == "Set") {
+        expect("[");
+        Types::TypePtr setDataType = readType();
+        expect("]");
+        return Types::setOf(setDataType);
+    } else if (typeName == "Map") {
+        expect("[");
+        Types::TypePtr keyType = readType();
+        expect(",");
+        Types::TypePtr valueType = readType();
+        expect("]");
+        return Types::mapOf(keyType, valueType);
+    } else if (typeName == "Tuple") {
+        expect("[");
+        std::vector<Types::TypePtr> tupleTypes{readType()};
+        while (match(",")) {
+            tupleTypes.push_back(readType());
+        }
+        expect("]");
+        return Types::tupleOf(tupleTypes);
+    }
+
+    Types::TypePtr type;
+    if (typeName == "int") type = Types::intType();
+    else if (typeName == "bool") type = Types::boolType();
+    else if (typeName == "char") type = Types::charType();
+    else if (typeName == "string") type = Types::stringType();
+    else if (typeName == "null") type = Types::nullType();
+    else return makeInArena<Types::GenType>(arena, typeName);
+
+    if (match("->")) {
+        std::vector<Types::TypePtr> functionTypeArgumentTypes{type};
+        return makeInArena<Types::FuncType>(arena, genericTypes, functionTypeArgumentTypes, readType());
+    }
+    return type;
+}
+
+std::string
+Prelude::readName() {
+    skipSpaces();
+    auto start = position;
+    while (position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '_')) {
+        ++position;
+    }
+    if (position == start) {
+        fail("a name");
+    }
+    return std::string(text.substr(start, position - start));
+}
+
+bool
+Prelude::match(const std::string_view & expected) {
+    skipSpaces();
+    if (text.compare(position, expected.size(), expected) == 0) {
+        position += expected.size();
+        return true;
+    }
+    return false;
+}
+
+void
+Prelude::expect(const std::string_view & expected) {
+    if (!match(expected)) {
+        fail("\"" + std::string(expected) + "\"");
+    }
+}
+
+// BANT_BUILTINS is checked against the same grammar when it is compiled,
+// so this only fails if the two grammars drift apart
+void
+Prelude::fail(const std::string & expected) const {
+    throw std::logic_error("Malformed signature of builtin " + std::string(token.text) + ": expected " + expected +
+                           " at " + std::to_string(position) + " in \"" + std::string(text) + "\"");
+}
+
+void
+Prelude::skipSpaces() {
+    while (position < text.size() && text[position] == ' ') {
+        ++position;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "builtinDefinitions.hpp"
+#include "../../defs/expressions.hpp"
+#include "../../defs/types.hpp"
+#include "../../defs/token.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Expressions;
+
+// The builtin functions, built as function nodes straight from a table of
+// their signatures rather than lexing, parsing and checking them as source
+// text in front of every program
+class Prelude {
+    private:
+        ArenaPtr arena;
+        Token token;
+        std::string_view text;
+        size_t position = 0;
+        std::vector<Types::GenTypePtr> genericTypes;
+
+        Prelude(const std::string_view & name, const std::string_view & signature, const ArenaPtr & arena);
+
+        std::shared_ptr<Function> makeFunction();
+        std::shared_ptr<Argument> readArgument();
+        Types::TypePtr readType();
+        std::string readName();
+
+        bool match(const std::string_view & expected);
+        void expect(const std::string_view & expected);
+        void fail(const std::string & expected) const;
+        void skipSpaces();
+
+    public:
+        static std::vector<std::shared_ptr<Function>> makeFunctions(const ArenaPtr & arena);
+
+        // Puts the builtins in the root block of a parsed program, as if
+        // their definitions came before the program's first line
+        static void seed(const ExpPtr & rootExpression, const ArenaPtr & arena);
+};
@@ -0,0 +1,614 @@
+#include "chunkCache.hpp"
+
+#include "buildId.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+ChunkCache::ChunkCache(const std::string & sourceStream, const std::string & options) {
+    const char * home = std::getenv("HOME");
+    if (!home || std::string(home).empty()) {
+        return;
+    }
+
+    // entries from another build of bant may decode differently
+    std::string key = std::string(CACHE_FORMAT) + " " + BANT_BUILD_ID + " " + options + "\n" + sourceStream;
+
+    std::stringstream nameStream;
+    nameStream << std::hex << std::setw(16) << std::setfill('0') << hash(key) << ".chunk";
+
+    directory = std::string(home) + "/.bant/cache";
+    entryPath = directory + "/" + nameStream.str();
+}
+
+Bytecode::ChunkPtr
+ChunkCache::load(const ArenaPtr & arena) {
+    if (entryPath.empty()) {
+        return nullptr;
+    }
+
+    std::ifstream entryFile(entryPath, std::ios::binary);
+    if (!entryFile.is_open()) {
+        return nullptr;
+    }
+
+    Reader reader(entryFile, arena);
+    if (reader.readString() != CACHE_FORMAT || reader.readString() != BANT_BUILD_ID) {
+        return nullptr;
+    }
+
+    auto importCount = reader.readInt();
+    for (long long importIndex = 0; importIndex < importCount && !reader.failed; ++importIndex) {
+        auto importedFile = reader.readString();
+        auto importHash = static_cast<uint64_t>(reader.readInt());
+
+        uint64_t fileHash = 0;
+        if (!hashFile(importedFile, fileHash) || fileHash != importHash) {
+            HEADER(std::string("Cached bytecode out of date: ") + importedFile + std::string(" changed"));
+            return nullptr;
+        }
+        importedFiles.push_back(importedFile);
+    }
+
+    auto chunk = reader.readChunk();
+    if (reader.failed) {
+        return nullptr;
+    }
+
+    HEADER(std::string("Loaded cached bytecode: ") + entryPath);
+    return chunk;
+}
+
+void
+ChunkCache::store(const Bytecode::ChunkPtr & chunk, const std::vector<std::string> & importedFiles) {
+    if (entryPath.empty()) {
+        return;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(directory, errorCode);
+    if (errorCode) {
+        return;
+    }
+
+    std::stringstream entryStream;
+    Writer writer(entryStream);
+    writer.writeString(CACHE_FORMAT);
+    writer.writeString(BANT_BUILD_ID);
+
+    writer.writeInt(static_cast<long long>(importedFiles.size()));
+    for (const auto & importedFile : importedFiles) {
+        uint64_t fileHash = 0;
+        hashFile(importedFile, fileHash);
+
+        writer.writeString(importedFile);
+        writer.writeInt(static_cast<long long>(fileHash));
+    }
+
+    writer.writeChunk(*chunk);
+
+    // written aside and renamed, so a concurrent run never reads half an entry
+    std::random_device randomDevice;
+    std::string temporaryPath = entryPath + "." + std::to_string(randomDevice()) + ".tmp";
+    {
+        std::ofstream entryFile(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!entryFile.is_open()) {
+            return;
+        }
+        entryFile << entryStream.rdbuf();
+    }
+
+    std::filesystem::rename(temporaryPath, entryPath, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(temporaryPath, errorCode);
+        return;
+    }
+    HEADER(std::string("Cached bytecode: ") + entryPath);
+}
+
+// FNV-1a
+uint64_t
+ChunkCache::hash(const std::string & data) {
+    uint64_t hashValue = 14695981039346656037ULL;
+    for (unsigned char character : data) {
+        hashValue ^= character;
+        hashValue *= 1099511628211ULL;
+    }
+    return hashValue;
+}
+
+bool
+ChunkCache::hashFile(const std::string & path, uint64_t & fileHash) {
+    std::ifstream fileStream(path, std::ios::binary);
+    std::ostringstream fileContents;
+    if (fileStream.is_open()) {
+        fileContents << fileStream.rdbuf();
+    }
+    fileHash = hash(fileContents.str());
+    return fileStream.is_open();
+}
+
+void
+ChunkCache::Writer::writeInt(const long long value) {
+    stream << value << ' ';
+}
+
+void
+ChunkCache::Writer::writeString(const std::string & value) {
+    stream << value.size() << ' ' << value << ' ';
+}
+
+void
+ChunkCache::Writer::writeToken(const Token & token) {
+    writeInt(static_cast<int>(token.type));
+    writeInt(token.position.fileLine);
+    writeInt(token.position.fileColumn);
+    writeString(token.position.currentLineText());
+    writeString(std::string(token.text));
+}
+
+void
+ChunkCache::Writer::writeLayout(const Expressions::FrameLayout & layout) {
+    if (!layout) {
+        writeInt(-1);
+        return;
+    }
+
+    writeInt(static_cast<long long>(layout->size()));
+    for (const auto & name : *layout) {
+        writeString(name);
+    }
+}
+
+void
+ChunkCache::Writer::writeArguments(const std::vector<std::shared_ptr<Expressions::Argument>> & arguments) {
+    writeInt(static_cast<long long>(arguments.size()));
+    for (const auto & argument : arguments) {
+        writeToken(argument->token);
+        writeString(argument->name);
+        writeType(argument->returnType);
+        writeInt(argument->slot);
+    }
+}
+
+// Written inline where first used: the definitions of any types not seen
+// yet, then "R index". Typeclasses get their index before their fields,
+// the only way a type can refer back to itself.
+int
+ChunkCache::Writer::writeType(const Types::TypePtr & type) {
+    auto typeIndex = typeIndices.find(type.get());
+    if (typeIndex == typeIndices.end()) {
+        stream << "D ";
+        writeInt(static_cast<int>(type->dataType));
+
+        if (type->dataType == Types::DataTypes::LIST) {
+            writeType(std::static_pointer_cast<Types::ListType>(type)->listType);
+        } else if (type->dataType == Types::DataTypes::SET) {
+            writeType(std::static_pointer_cast<Types::SetType>(type)->setType);
+        } else if (type->dataType == Types::DataTypes::MAP) {
+            auto mapType = std::static_pointer_cast<Types::MapType>(type);
+            writeType(mapType->keyType);
+            writeType(mapType->valueType);
+        } else if (type->dataType == Types::DataTypes::TUPLE) {
+            auto tupleType = std::static_pointer_cast<Types::TupleType>(type);
+            writeInt(static_cast<long long>(tupleType->tupleTypes.size()));
+            for (const auto & elementType : tupleType->tupleTypes) {
+                writeType(elementType);
+            }
+        } else if (type->dataType == Types::DataTypes::FUNC) {
+            auto funcType = std::static_pointer_cast<Types::FuncType>(type);
+            writeInt(static_cast<long long>(funcType->genericTypes.size()));
+            for (const auto & genericType : funcType->genericTypes) {
+                writeType(genericType);
+            }
+            writeInt(static_cast<long long>(funcType->argumentTypes.size()));
+            for (const auto & argumentType : funcType->argumentTypes) {
+                writeType(argumentType);
+            }
+            writeInt(static_cast<long long>(funcType->argumentNames.size()));
+            for (const auto & argumentName : funcType->argumentNames) {
+                writeString(argumentName);
+            }
+            writeType(funcType->returnType);
+            writeInt(funcType->isBuiltin);
+        } else if (type->dataType == Types::DataTypes::GEN) {
+            writeString(std::static_pointer_cast<Types::GenType>(type)->identifier);
+        } else if (type->dataType == Types::DataTypes::TYPECLASS) {
+            auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(type);
+            writeString(typeclassType->ident);
+            typeIndices[type.get()] = typeCount++;
+
+            writeInt(static_cast<long long>(typeclassType->fieldTypes.size()));
+            for (const auto & fieldType : typeclassType->fieldTypes) {
+                writeString(fieldType.first);
+                writeType(fieldType.second);
+            }
+        }
+
+        if (type->dataType != Types::DataTypes::TYPECLASS) {
+            typeIndices[type.get()] = typeCount++;
+        }
+        typeIndex = typeIndices.find(type.get());
+    }
+
+    stream << "R ";
+    writeInt(typeIndex->second);
+    return typeIndex->second;
+}
+
+void
+ChunkCache::Writer::writeChunk(const Bytecode::Chunk & chunk) {
+    writeInt(static_cast<long long>(chunk.code.size()));
+    for (const auto & instruction : chunk.code) {
+        writeInt(static_cast<int>(instruction.op));
+        writeInt(instruction.a);
+        writeInt(instruction.b);
+        writeInt(instruction.c);
+    }
+
+    writeInt(static_cast<long long>(chunk.constants.size()));
+    for (const auto & constant : chunk.constants) {
+        writeInt(static_cast<int>(constant.dataType()));
+        if (constant.dataType() == Types::DataTypes::INT) {
+            writeInt(constant.intData());
+        } else if (constant.dataType() == Types::DataTypes::CHAR) {
+            writeInt(constant.charData());
+        } else if (constant.dataType() == Types::DataTypes::BOOL) {
+            writeInt(constant.boolData());
+        } else if (constant.dataType() == Types::DataTypes::STRING) {
+            writeString(constant.as<Values::StringValue>()->str());
+        }
+    }
+
+    writeInt(static_cast<long long>(chunk.types.size()));
+    for (const auto & type : chunk.types) {
+        writeType(type);
+    }
+
+    writeInt(static_cast<long long>(chunk.sites.size()));
+    for (const auto & site : chunk.sites) {
+        writeToken(site.token);
+        writeString(site.name);
+        writeString(site.field);
+        writeInt(site.fieldIndex);
+    }
+
+    writeInt(static_cast<long long>(chunk.functions.size()));
+    for (const auto & functionEntry : chunk.functions) {
+        const auto & function = functionEntry.function;
+        writeToken(function->token);
+        writeString(function->name);
+        writeType(function->returnType);
+        writeInt(static_cast<long long>(function->genericParameters.size()));
+        for (const auto & genericParameter : function->genericParameters) {
+            writeType(genericParameter);
+        }
+        writeArguments(function->parameters);
+        writeLayout(function->frameLayout);
+        writeInt(function->slot);
+        writeInt(function->memoized);
+        writeInt(functionEntry.entry);
+    }
+
+    writeInt(static_cast<long long>(chunk.typeclasses.size()));
+    for (const auto & typeclass : chunk.typeclasses) {
+        writeToken(typeclass->token);
+        writeString(typeclass->ident);
+        writeType(typeclass->returnType);
+        writeArguments(typeclass->fields);
+        writeInt(typeclass->slot);
+    }
+
+    writeInt(static_cast<long long>(chunk.matches.size()));
+    for (const auto & matchJump : chunk.matches) {
+        const auto & entries = matchJump.table->getEntries();
+        writeInt(static_cast<long long>(entries.size()));
+        for (const auto & entry : entries) {
+            writeInt(static_cast<int>(entry.keyType));
+            writeInt(entry.intKey);
+            writeString(entry.stringKey);
+            writeInt(entry.arm);
+        }
+        writeInt(matchJump.table->getDefaultArm());
+        writeInt(matchJump.table->getArmCount());
+
+        for (auto armEntry : matchJump.armEntries) {
+            writeInt(armEntry);
+        }
+        writeInt(matchJump.noMatchEntry);
+    }
+
+    // the VM only needs the steps, argument expressions were compiled before them
+    writeInt(static_cast<long long>(chunk.pipelines.size()));
+    for (const auto & pipeline : chunk.pipelines) {
+        writeInt(static_cast<long long>(pipeline->getSteps().size()));
+        for (auto step : pipeline->getSteps()) {
+            writeInt(static_cast<int>(step));
+        }
+    }
+
+    writeLayout(chunk.frameLayout);
+}
+
+long long
+ChunkCache::Reader::readInt() {
+    long long value = 0;
+    if (!(stream >> value)) {
+        failed = true;
+        return 0;
+    }
+    return value;
+}
+
+std::string
+ChunkCache::Reader::readString() {
+    auto size = readInt();
+    if (failed || size < 0 || stream.get() != ' ') {
+        failed = true;
+        return std::string("");
+    }
+
+    std::string value(static_cast<size_t>(size), '\0');
+    if (!stream.read(&value[0], size)) {
+        failed = true;
+        return std::string("");
+    }
+    return value;
+}
+
+Token
+ChunkCache::Reader::readToken() {
+    auto tokenType = static_cast<Token::TokenType>(readInt());
+    int line = static_cast<int>(readInt());
+    int column = static_cast<int>(readInt());
+    auto lineText = arena->sources().intern(readString());
+    return Token(tokenType, FilePosition(line, column, lineText), arena->sources().intern(readString()));
+}
+
+Expressions::FrameLayout
+ChunkCache::Reader::readLayout() {
+    auto size = readInt();
+    if (size < 0) {
+        return nullptr;
+    }
+
+    auto layout = std::make_shared<std::vector<std::string>>();
+    for (long long nameIndex = 0; nameIndex < size && !failed; ++nameIndex) {
+        layout->push_back(readString());
+    }
+    return layout;
+}
+
+std::vector<std::shared_ptr<Expressions::Argument>>
+ChunkCache::Reader::readArguments() {
+    std::vector<std::shared_ptr<Expressions::Argument>> arguments;
+    auto size = readInt();
+    for (long long argumentIndex = 0; argumentIndex < size && !failed; ++argumentIndex) {
+        auto token = readToken();
+        auto name = readString();
+        auto argument = makeInArena<Expressions::Argument>(arena, token, readTypeIndex(), name);
+        argument->slot = static_cast<int>(readInt());
+        arguments.push_back(argument);
+    }
+    return arguments;
+}
+
+Types::TypePtr
+ChunkCache::Reader::readTypeIndex() {
+    std::string tag;
+    while (!failed && stream >> tag && tag == "D") {
+        readType();
+    }
+
+    auto typeIndex = readInt();
+    if (failed || tag != "R" || typeIndex < 0 || typeIndex >= static_cast<long long>(types.size())) {
+        failed = true;
+        return makeInArena<Types::UnknownType>(arena);
+    }
+    return types.at(typeIndex);
+}
+
+// Reads one definition written by Writer::writeType, the "D" already read
+bool
+ChunkCache::Reader::readType() {
+    auto dataType = static_cast<Types::DataTypes>(readInt());
+
+    Types::TypePtr type;
+    if (dataType == Types::DataTypes::INT) {
+        type = Types::intType();
+    } else if (dataType == Types::DataTypes::CHAR) {
+        type = Types::charType();
+    } else if (dataType == Types::DataTypes::STRING) {
+        type = Types::stringType();
+    } else if (dataType == Types::DataTypes::BOOL) {
+        type = Types::boolType();
+    } else if (dataType == Types::DataTypes::NULLVAL) {
+        type = Types::nullType();
+    } else if (dataType == Types::DataTypes::LIST) {
+        type = Types::listOf(readTypeIndex());
+    } else if (dataType == Types::DataTypes::SET) {
+        type = Types::setOf(readTypeIndex());
+    } else if (dataType == Types::DataTypes::MAP) {
+        auto keyType = readTypeIndex();
+        type = Types::mapOf(keyType, readTypeIndex());
+    } else if (dataType == Types::DataTypes::TUPLE) {
+        std::vector<Types::TypePtr> tupleTypes;
+        auto size = readInt();
+        for (long long elementIndex = 0; elementIndex < size && !failed; ++elementIndex) {
+            tupleTypes.push_back(readTypeIndex());
+        }
+        type = Types::tupleOf(tupleTypes);
+    } else if (dataType == Types::DataTypes::FUNC) {
+        std::vector<Types::GenTypePtr> genericTypes;
+        auto genericCount = readInt();
+        for (long long genericIndex = 0; genericIndex < genericCount && !failed; ++genericIndex) {
+            auto genericType = readTypeIndex();
+            if (genericType->dataType != Types::DataTypes::GEN) {
+                failed = true;
+                return false;
+            }
+            genericTypes.push_back(std::static_pointer_cast<Types::GenType>(genericType));
+        }
+
+        std::vector<Types::TypePtr> argumentTypes;
+        auto argumentCount = readInt();
+        for (long long argumentIndex = 0; argumentIndex < argumentCount && !failed; ++argumentIndex) {
+            argumentTypes.push_back(readTypeIndex());
+        }
+
+        std::vector<std::string> argumentNames;
+        auto nameCount = readInt();
+        for (long long nameIndex = 0; nameIndex < nameCount && !failed; ++nameIndex) {
+            argumentNames.push_back(readString());
+        }
+
+        auto returnType = readTypeIndex();
+        auto funcType = makeInArena<Types::FuncType>(arena, genericTypes, argumentTypes, returnType);
+        funcType->argumentNames = argumentNames;
+        funcType->isBuiltin = (readInt() != 0);
+        type = funcType;
+    } else if (dataType == Types::DataTypes::GEN) {
+        type = makeInArena<Types::GenType>(arena, readString());
+    } else if (dataType == Types::DataTypes::TYPECLASS) {
+        auto typeclassType = makeInArena<Types::TypeclassType>(arena, readString());
+        types.push_back(typeclassType);
+
+        auto fieldCount = readInt();
+        for (long long fieldIndex = 0; fieldIndex < fieldCount && !failed; ++fieldIndex) {
+            auto fieldName = readString();
+            typeclassType->fieldTypes.emplace_back(fieldName, readTypeIndex());
+        }
+        return !failed;
+    } else {
+        type = makeInArena<Types::UnknownType>(arena);
+    }
+
+    types.push_back(type);
+    return !failed;
+}
+
+Bytecode::ChunkPtr
+ChunkCache::Reader::readChunk() {
+    auto chunk = std::make_shared<Bytecode::Chunk>();
+
+    auto codeSize = readInt();
+    chunk->code.reserve(static_cast<size_t>(std::max(codeSize, 0LL)));
+    for (long long offset = 0; offset < codeSize && !failed; ++offset) {
+        auto op = static_cast<Bytecode::OpCode>(readInt());
+        int a = static_cast<int>(readInt());
+        int b = static_cast<int>(readInt());
+        int c = static_cast<int>(readInt());
+        chunk->code.emplace_back(op, a, b, c);
+    }
+
+    auto constantCount = readInt();
+    for (long long constantIndex = 0; constantIndex < constantCount && !failed; ++constantIndex) {
+        auto dataType = static_cast<Types::DataTypes>(readInt());
+        if (dataType == Types::DataTypes::INT) {
+            chunk->constants.push_back(Values::makeInt(static_cast<int>(readInt())));
+        } else if (dataType == Types::DataTypes::CHAR) {
+            chunk->constants.push_back(Values::makeChar(static_cast<char>(readInt())));
+        } else if (dataType == Types::DataTypes::BOOL) {
+            chunk->constants.push_back(Values::makeBool(readInt() != 0));
+        } else if (dataType == Types::DataTypes::STRING) {
+            chunk->constants.push_back(std::make_shared<Values::StringValue>(Types::stringType(), readString()));
+        } else {
+            chunk->constants.push_back(Values::makeNull());
+        }
+    }
+
+    auto typeCount = readInt();
+    for (long long typeIndex = 0; typeIndex < typeCount && !failed; ++typeIndex) {
+        chunk->types.push_back(readTypeIndex());
+    }
+
+    auto siteCount = readInt();
+    for (long long siteIndex = 0; siteIndex < siteCount && !failed; ++siteIndex) {
+        auto token = readToken();
+        auto name = readString();
+        auto field = readString();
+        chunk->sites.emplace_back(token, name, field, static_cast<int>(readInt()));
+    }
+
+    // bodies are not needed to run, the entry offsets stand in for them
+    auto functionCount = readInt();
+    for (long long functionIndex = 0; functionIndex < functionCount && !failed; ++functionIndex) {
+        auto token = readToken();
+        auto name = readString();
+        auto returnType = readTypeIndex();
+
+        std::vector<Types::GenTypePtr> genericParameters;
+        auto genericCount = readInt();
+        for (long long genericIndex = 0; genericIndex < genericCount && !failed; ++genericIndex) {
+            genericParameters.push_back(std::static_pointer_cast<Types::GenType>(readTypeIndex()));
+        }
+
+        auto function = makeInArena<Expressions::Function>(arena, token, returnType, name, genericParameters,
+                                                                readArguments(), Expressions::Expression::End(arena));
+        function->frameLayout = readLayout();
+        function->slot = static_cast<int>(readInt());
+        function->memoized = (readInt() != 0);
+        if (BuiltinDefinitions::isBuiltin(name)) {
+            function->isBuiltin = true;
+            function->builtinEnum = BuiltinDefinitions::getBuiltin(name);
+        }
+
+        chunk->functions.emplace_back(function);
+        chunk->functions.back().entry = static_cast<int>(readInt());
+    }
+
+    auto typeclassCount = readInt();
+    for (long long typeclassIndex = 0; typeclassIndex < typeclassCount && !failed; ++typeclassIndex) {
+        auto token = readToken();
+        auto ident = readString();
+        auto typeclassType = readTypeIndex();
+        auto typeclass = makeInArena<Expressions::Typeclass>(arena, token, ident, readArguments(), typeclassType);
+        typeclass->slot = static_cast<int>(readInt());
+        chunk->typeclasses.push_back(typeclass);
+    }
+
+    auto matchCount = readInt();
+    for (long long matchIndex = 0; matchIndex < matchCount && !failed; ++matchIndex) {
+        std::vector<MatchTable::Entry> entries;
+        auto entryCount = readInt();
+        for (long long entryIndex = 0; entryIndex < entryCount && !failed; ++entryIndex) {
+            MatchTable::Entry entry;
+            entry.keyType = static_cast<Types::DataTypes>(readInt());
+            entry.intKey = static_cast<int>(readInt());
+            entry.stringKey = readString();
+            entry.arm = static_cast<int>(readInt());
+            entries.push_back(entry);
+        }
+        auto defaultArm = static_cast<int>(readInt());
+        auto armCount = static_cast<int>(readInt());
+
+        Bytecode::MatchJump matchJump;
+        matchJump.table = std::make_shared<MatchTable>(entries, defaultArm, armCount);
+        for (int arm = 0; arm < armCount && !failed; ++arm) {
+            matchJump.armEntries.push_back(static_cast<int>(readInt()));
+        }
+        matchJump.noMatchEntry = static_cast<int>(readInt());
+        chunk->matches.push_back(matchJump);
+    }
+
+    auto pipelineCount = readInt();
+    for (long long pipelineIndex = 0; pipelineIndex < pipelineCount && !failed; ++pipelineIndex) {
+        std::vector<Pipeline::Step> steps;
+        auto stepCount = readInt();
+        for (long long stepIndex = 0; stepIndex < stepCount && !failed; ++stepIndex) {
+            steps.push_back(static_cast<Pipeline::Step>(readInt()));
+        }
+        chunk->pipelines.push_back(std::make_shared<Pipeline>(steps, std::vector<Expressions::ExpPtr>{}));
+    }
+
+    chunk->frameLayout = readLayout();
+
+    if (failed) {
+        return nullptr;
+    }
+    return chunk;
+}
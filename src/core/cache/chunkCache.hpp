@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../../utils/logger.hpp"
+#include "../../defs/expressions.hpp"
+#include "../../defs/types.hpp"
+#include "../../defs/values.hpp"
+#include "../compiler/bytecode.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Compiled programs kept under ~/.bant/cache, so a warm run skips lexing,
+// parsing, checking and compiling. An entry is named by a hash of the
+// source and the options it was built with, and records the files the
+// source imports with a hash of each: it is only used while all of them
+// are unchanged. Entries are also keyed on BANT_BUILD_ID, which the
+// Makefile generates from the sources, so a rebuild never reads entries
+// an older build wrote.
+class ChunkCache {
+    private:
+        static constexpr const char * CACHE_FORMAT = "bant-chunk";
+
+        std::string directory;
+        std::string entryPath;
+        std::vector<std::string> importedFiles;
+
+        class Writer {
+            private:
+                std::ostream & stream;
+                std::map<const Types::Type *, int> typeIndices;
+                int typeCount = 0;
+
+            public:
+                explicit Writer(std::ostream & stream) : stream(stream) { }
+
+                void writeInt(const long long value);
+                void writeString(const std::string & value);
+                void writeToken(const Token & token);
+                void writeLayout(const Expressions::FrameLayout & layout);
+                void writeArguments(const std::vector<std::shared_ptr<Expressions::Argument>> & arguments);
+                int writeType(const Types::TypePtr & type);
+                void writeChunk(const Bytecode::Chunk & chunk);
+        };
+
+        class Reader {
+            private:
+                std::istream & stream;
+                ArenaPtr arena;
+                std::vector<Types::TypePtr> types;
+
+            public:
+                bool failed = false;
+
+                Reader(std::istream & stream, const ArenaPtr & arena) : stream(stream), arena(arena) { }
+
+                long long readInt();
+                std::string readString();
+                Token readToken();
+                Expressions::FrameLayout readLayout();
+                std::vector<std::shared_ptr<Expressions::Argument>> readArguments();
+                Types::TypePtr readTypeIndex();
+                bool readType();
+                Bytecode::ChunkPtr readChunk();
+        };
+
+    public:
+        // options are the flags that change what a source compiles to
+        ChunkCache(const std::string & sourceStream, const std::string & options);
+
+        // nodes the chunk refers to are made in arena
+        Bytecode::ChunkPtr load(const ArenaPtr & arena);
+        void store(const Bytecode::ChunkPtr & chunk, const std::vector<std::string> & importedFiles);
+
+        // files the chunk last loaded was built from
+        const std::vector<std::string> & getImportedFiles() const { return importedFiles; }
+
+        static uint64_t hash(const std::string & data);
+        // hash of the contents of path, false if it could not be read
+        static bool hashFile(const std::string & path, uint64_t & fileHash);
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../../defs/expressions.hpp"
+#include "../../defs/values.hpp"
+#include "../../defs/token.hpp"
+#include "../interpreter/matchTable.hpp"
+#include "../interpreter/pipeline.hpp"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Bytecode {
+    enum class OpCode {
+        CONSTANT,       // push constants[a]
+        LOAD,           // push the name at (depth a, slot b), by name sites[c] if unresolved
+        LOAD_FIELD,     // replace the top with its tuple element or typeclass field sites[c]
+        STORE,          // pop into slot a of the running frame
+        DUP,
+        PRIMITIVE,      // pop right and left, push (left op a right), reported at sites[c]
+        JUMP,           // continue at a
+        JUMP_IF_FALSE,  // pop a bool, continue at a if it is false
+        MATCH,          // pop a value, continue at the arm of matches[a] it selects
+        MAKE_FUNCTION,  // push a closure over the running frame for functions[a]
+        MAKE_TYPECLASS, // push an uninitialized value of typeclasses[a]
+        MAKE_LIST,      // pop a values into a list of types[b]
+        MAKE_TUPLE,     // pop a values into a tuple of types[b]
+        CALL,           // apply the value below the top a arguments to them, reported at sites[c]
+        TAIL_CALL,      // CALL whose callee returns for the running frame, which it replaces
+        PIPELINE,       // pop the a arguments of pipelines[b], push what running it makes, reported at sites[c]
+        RETURN,
+        FAIL            // report sites[c] as a runtime error
+    };
+
+    class Instruction {
+        public:
+            OpCode op;
+            int a = 0;
+            int b = 0;
+            int c = 0;
+
+            Instruction(const OpCode op, const int a = 0, const int b = 0, const int c = 0)
+            : op(op),
+              a(a),
+              b(b),
+              c(c) { }
+    };
+
+    // Source location and names an instruction needs to report errors
+    class Site {
+        public:
+            Token token;
+            std::string name;
+            std::string field;
+            int fieldIndex; // of field, resolved by the type checker, -1 if not
+
+            Site(const Token & token,
+                 const std::string & name,
+                 const std::string & field = std::string(""),
+                 const int fieldIndex = -1)
+            : token(token),
+              name(name),
+              field(field),
+              fieldIndex(fieldIndex) { }
+    };
+
+    class FunctionEntry {
+        public:
+            std::shared_ptr<Expressions::Function> function;
+            int entry = -1;
+
+            explicit FunctionEntry(const std::shared_ptr<Expressions::Function> & function)
+            : function(function) { }
+    };
+
+    // A lowered match, with the offset each of its arms starts at
+    class MatchJump {
+        public:
+            MatchTablePtr table;
+            std::vector<int> armEntries;
+            int noMatchEntry = -1; // pushes null
+    };
+
+    class Chunk {
+        public:
+            std::vector<Instruction> code;
+
+            std::vector<Values::Value> constants;
+            std::vector<Types::TypePtr> types;
+            std::vector<Site> sites;
+            std::vector<FunctionEntry> functions;
+            std::vector<std::shared_ptr<Expressions::Typeclass>> typeclasses;
+            std::vector<MatchJump> matches;
+            std::vector<PipelinePtr> pipelines;
+
+            Expressions::FrameLayout frameLayout; // layout of the root frame
+            ArenaPtr arena; // owns the nodes and source text the chunk points into
+
+            std::string toString() const {
+                static const char * opCodeNames[] = {
+                    "CONSTANT", "LOAD", "LOAD_FIELD", "STORE", "DUP",
+                    "PRIMITIVE", "JUMP", "JUMP_IF_FALSE", "MATCH",
+                    "MAKE_FUNCTION", "MAKE_TYPECLASS", "MAKE_LIST", "MAKE_TUPLE",
+                    "CALL", "TAIL_CALL", "PIPELINE", "RETURN", "FAIL"
+                };
+
+                std::stringstream chunkStream;
+                for (unsigned int offset = 0; offset < code.size(); ++offset) {
+                    for (const auto & function : functions) {
+                        if (function.entry == static_cast<int>(offset)) {
+                            chunkStream << function.function->name << ":" << std::endl;
+                        }
+                    }
+                    const auto & instruction = code.at(offset);
+                    chunkStream << "\t" << offset << "\t" << opCodeNames[static_cast<int>(instruction.op)]
+                                << " " << instruction.a << " " << instruction.b << " " << instruction.c << std::endl;
+                }
+                return chunkStream.str();
+            }
+    };
+
+    using ChunkPtr = std::shared_ptr<Chunk>;
+}
@@ -0,0 +1,292 @@
+#include "compiler.hpp"
+
+Compiler::Compiler(const ExpPtr & rootExpression)
+: rootExpression(rootExpression),
+  chunk(std::make_shared<Bytecode::Chunk>()) { }
+
+Bytecode::ChunkPtr
+Compiler::compile() {
+    HEADER("Compiling");
+    chunk->frameLayout = static_cast<Program *>(rootExpression.get())->frameLayout;
+
+    compile(rootExpression);
+    emit(Bytecode::OpCode::RETURN);
+
+    // bodies are laid out after the code that defines them, nested
+    // functions are appended to the table while it is walked
+    for (unsigned int functionIndex = 0; functionIndex < chunk->functions.size(); ++functionIndex) {
+        auto function = chunk->functions.at(functionIndex).function;
+        if (BuiltinDefinitions::isBuiltin(function->name)) {
+            continue;
+        }
+
+        chunk->functions.at(functionIndex).entry = static_cast<int>(chunk->code.size());
+        compile(function->functionBody);
+        emit(Bytecode::OpCode::RETURN);
+    }
+
+    HEADER("Bytecode");
+    HEADER(chunk->toString());
+    return chunk;
+}
+
+void
+Compiler::compile(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG)
+        compileProgram(expression);
+    else if (expression->expType == ExpressionTypes::LIT)
+        compileLiteral(expression);
+    else if (expression->expType == ExpressionTypes::PRIM)
+        compilePrimitive(expression);
+    else if (expression->expType == ExpressionTypes::LET)
+        compileLet(expression);
+    else if (expression->expType == ExpressionTypes::REF)
+        compileReference(expression);
+    else if (expression->expType == ExpressionTypes::BRANCH)
+        compileBranch(expression);
+    else if (expression->expType == ExpressionTypes::TYPECLASS)
+        compileTypeclass(expression);
+    else if (expression->expType == ExpressionTypes::APP)
+        compileApplication(expression);
+    else if (expression->expType == ExpressionTypes::LIST_DEF)
+        compileListDefinition(expression);
+    else if (expression->expType == ExpressionTypes::TUPLE_DEF)
+        compileTupleDefinition(expression);
+    else if (expression->expType == ExpressionTypes::MATCH)
+        compileMatch(expression);
+    else if (expression->expType == ExpressionTypes::END)
+        emit(Bytecode::OpCode::CONSTANT, addConstant(Values::makeNull()));
+    else
+        emitFail(expression->token, std::string("Unknown expression type: ") + std::string(expression->token.text));
+}
+
+void
+Compiler::compileProgram(const ExpPtr & expression) {
+    auto program = static_cast<Program *>(expression.get());
+
+    for (auto & function : program->functions) {
+        chunk->functions.emplace_back(function);
+        emit(Bytecode::OpCode::MAKE_FUNCTION, static_cast<int>(chunk->functions.size()) - 1);
+        emit(Bytecode::OpCode::STORE, function->slot);
+    }
+
+    compile(program->body);
+}
+
+void
+Compiler::compileLiteral(const ExpPtr & expression) {
+    auto literal = static_cast<Literal *>(expression.get());
+
+    Values::Value value;
+    if (literal->returnType->dataType == Types::DataTypes::INT) {
+        value = Values::makeInt(std::get<int>(literal->data));
+    } else if (literal->returnType->dataType == Types::DataTypes::CHAR) {
+        value = Values::makeChar(std::get<char>(literal->data));
+    } else if (literal->returnType->dataType == Types::DataTypes::STRING) {
+        value = (literal->stringValue) ? Values::Value(literal->stringValue)
+                                       : Values::Value(std::make_shared<Values::StringValue>(literal->returnType, std::get<std::string>(literal->data)));
+    } else if (literal->returnType->dataType == Types::DataTypes::BOOL) {
+        value = Values::makeBool(std::get<bool>(literal->data));
+    } else if (literal->returnType->dataType == Types::DataTypes::NULLVAL) {
+        value = Values::makeNull();
+    }
+
+    if (!value) {
+        emitFail(literal->token, std::string("Error: Unknown literal type: ") +
+                                 literal->token.position.currentLineText());
+        return;
+    }
+    emit(Bytecode::OpCode::CONSTANT, addConstant(value));
+}
+
+void
+Compiler::compilePrimitive(const ExpPtr & expression) {
+    auto primitive = static_cast<Primitive *>(expression.get());
+
+    compile(primitive->leftSide);
+    compile(primitive->rightSide);
+    emit(Bytecode::OpCode::PRIMITIVE, static_cast<int>(primitive->op), 0,
+         addSite(primitive->token, std::string("")));
+}
+
+void
+Compiler::compileLet(const ExpPtr & expression) {
+    auto let = static_cast<Let *>(expression.get());
+
+    compile(let->value);
+    emit(Bytecode::OpCode::STORE, let->slot);
+    compile(let->afterLet);
+}
+
+void
+Compiler::compileReference(const ExpPtr & expression) {
+    auto reference = static_cast<Reference *>(expression.get());
+
+    int site = addSite(reference->token, reference->ident, reference->fieldIdent, reference->fieldIndex);
+    emit(Bytecode::OpCode::LOAD, reference->address.depth, reference->address.slot, site);
+    if (!reference->fieldIdent.empty()) {
+        emit(Bytecode::OpCode::LOAD_FIELD, 0, 0, site);
+    }
+}
+
+void
+Compiler::compileBranch(const ExpPtr & expression) {
+    auto branch = static_cast<Branch *>(expression.get());
+
+    compile(branch->condition);
+    int elseJump = emit(Bytecode::OpCode::JUMP_IF_FALSE);
+    compile(branch->ifBranch);
+    int endJump = emit(Bytecode::OpCode::JUMP);
+
+    patchJump(elseJump);
+    compile(branch->elseBranch);
+    patchJump(endJump);
+}
+
+void
+Compiler::compileTypeclass(const ExpPtr & expression) {
+    auto typeclass = static_cast<Typeclass *>(expression.get());
+
+    chunk->typeclasses.push_back(std::static_pointer_cast<Typeclass>(expression));
+    emit(Bytecode::OpCode::MAKE_TYPECLASS, static_cast<int>(chunk->typeclasses.size()) - 1);
+    emit(Bytecode::OpCode::DUP);
+    emit(Bytecode::OpCode::STORE, typeclass->slot);
+}
+
+void
+Compiler::compileApplication(const ExpPtr & expression) {
+    auto application = static_cast<Application *>(expression.get());
+
+    if (application->pipeline) {
+        const auto & arguments = application->pipeline->getArguments();
+        for (auto & argument : arguments) {
+            compile(argument);
+        }
+
+        chunk->pipelines.push_back(application->pipeline);
+        emit(Bytecode::OpCode::PIPELINE, static_cast<int>(arguments.size()), static_cast<int>(chunk->pipelines.size()) - 1,
+             addSite(application->token, std::string(application->pipeline->name())));
+        return;
+    }
+
+    compile(application->ident);
+    for (auto & argument : application->arguments) {
+        compile(argument);
+    }
+
+    std::string functionName("");
+    if (application->ident->expType == ExpressionTypes::REF) {
+        functionName = static_cast<Reference *>(application->ident.get())->ident;
+    }
+    emit((application->isTailCall) ? Bytecode::OpCode::TAIL_CALL : Bytecode::OpCode::CALL,
+         static_cast<int>(application->arguments.size()), 0,
+         addSite(application->token, functionName));
+}
+
+void
+Compiler::compileListDefinition(const ExpPtr & expression) {
+    auto listDefinition = static_cast<ListDefinition *>(expression.get());
+
+    for (auto & value : listDefinition->values) {
+        compile(value);
+    }
+    emit(Bytecode::OpCode::MAKE_LIST, static_cast<int>(listDefinition->values.size()),
+         addType(listDefinition->returnType));
+}
+
+void
+Compiler::compileTupleDefinition(const ExpPtr & expression) {
+    auto tupleDefinition = static_cast<TupleDefinition *>(expression.get());
+
+    for (auto & value : tupleDefinition->values) {
+        compile(value);
+    }
+    emit(Bytecode::OpCode::MAKE_TUPLE, static_cast<int>(tupleDefinition->values.size()),
+         addType(tupleDefinition->returnType));
+}
+
+void
+Compiler::compileMatch(const ExpPtr & expression) {
+    auto match = static_cast<Match *>(expression.get());
+    int matchSite = addSite(match->token, match->ident);
+
+    std::vector<int> endJumps;
+    if (match->table) {
+        int matchIndex = static_cast<int>(chunk->matches.size());
+        chunk->matches.emplace_back();
+        chunk->matches.back().table = match->table;
+
+        emit(Bytecode::OpCode::LOAD, match->address.depth, match->address.slot, matchSite);
+        emit(Bytecode::OpCode::MATCH, matchIndex, 0, matchSite);
+        for (int arm = 0; arm < match->table->getArmCount(); ++arm) {
+            chunk->matches.at(matchIndex).armEntries.push_back(static_cast<int>(chunk->code.size()));
+            compile(match->cases.at(arm)->body);
+            endJumps.push_back(emit(Bytecode::OpCode::JUMP));
+        }
+
+        chunk->matches.at(matchIndex).noMatchEntry = static_cast<int>(chunk->code.size());
+        emit(Bytecode::OpCode::CONSTANT, addConstant(Values::makeNull()));
+        for (auto endJump : endJumps) {
+            patchJump(endJump);
+        }
+        return;
+    }
+
+    for (auto & casePtr : match->cases) {
+        if (casePtr->ident->expType == ExpressionTypes::REF &&
+            static_cast<Reference *>(casePtr->ident.get())->ident == std::string("$any")) {
+            compile(casePtr->body);
+            endJumps.push_back(emit(Bytecode::OpCode::JUMP));
+            break;
+        }
+
+        emit(Bytecode::OpCode::LOAD, match->address.depth, match->address.slot, matchSite);
+        compile(casePtr->ident);
+        emit(Bytecode::OpCode::PRIMITIVE, static_cast<int>(Operator::OperatorTypes::EQ), 0, matchSite);
+        int nextJump = emit(Bytecode::OpCode::JUMP_IF_FALSE);
+
+        compile(casePtr->body);
+        endJumps.push_back(emit(Bytecode::OpCode::JUMP));
+        patchJump(nextJump);
+    }
+
+    // no case matched
+    emit(Bytecode::OpCode::CONSTANT, addConstant(Values::makeNull()));
+    for (auto endJump : endJumps) {
+        patchJump(endJump);
+    }
+}
+
+int
+Compiler::emit(const Bytecode::OpCode op, const int a, const int b, const int c) {
+    chunk->code.emplace_back(op, a, b, c);
+    return static_cast<int>(chunk->code.size()) - 1;
+}
+
+void
+Compiler::patchJump(const int offset) {
+    chunk->code.at(offset).a = static_cast<int>(chunk->code.size());
+}
+
+int
+Compiler::addConstant(const Values::Value & value) {
+    chunk->constants.push_back(value);
+    return static_cast<int>(chunk->constants.size()) - 1;
+}
+
+int
+Compiler::addType(const Types::TypePtr & type) {
+    chunk->types.push_back(type);
+    return static_cast<int>(chunk->types.size()) - 1;
+}
+
+int
+Compiler::addSite(const Token & token, const std::string & name, const std::string & field, const int fieldIndex) {
+    chunk->sites.emplace_back(token, name, field, fieldIndex);
+    return static_cast<int>(chunk->sites.size()) - 1;
+}
+
+void
+Compiler::emitFail(const Token & token, const std::string & errorMessage) {
+    emit(Bytecode::OpCode::FAIL, 0, 0, addSite(token, errorMessage));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../../utils/logger.hpp"
+#include "../../defs/expressions.hpp"
+#include "../../defs/values.hpp"
+#include "bytecode.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Expressions;
+
+class Compiler {
+    private:
+        ExpPtr rootExpression;
+        Bytecode::ChunkPtr chunk;
+
+        void compile(const ExpPtr & expression);
+
+        void compileProgram(const ExpPtr & expression);
+        void compileLiteral(const ExpPtr & expression);
+        void compilePrimitive(const ExpPtr & expression);
+        void compileLet(const ExpPtr & expression);
+        void compileReference(const ExpPtr & expression);
+        void compileBranch(const ExpPtr & expression);
+        void compileTypeclass(const ExpPtr & expression);
+        void compileApplication(const ExpPtr & expression);
+        void compileListDefinition(const ExpPtr & expression);
+        void compileTupleDefinition(const ExpPtr & expression);
+        void compileMatch(const ExpPtr & expression);
+
+        int emit(const Bytecode::OpCode op, const int a = 0, const int b = 0, const int c = 0);
+        void patchJump(const int offset);
+
+        int addConstant(const Values::Value & value);
+        int addType(const Types::TypePtr & type);
+        int addSite(const Token & token, const std::string & name, const std::string & field = std::string(""), const int fieldIndex = -1);
+        void emitFail(const Token & token, const std::string & errorMessage);
+
+    public:
+        explicit Compiler(const ExpPtr & rootExpression);
+
+        Bytecode::ChunkPtr compile();
+};
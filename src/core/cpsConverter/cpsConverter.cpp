@@ -1,187 +1,165 @@
 #include "cpsConverter.hpp"
 
-CPSConverter::CPSConverter(const ExpPtr & rootExpression)
-: rootExpression(rootExpression) { }
+CPSConverter::CPSConverter(const ExpPtr & rootExpression, const ArenaPtr & arena)
+: rootExpression(rootExpression),
+  arena(arena) { }
 
 void
 CPSConverter::convert() {
     HEADER("CPS Conversion");
-    convert(rootExpression);
+    rootExpression = convert(rootExpression);
     HEADER("CPS Conversion Done");
 
     HEADER("CPS AST");
-    if (Logger::getInstance().getLevel() == DEBUG) {
+    if (Logger::current().getLevel() == DEBUG) {
         PrettyPrint printer;
         printer.print(rootExpression);
     }
 }
 
 ExpPtr
-CPSConverter::convert(ExpPtr expression) {
+CPSConverter::convert(const ExpPtr & expression) {
     if (expression->expType == ExpressionTypes::PROG)
         return convertProgram(expression);
-    else if (expression->expType == ExpressionTypes::LIT)
-        return convertLiteral(expression);
-    else if (expression->expType == ExpressionTypes::PRIM)
-        return convertPrimitive(expression);
     else if (expression->expType == ExpressionTypes::LET)
         return convertLet(expression);
-    /*
     else if (expression->expType == ExpressionTypes::BRANCH)
         return convertBranch(expression);
-    else if (expression->expType == ExpressionTypes::APP)
-        return convertApplication(expression);
-    */
-    else if (expression->expType == ExpressionTypes::LIST_DEF)
-        return convertListDefinition(expression);
-    else if (expression->expType == ExpressionTypes::TUPLE_DEF)
-        return convertTupleDefinition(expression);
-    /*
     else if (expression->expType == ExpressionTypes::MATCH)
         return convertMatch(expression);
-    */
-    else // reference, typeclass
-        return expression;
+
+    std::vector<Binding> bindings;
+    auto value = convertOperands(expression, bindings);
+    return bindAll(bindings, value);
 }
 
 ExpPtr
-CPSConverter::convertProgram(ExpPtr expression) {
+CPSConverter::convertProgram(const ExpPtr & expression) {
     auto program = std::static_pointer_cast<Program>(expression);
-    // TODO
+
+    for (auto & function : program->functions) {
+        function->functionBody = convert(function->functionBody);
+    }
     program->body = convert(program->body);
     return program;
 }
 
 ExpPtr
-CPSConverter::convertLiteral(ExpPtr expression) {
-    auto literal = std::static_pointer_cast<Literal>(expression);
-    return makeNewLet(literal->returnType, literal);
+CPSConverter::convertLet(const ExpPtr & expression) {
+    auto let = std::static_pointer_cast<Let>(expression);
+
+    std::vector<Binding> bindings;
+    let->value = convertOperands(let->value, bindings);
+    let->afterLet = convert(let->afterLet);
+    return bindAll(bindings, let);
 }
 
 ExpPtr
-CPSConverter::convertPrimitive(ExpPtr expression) {
-    auto primitive = std::static_pointer_cast<Primitive>(expression);
-
-    auto leftSide = convert(primitive->leftSide);
-    auto rightSide = convert(primitive->rightSide);
-
-    primitive->leftSide = makeReference(leftSide);
-    primitive->rightSide = makeReference(rightSide);
-    auto primLet = makeNewLet(primitive->returnType, primitive);
-
-    if (leftSide->expType == ExpressionTypes::LET) {
-        auto tempLet = getNestedLet(std::static_pointer_cast<Let>(leftSide));
+CPSConverter::convertBranch(const ExpPtr & expression) {
+    auto branch = std::static_pointer_cast<Branch>(expression);
+
+    std::vector<Binding> bindings;
+    branch->condition = makeAtom(branch->condition, bindings);
+    branch->ifBranch = convert(branch->ifBranch);
+    branch->elseBranch = convert(branch->elseBranch);
+    return bindAll(bindings, branch);
+}
 
-        if (rightSide->expType == ExpressionTypes::REF)
-            tempLet->afterLet = primLet;
-        else
-            tempLet->afterLet = rightSide;
-    }
+ExpPtr
+CPSConverter::convertMatch(const ExpPtr & expression) {
+    auto match = std::static_pointer_cast<Match>(expression);
 
-    if (rightSide->expType == ExpressionTypes::LET) {
-        auto tempLet = getNestedLet(std::static_pointer_cast<Let>(rightSide));
-        tempLet->afterLet = primLet;
+    // case values are only evaluated while the match gets to them, so they stay in place
+    for (auto & casePtr : match->cases) {
+        casePtr->body = convert(casePtr->body);
     }
+    return match;
+}
 
-    if (leftSide->expType == ExpressionTypes::LET)
-        return leftSide;
-    else if (rightSide->expType == ExpressionTypes::LET)
-        return rightSide;
-    else
-        return primLet;
+// Atomizes the operands of expression into bindings and returns it,
+// expressions that contain their own scopes are converted whole
+ExpPtr
+CPSConverter::convertOperands(const ExpPtr & expression, std::vector<Binding> & bindings) {
+    if (expression->expType == ExpressionTypes::PRIM)
+        return convertPrimitive(expression, bindings);
+    else if (expression->expType == ExpressionTypes::APP)
+        return convertApplication(expression, bindings);
+    else if (expression->expType == ExpressionTypes::LIST_DEF)
+        return convertListDefinition(expression, bindings);
+    else if (expression->expType == ExpressionTypes::TUPLE_DEF)
+        return convertTupleDefinition(expression, bindings);
+    else if (expression->expType == ExpressionTypes::PROG ||
+             expression->expType == ExpressionTypes::LET ||
+             expression->expType == ExpressionTypes::BRANCH ||
+             expression->expType == ExpressionTypes::MATCH)
+        return convert(expression);
+    else // literal, reference, typeclass, end
+        return expression;
 }
 
 ExpPtr
-CPSConverter::convertLet(ExpPtr expression) {
-    auto let = std::static_pointer_cast<Let>(expression);
+CPSConverter::convertPrimitive(const ExpPtr & expression, std::vector<Binding> & bindings) {
+    auto primitive = std::static_pointer_cast<Primitive>(expression);
+    primitive->leftSide = makeAtom(primitive->leftSide, bindings);
+    primitive->rightSide = makeAtom(primitive->rightSide, bindings);
+    return primitive;
+}
 
-    if (let->value->expType != ExpressionTypes::REF && 
-        let->value->expType != ExpressionTypes::LIT &&
-        let->value->expType != ExpressionTypes::LET) {
-        auto temp = convert(let->value);
-        
-        if (temp->expType == ExpressionTypes::LET) {
-            getNestedLet(std::static_pointer_cast<Let>(temp))->afterLet = let;
-        }
-        let->afterLet = convert(let->afterLet);
-        return temp;
+ExpPtr
+CPSConverter::convertApplication(const ExpPtr & expression, std::vector<Binding> & bindings) {
+    auto application = std::static_pointer_cast<Application>(expression);
+    application->ident = makeAtom(application->ident, bindings);
+
+    // the list a chain of builtins passes along stays where it is, to be fused
+    bool chains = Pipeline::chains(*application);
+    for (auto & argument : application->arguments) {
+        argument = (chains && &argument == &application->arguments.front()) ? convertApplication(argument, bindings)
+                                                                            : makeAtom(argument, bindings);
     }
-
-    let->afterLet = convert(let->afterLet);
-    return let;
+    return application;
 }
 
 ExpPtr
-CPSConverter::convertListDefinition(ExpPtr expression) {
+CPSConverter::convertListDefinition(const ExpPtr & expression, std::vector<Binding> & bindings) {
     auto listDefinition = std::static_pointer_cast<ListDefinition>(expression);
-
-    std::vector<std::shared_ptr<Let>> letValues;
     for (auto & value : listDefinition->values) {
-        if (value->expType != ExpressionTypes::REF) {
-            auto letValue = std::static_pointer_cast<Let>(convert(value));
-            value = makeReference(letValue);
-            letValues.push_back(letValue);
-        }
+        value = makeAtom(value, bindings);
     }
-
-    for (unsigned int letIndex = 0; letIndex < letValues.size() - 1; ++letIndex) {
-        getNestedLet(letValues.at(letIndex))->afterLet = letValues.at(letIndex + 1);
-    }
-
-    auto listLet = makeNewLet(listDefinition->returnType, listDefinition);
-
-    getNestedLet(letValues.back())->afterLet = listLet;
-    return letValues.front();
+    return listDefinition;
 }
 
 ExpPtr
-CPSConverter::convertTupleDefinition(ExpPtr expression) {
+CPSConverter::convertTupleDefinition(const ExpPtr & expression, std::vector<Binding> & bindings) {
     auto tupleDefinition = std::static_pointer_cast<TupleDefinition>(expression);
-
-    std::vector<std::shared_ptr<Let>> letValues;
     for (auto & value : tupleDefinition->values) {
-        if (value->expType != ExpressionTypes::REF) {
-            auto letValue = std::static_pointer_cast<Let>(convert(value));
-            value = makeReference(letValue);
-            letValues.push_back(letValue);
-        }
+        value = makeAtom(value, bindings);
     }
+    return tupleDefinition;
+}
 
-    for (unsigned int letIndex = 0; letIndex < letValues.size() - 1; ++letIndex) {
-        getNestedLet(letValues.at(letIndex))->afterLet = letValues.at(letIndex + 1);
+ExpPtr
+CPSConverter::makeAtom(const ExpPtr & expression, std::vector<Binding> & bindings) {
+    auto value = convertOperands(expression, bindings);
+    if (value->expType == ExpressionTypes::LIT || value->expType == ExpressionTypes::REF) {
+        return value;
     }
 
-    auto tupleLet = makeNewLet(tupleDefinition->returnType, tupleDefinition);
-
-    getNestedLet(letValues.back())->afterLet = tupleLet;
-    return letValues.front();
-}
-
-std::shared_ptr<Let>
-CPSConverter::makeNewLet(Types::TypePtr valueType, ExpPtr value) {
     auto ident = newLetIdent();
-    return std::make_shared<Let>(value->token, ident, valueType, value, std::make_shared<Reference>(value->token, valueType, ident));
-}
-
-std::shared_ptr<Reference>
-CPSConverter::makeReference(ExpPtr value) {
-    if (value->expType == ExpressionTypes::REF)
-        return std::static_pointer_cast<Reference>(value);
-    
-    auto let = getNestedLet(std::static_pointer_cast<Let>(value));
-    return std::make_shared<Reference>(let->token, let->returnType, let->ident);
+    bindings.emplace_back(ident, value);
+    return makeInArena<Reference>(arena, value->token, value->returnType, ident);
 }
 
-std::shared_ptr<Let>
-CPSConverter::getNestedLet(std::shared_ptr<Let> let) {
-    while (let->expType == ExpressionTypes::LET && let->afterLet->expType == ExpressionTypes::LET) {
-        let = std::static_pointer_cast<Let>(let->afterLet);
+// Nests the bindings around body in the order they were made
+ExpPtr
+CPSConverter::bindAll(const std::vector<Binding> & bindings, const ExpPtr & body) {
+    auto expression = body;
+    for (auto binding = bindings.rbegin(); binding != bindings.rend(); ++binding) {
+        expression = makeInArena<Let>(arena, binding->value->token, binding->ident, binding->value->returnType, binding->value, expression);
     }
-    return let;
+    return expression;
 }
 
 std::string
 CPSConverter::newLetIdent() {
-    static int letCount = 0;
     return std::string("l$") + std::to_string(letCount++);
-}
\ No newline at end of file
+}
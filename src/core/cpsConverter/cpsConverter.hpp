@@ -3,31 +3,54 @@
 #include "../../utils/logger.hpp"
 #include "../../utils/prettyprint.hpp"
 #include "../../defs/expressions.hpp"
+#include "../interpreter/pipeline.hpp"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 using namespace Expressions;
 
+// Converts the tree to A-normal form: every operand of a primitive,
+// application, list or tuple is a literal or a reference, and anything
+// that has to be computed first is bound to a fresh let ahead of its use.
+// Values returned from a body are left unbound so tail calls stay in place,
+// and so are the lists a chain of builtins passes along, so it can be fused.
 class CPSConverter {
     private:
+        class Binding {
+            public:
+                std::string ident;
+                ExpPtr value;
+
+                Binding(const std::string & ident, const ExpPtr & value)
+                : ident(ident),
+                  value(value) { }
+        };
+
         ExpPtr rootExpression;
-        
-        ExpPtr convert(ExpPtr expression);
+        ArenaPtr arena;
+        int letCount = 0;
+
+        ExpPtr convert(const ExpPtr & expression);
+
+        ExpPtr convertProgram(const ExpPtr & expression);
+        ExpPtr convertLet(const ExpPtr & expression);
+        ExpPtr convertBranch(const ExpPtr & expression);
+        ExpPtr convertMatch(const ExpPtr & expression);
 
-        ExpPtr convertProgram(ExpPtr expression);
-        ExpPtr convertLiteral(ExpPtr expression);
-        ExpPtr convertPrimitive(ExpPtr expression);
-        ExpPtr convertLet(ExpPtr expression);
-        ExpPtr convertListDefinition(ExpPtr expression);
-        ExpPtr convertTupleDefinition(ExpPtr expression);
+        ExpPtr convertOperands(const ExpPtr & expression, std::vector<Binding> & bindings);
+        ExpPtr convertPrimitive(const ExpPtr & expression, std::vector<Binding> & bindings);
+        ExpPtr convertApplication(const ExpPtr & expression, std::vector<Binding> & bindings);
+        ExpPtr convertListDefinition(const ExpPtr & expression, std::vector<Binding> & bindings);
+        ExpPtr convertTupleDefinition(const ExpPtr & expression, std::vector<Binding> & bindings);
 
-        std::shared_ptr<Let> makeNewLet(Types::TypePtr valueType, ExpPtr value);
-        std::shared_ptr<Reference> makeReference(ExpPtr value);
-        std::shared_ptr<Let> getNestedLet(std::shared_ptr<Let> let);
+        ExpPtr makeAtom(const ExpPtr & expression, std::vector<Binding> & bindings);
+        ExpPtr bindAll(const std::vector<Binding> & bindings, const ExpPtr & body);
 
         std::string newLetIdent();
 
     public:
-        explicit CPSConverter(const ExpPtr & rootExpression);
+        CPSConverter(const ExpPtr & rootExpression, const ArenaPtr & arena);
         void convert();
-};
\ No newline at end of file
+};
@@ -2,17 +2,26 @@
 
 Interpreter::Interpreter(const ExpPtr & rootExpression)
 : rootExpression(rootExpression),
-  errorNullValue(std::make_shared<Values::NullValue>(std::make_shared<Types::NullType>())) 
+  errorNullValue(Values::makeNull()) 
 { }
 
+std::unique_ptr<Evaluator>
+Interpreter::fork() const {
+    auto forkedInterpreter = std::make_unique<Interpreter>(rootExpression);
+    forkedInterpreter->callStack = callStack;
+    return forkedInterpreter;
+}
+
 void
 Interpreter::run() {
-    Values::Environment environment = std::make_shared<std::map<std::string, Values::ValuePtr>>();
+    Values::Environment environment = std::make_shared<Values::Frame>(static_cast<Program *>(rootExpression.get())->frameLayout,
+                                                                      nullptr);
     interpret(rootExpression, environment);
     environment->clear();
+    Collector::collect();
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpret(const ExpPtr & expression, Values::Environment & environment) {
     if (expression->expType == ExpressionTypes::PROG)
         return interpretProgram(expression, environment);
@@ -39,17 +48,16 @@ Interpreter::interpret(const ExpPtr & expression, Values::Environment & environm
     else if (expression->expType == ExpressionTypes::END)
         return errorNullValue;
 
-    printError(expression->token, std::string("Unknown expression type: ") + expression->token.text);
+    printError(expression->token, std::string("Unknown expression type: ") + std::string(expression->token.text));
 
     return errorNullValue;
 }
 
-Values::ValuePtr
-Interpreter::interpretProgram(const ExpPtr & expression, const Values::Environment & environment) {
-    auto program = std::static_pointer_cast<Program>(expression);
-
-    Values::Environment programEnvironment = environment;
+Values::Value
+Interpreter::interpretProgram(const ExpPtr & expression, Values::Environment & environment) {
+    auto program = static_cast<Program *>(expression.get());
 
+    bool madeClosure = false;
     for (auto & function : program->functions) {
         std::vector<std::string> parameterNames{};
         std::transform(function->parameters.begin(), function->parameters.end(), std::back_inserter(parameterNames),
@@ -58,144 +66,157 @@ Interpreter::interpretProgram(const ExpPtr & expression, const Values::Environme
         auto functionValue = std::make_shared<Values::FunctionValue>(function->returnType, 
                                                                     parameterNames, 
                                                                     function->functionBody, 
-                                                                    std::make_shared<std::map<std::string, Values::ValuePtr>>());
+                                                                    nullptr);
 
         if (BuiltinDefinitions::isBuiltin(function->name)) {
             functionValue->isBuiltin = true;
             functionValue->builtinEnum = BuiltinDefinitions::getBuiltin(function->name);
         } else {
-            functionValue->functionBodyEnvironment = std::make_shared<std::map<std::string, Values::ValuePtr>>(*programEnvironment);
-            functionValue->functionBodyEnvironment->erase(function->name);
+            functionValue->functionBodyEnvironment = environment;
+            madeClosure = true;
         }
+        if (function->memoized) {
+            functionValue->memoCache = std::make_shared<MemoCache>();
+        }
+        functionValue->frameLayout = function->frameLayout;
+        functionValue->name = function->name;
+
+        setSlot(environment, function->slot, functionValue);
+    }
 
-        addName(programEnvironment, function->name, functionValue);
+    if (madeClosure) {
+        Collector::track(environment);
     }
 
-    return interpret(program->body, programEnvironment);
+    return interpret(program->body, environment);
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretLiteral(const ExpPtr & expression, const Values::Environment & environment) {
-    auto literal = std::static_pointer_cast<Literal>(expression);
+    auto literal = static_cast<Literal *>(expression.get());
 
     if (literal->returnType->dataType == Types::DataTypes::INT) {
-        return std::make_shared<Values::IntValue>(literal->returnType, std::get<int>(literal->data));
+        return Values::makeInt(std::get<int>(literal->data));
     } else if (literal->returnType->dataType == Types::DataTypes::CHAR) {
-        return std::make_shared<Values::CharValue>(literal->returnType, std::get<char>(literal->data));
+        return Values::makeChar(std::get<char>(literal->data));
     } else if (literal->returnType->dataType == Types::DataTypes::STRING) {
+        if (literal->stringValue) {
+            return literal->stringValue;
+        }
         return std::make_shared<Values::StringValue>(literal->returnType, std::get<std::string>(literal->data));
     } else if (literal->returnType->dataType == Types::DataTypes::BOOL) {
-        return std::make_shared<Values::BoolValue>(literal->returnType, std::get<bool>(literal->data));
+        return Values::makeBool(std::get<bool>(literal->data));
     } else if (literal->returnType->dataType == Types::DataTypes::NULLVAL) {
-        return std::make_shared<Values::NullValue>(literal->returnType);
+        return Values::makeNull();
     }
 
     printError(literal->token, std::string("Error: Unknown literal type: ") + 
-               literal->token.position.currentLineText);
+               literal->token.position.currentLineText());
     return errorNullValue;
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretPrimitive(const ExpPtr & expression, Values::Environment & environment) {
-    auto primitive = std::static_pointer_cast<Primitive>(expression);
+    auto primitive = static_cast<Primitive *>(expression.get());
     auto leftValue = interpret(primitive->leftSide, environment);
     auto rightValue = interpret(primitive->rightSide, environment);
 
-    if (leftValue->type->dataType == Types::DataTypes::INT) {
-        return doOperation<Values::IntValue>(primitive->token, primitive->op, leftValue, rightValue);
-    } else if (leftValue->type->dataType == Types::DataTypes::CHAR) {
-        return doOperation<Values::CharValue>(primitive->token, primitive->op, leftValue, rightValue);
-    } else if (leftValue->type->dataType == Types::DataTypes::STRING) {
-        return doOperation<Values::StringValue>(primitive->token, primitive->op, leftValue, rightValue);
-    } else if (leftValue->type->dataType == Types::DataTypes::BOOL) {
-        return doOperation<Values::BoolValue>(primitive->token, primitive->op, leftValue, rightValue);
+    if (Operations::isDivisionByZero(primitive->op, rightValue)) {
+        error = true;
+
+        printError(primitive->token, "Error: Division by zero!");
+        return errorNullValue;
+    }
+
+    auto resultValue = Operations::doPrimitive(primitive->op, leftValue, rightValue);
+    if (resultValue) {
+        return resultValue;
     }
 
     printError(primitive->token, std::string("Error: Binary operator requires primitive types: ")  + 
-               primitive->token.position.currentLineText);
+               primitive->token.position.currentLineText());
     return errorNullValue;
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretLet(const ExpPtr & expression, Values::Environment & environment) {
-    auto let = std::static_pointer_cast<Let>(expression);
+    auto let = static_cast<Let *>(expression.get());
 
     auto letValue = interpret(let->value, environment);
-    Values::Environment afterLetEnvironment = environment;
-    addName(afterLetEnvironment, let->ident, letValue);
-    return interpret(let->afterLet, afterLetEnvironment);
+    setSlot(environment, let->slot, letValue);
+    return interpret(let->afterLet, environment);
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretReference(const ExpPtr & expression, Values::Environment & environment) {
-    auto reference = std::static_pointer_cast<Reference>(expression);
+    auto reference = static_cast<Reference *>(expression.get());
 
-    auto referenceValue = getName(reference->token, environment, reference->ident);
-    if (referenceValue->type->dataType == Types::DataTypes::TUPLE && !reference->fieldIdent.empty()) {
-        auto tupleValue = std::static_pointer_cast<Values::TupleValue>(referenceValue);
-        int tupleIndex = std::stoi(reference->fieldIdent);
+    auto referenceValue = getName(reference->token, environment, reference->address, reference->ident);
+    if (referenceValue.dataType() == Types::DataTypes::TUPLE && !reference->fieldIdent.empty()) {
+        auto tupleValue = referenceValue.as<Values::TupleValue>();
+        int tupleIndex = (reference->fieldIndex >= 0) ? reference->fieldIndex : std::stoi(reference->fieldIdent);
         return tupleValue->tupleData.at(tupleIndex);
-    } else if (referenceValue->type->dataType == Types::DataTypes::TYPECLASS && !reference->fieldIdent.empty()) {
-        auto typeclassValue = std::static_pointer_cast<Values::TypeclassValue>(referenceValue);
-        auto fieldValue = typeclassValue->fields->find(reference->fieldIdent);
-        if (fieldValue == environment->end()) {
+    } else if (referenceValue.dataType() == Types::DataTypes::TYPECLASS && !reference->fieldIdent.empty()) {
+        auto typeclassValue = referenceValue.as<Values::TypeclassValue>();
+        int fieldIndex = (reference->fieldIndex >= 0) ? reference->fieldIndex : typeclassValue->fieldIndex(reference->fieldIdent);
+        if (fieldIndex < 0 || fieldIndex >= static_cast<int>(typeclassValue->fields.size())) {
             printError(reference->token, std::string("Error: typeclass ") +
                        reference->ident + std::string(" has no field ") +
                        reference->fieldIdent);
             return errorNullValue;
         }
-        return fieldValue->second;
+        return typeclassValue->fields[fieldIndex];
     }
 
     return referenceValue;
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretBranch(const ExpPtr & expression, Values::Environment & environment) {
-    auto branch = std::static_pointer_cast<Branch>(expression);
+    auto branch = static_cast<Branch *>(expression.get());
 
-    auto conditionValue = std::static_pointer_cast<Values::BoolValue>(interpret(branch->condition, environment));
-    if (conditionValue->data) {
+    auto conditionValue = interpret(branch->condition, environment);
+    if (conditionValue.boolData()) {
         return interpret(branch->ifBranch, environment);
     } 
 
     return interpret(branch->elseBranch, environment);
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretTypeclass(const ExpPtr & expression, Values::Environment & environment) {
-    auto typeclass = std::static_pointer_cast<Typeclass>(expression);
+    auto typeclass = static_cast<Typeclass *>(expression.get());
 
-    Values::Environment fields = std::make_shared<std::map<std::string, Values::ValuePtr>>();
-    for (unsigned int fieldIndex = 0; fieldIndex < typeclass->fields.size(); ++fieldIndex) {
-        auto initValue = std::make_shared<Values::Value>(std::make_shared<Types::UnknownType>());
-        addName(fields, typeclass->fields.at(fieldIndex)->name, initValue);
-    }
+    Values::Value initValue = std::make_shared<Values::Object>(std::make_shared<Types::UnknownType>());
+    Values::Fields fields(typeclass->fields.size(), initValue);
 
-    auto typeclassValue = std::make_shared<Values::TypeclassValue>(typeclass->returnType, fields);
-    addName(environment, typeclass->ident, typeclassValue);
+    auto typeclassValue = std::make_shared<Values::TypeclassValue>(typeclass->returnType, std::move(fields));
+    setSlot(environment, typeclass->slot, typeclassValue);
 
     return typeclassValue;
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretApplication(const ExpPtr & expression, Values::Environment & environment) {
-    auto application = std::static_pointer_cast<Application>(expression);
+    auto application = static_cast<Application *>(expression.get());
+    if (application->pipeline) {
+        return interpretPipeline(*application, environment);
+    }
 
     auto ident = interpret(application->ident, environment);
-    if (ident->type->dataType == Types::DataTypes::TYPECLASS) {
-        auto typeclassValue = std::static_pointer_cast<Values::TypeclassValue>(ident);
+    if (ident.dataType() == Types::DataTypes::TYPECLASS) {
+        auto typeclassValue = ident.as<Values::TypeclassValue>();
         auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(typeclassValue->type);
-        auto typeclassFields = std::make_shared<std::map<std::string, Values::ValuePtr>>(*typeclassValue->fields);
+        Values::Fields typeclassFields(typeclassValue->fields);
         for (unsigned int argumentIndex = 0; argumentIndex < application->arguments.size(); ++argumentIndex) {
-            addName(typeclassFields, typeclassType->fieldTypes.at(argumentIndex).first, interpret(application->arguments.at(argumentIndex), environment));
+            typeclassFields.at(argumentIndex) = interpret(application->arguments.at(argumentIndex), environment);
         }
-        return std::make_shared<Values::TypeclassValue>(typeclassType, typeclassFields);
-    } else if (ident->type->dataType == Types::DataTypes::LIST) {
-        unsigned int index = std::static_pointer_cast<Values::IntValue>(interpret(application->arguments.at(0), environment))->data;
-        auto listValue = std::static_pointer_cast<Values::ListValue>(ident);
+        return std::make_shared<Values::TypeclassValue>(typeclassType, std::move(typeclassFields));
+    } else if (ident.dataType() == Types::DataTypes::LIST) {
+        unsigned int index = interpret(application->arguments.at(0), environment).intData();
+        auto listValue = ident.as<Values::ListValue>();
         if (index >= listValue->listData.size()) {
-            printError(application->token, "Error: Out of bounds list access: " + application->token.position.currentLineText);
+            printError(application->token, "Error: Out of bounds list access: " + application->token.position.currentLineText());
             return errorNullValue;
         }
         return listValue->listData.at(index);
@@ -205,75 +226,138 @@ Interpreter::interpretApplication(const ExpPtr & expression, Values::Environment
 
     if (application->ident->expType == ExpressionTypes::REF) {
         auto funcIdent = std::static_pointer_cast<Reference>(application->ident);
-        callStack.push_back(std::make_pair(funcIdent->ident, funcIdent->token));
+        callStack.push(std::make_pair(funcIdent->ident, funcIdent->token));
+    }
+
+    auto functionValue = ident.as<Values::FunctionValue>();
+    std::vector<Values::Value> arguments;
+    std::transform(application->arguments.begin(), application->arguments.end(), std::back_inserter(arguments),
+                    [this, &environment](const ExpPtr & argument) -> Values::Value { return interpret(argument, environment); });
+
+    // a memo func has to be back in applyFunction to store its result
+    if (application->isTailCall && !functionValue->isBuiltin && !functionValue->memoCache) {
+        pendingTailCall.functionValue = functionValue;
+        pendingTailCall.arguments = std::move(arguments);
+        return Values::Value();
     }
 
-    auto functionValue = std::static_pointer_cast<Values::FunctionValue>(ident);
-    Values::Environment functionEnvironment = std::make_shared<std::map<std::string, Values::ValuePtr>>(*environment);
-    for (unsigned int argumentIndex = 0; argumentIndex < application->arguments.size(); ++argumentIndex) {
-        addName(functionEnvironment, functionValue->parameterNames.at(argumentIndex), interpret(application->arguments.at(argumentIndex), environment));
+    return applyFunction(application->token, functionValue, arguments, environment);
+}
+
+Values::Value
+Interpreter::interpretPipeline(const Application & application, Values::Environment & environment) {
+    const auto & pipeline = *application.pipeline;
+
+    std::vector<Values::Value> arguments;
+    std::transform(pipeline.getArguments().begin(), pipeline.getArguments().end(), std::back_inserter(arguments),
+                    [this, &environment](const ExpPtr & argument) -> Values::Value { return interpret(argument, environment); });
+
+    callStack.push(std::make_pair(std::string(pipeline.name()), application.token));
+    if (profiler) {
+        profiler->enter(pipeline.name(), true);
+    }
+    auto resultValue = pipeline.run(application.token, arguments, environment, *this);
+    if (profiler) {
+        profiler->exit();
     }
+    return resultValue;
+}
 
-    for (auto & environmentVariable : *(functionValue->functionBodyEnvironment)) { // STILL REACHABLE LEAK
-        if (!BuiltinDefinitions::isBuiltin(environmentVariable.first)) {
-            addName(functionEnvironment, environmentVariable.first, environmentVariable.second);
+Values::Value
+Interpreter::applyFunction(const Token & token, const Values::FunctionValuePtr & functionValue, const std::vector<Values::Value> & arguments, Values::Environment & environment) {
+    if (functionValue->memoCache) {
+        auto cachedValue = functionValue->memoCache->find(arguments);
+        if (cachedValue) {
+            return cachedValue;
         }
     }
 
+    Values::Environment functionEnvironment = std::make_shared<Values::Frame>(functionValue->frameLayout,
+                                                                              functionValue->functionBodyEnvironment);
+    // parameters occupy the leading slots of the frame
+    std::copy(arguments.begin(), arguments.end(), functionEnvironment->slots.begin());
+
+    if (profiler) {
+        profiler->enter(functionValue->name, functionValue->isBuiltin);
+    }
+
     if (functionValue->isBuiltin) {
-        return BuiltinImplementations::runBuiltin(application->token, functionValue, functionEnvironment);
+        auto resultValue = BuiltinImplementations::runBuiltin(token, functionValue, functionEnvironment, *this);
+        if (profiler) {
+            profiler->exit();
+        }
+        return resultValue;
+    }
+
+    auto resultValue = interpret(functionValue->functionBody, functionEnvironment);
+
+    // each tail call replaces the frame of the body that made it
+    while (pendingTailCall.functionValue) {
+        auto tailFunctionValue = std::move(pendingTailCall.functionValue);
+        pendingTailCall.functionValue = nullptr;
+
+        functionEnvironment = std::make_shared<Values::Frame>(tailFunctionValue->frameLayout,
+                                                              tailFunctionValue->functionBodyEnvironment);
+        std::copy(pendingTailCall.arguments.begin(), pendingTailCall.arguments.end(), functionEnvironment->slots.begin());
+
+        if (profiler) {
+            profiler->replace(tailFunctionValue->name);
+        }
+        resultValue = interpret(tailFunctionValue->functionBody, functionEnvironment);
+    }
+
+    if (functionValue->memoCache && !error) {
+        functionValue->memoCache->store(arguments, resultValue);
     }
 
-    return interpret(functionValue->functionBody, functionEnvironment);
+    if (profiler) {
+        profiler->exit();
+    }
+    return resultValue;
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretListDefinition(const ExpPtr & expression, Values::Environment & environment) {
-    auto listDefinition = std::static_pointer_cast<ListDefinition>(expression);
+    auto listDefinition = static_cast<ListDefinition *>(expression.get());
 
-    std::vector<Values::ValuePtr> listData;
+    std::vector<Values::Value> listData;
     std::transform(listDefinition->values.begin(), listDefinition->values.end(), std::back_inserter(listData),
-                    [this, &environment](const ExpPtr & element) -> Values::ValuePtr { return interpret(element, environment); });
+                    [this, &environment](const ExpPtr & element) -> Values::Value { return interpret(element, environment); });
 
     return std::make_shared<Values::ListValue>(listDefinition->returnType, listData);
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretTupleDefinition(const ExpPtr & expression, Values::Environment & environment) {
-    auto tupleDefinition = std::static_pointer_cast<TupleDefinition>(expression);
+    auto tupleDefinition = static_cast<TupleDefinition *>(expression.get());
 
-    std::vector<Values::ValuePtr> tupleData;
+    std::vector<Values::Value> tupleData;
     std::transform(tupleDefinition->values.begin(), tupleDefinition->values.end(), std::back_inserter(tupleData),
-                    [this, &environment](const ExpPtr & element) -> Values::ValuePtr { return interpret(element, environment); });
+                    [this, &environment](const ExpPtr & element) -> Values::Value { return interpret(element, environment); });
 
     return std::make_shared<Values::TupleValue>(tupleDefinition->returnType, tupleData);
 }
 
-Values::ValuePtr
+Values::Value
 Interpreter::interpretMatch(const ExpPtr & expression, Values::Environment & environment) {
-    auto match = std::static_pointer_cast<Match>(expression);
-    auto matchValue = getName(match->token, environment, match->ident);
+    auto match = static_cast<Match *>(expression.get());
+    auto matchValue = getName(match->token, environment, match->address, match->ident);
+
+    if (match->table) {
+        auto arm = match->table->find(matchValue);
+        return (arm >= 0) ? interpret(match->cases[arm]->body, environment) : errorNullValue;
+    }
 
     for (auto & casePtr : match->cases) {
         if (casePtr->ident->expType == ExpressionTypes::REF &&
-            std::static_pointer_cast<Reference>(casePtr->ident)->ident == std::string("$any")) {
+            static_cast<Reference *>(casePtr->ident.get())->ident == std::string("$any")) {
             return interpret(casePtr->body, environment);
         }
 
         auto caseValue = interpret(casePtr->ident, environment);
         
-        Values::ValuePtr resultValue;
-        if (matchValue->type->dataType == Types::DataTypes::INT) {
-            resultValue = doOperation<Values::IntValue>(match->token, Operator::OperatorTypes::EQ, matchValue, caseValue);
-        } else if (matchValue->type->dataType == Types::DataTypes::CHAR) {
-            resultValue = doOperation<Values::CharValue>(match->token, Operator::OperatorTypes::EQ, matchValue, caseValue);
-        } else if (matchValue->type->dataType == Types::DataTypes::STRING) {
-            resultValue = doOperation<Values::StringValue>(match->token, Operator::OperatorTypes::EQ, matchValue, caseValue);
-        } else if (matchValue->type->dataType == Types::DataTypes::BOOL) {
-            resultValue = doOperation<Values::BoolValue>(match->token, Operator::OperatorTypes::EQ, matchValue, caseValue);
-        }
-
-        if (std::static_pointer_cast<Values::BoolValue>(resultValue)->data) {
+        auto resultValue = Operations::doPrimitive(Operator::OperatorTypes::EQ, matchValue, caseValue);
+        if (resultValue.boolData()) {
             return interpret(casePtr->body, environment);
         }
     }
@@ -282,101 +366,31 @@ Interpreter::interpretMatch(const ExpPtr & expression, Values::Environment & env
 }
 
 void
-Interpreter::addName(Values::Environment & environment, std::string name, Values::ValuePtr value) {
-    if (environment->count(name)) {
-		environment->erase(name); // STILL REACHABLE LEAK
-	}
-	environment->insert(std::pair<std::string, Values::ValuePtr>(name, value)); // STILL REACHABLE LEAK
+Interpreter::setSlot(Values::Environment & environment, const int slot, const Values::Value & value) {
+    environment->slots.at(slot) = value;
 }
 
-Values::ValuePtr
-Interpreter::getName(const Token & token, Values::Environment & environment, std::string name) {
-    auto value = environment->find(name);
-    if (value == environment->end()) {
+Values::Value
+Interpreter::getName(const Token & token, const Values::Environment & environment, const Address & address, const std::string & name) {
+    auto value = environment->lookup(address);
+    if (!value) {
         printError(token, std::string("Error: ") + name + 
                           std::string(" does not exist in this scope"));
         return errorNullValue;
     }
-    return value->second;
-}
-
-template<typename PrimitiveType>
-Values::ValuePtr
-Interpreter::doOperation(const Token & token, Operator::OperatorTypes op, const Values::ValuePtr & leftSide, const Values::ValuePtr & rightSide) {
-    if (op == Operator::OperatorTypes::PLUS) {
-        return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(),
-                                                  std::static_pointer_cast<Values::IntValue>(leftSide)->data +
-                                                  std::static_pointer_cast<Values::IntValue>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::MINUS) {
-        return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(),
-                                                  std::static_pointer_cast<Values::IntValue>(leftSide)->data -
-                                                  std::static_pointer_cast<Values::IntValue>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::TIMES) {
-        return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(),
-                                                  std::static_pointer_cast<Values::IntValue>(leftSide)->data *
-                                                  std::static_pointer_cast<Values::IntValue>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::DIV) {
-        if (std::static_pointer_cast<Values::IntValue>(rightSide)->data == 0) {
-            error = true;
-
-            printError(token, "Error: Division by zero!");
-            return errorNullValue;
-        } else {
-            return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(),
-                                                  std::static_pointer_cast<Values::IntValue>(leftSide)->data /
-                                                  std::static_pointer_cast<Values::IntValue>(rightSide)->data);
-        }
-    } else if (op == Operator::OperatorTypes::MOD) {
-        return std::make_shared<Values::IntValue>(std::make_shared<Types::IntType>(),
-                                                  std::static_pointer_cast<Values::IntValue>(leftSide)->data %
-                                                  std::static_pointer_cast<Values::IntValue>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::GRT) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data >
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::LST) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data <
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::NOT) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data ==
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::EQ) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data ==
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::NOTEQ) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data !=
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::GRTEQ) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data >=
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::LSTEQ) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<PrimitiveType>(leftSide)->data <=
-                                                   std::static_pointer_cast<PrimitiveType>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::AND) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<Values::BoolValue>(leftSide)->data &&
-                                                   std::static_pointer_cast<Values::BoolValue>(rightSide)->data);
-    } else if (op == Operator::OperatorTypes::OR) {
-        return std::make_shared<Values::BoolValue>(std::make_shared<Types::BoolType>(),
-                                                   std::static_pointer_cast<Values::BoolValue>(leftSide)->data ||
-                                                   std::static_pointer_cast<Values::BoolValue>(rightSide)->data);
-    }
-
-    return errorNullValue;
+    return value;
 }
 
 const std::string
 Interpreter::getStackTraceString() {
     std::stringstream stackStream;
     stackStream << "Fatal error occurred:\n";
-    for (auto rIterator = callStack.rbegin(); rIterator != callStack.rend(); ++rIterator) {
-        stackStream << "\tat \'" << rIterator->first << "\' (Line: " << rIterator->second.position.fileLine << ")\n";
+    for (unsigned int callIndex = 0; callIndex < callStack.size(); ++callIndex) {
+        const auto & call = callStack.recent(callIndex);
+        stackStream << "\tat \'" << call.first << "\' (Line: " << call.second.position.fileLine << ")\n";
+    }
+    if (callStack.dropped() > 0) {
+        stackStream << "\t... " << callStack.dropped() << " earlier calls\n";
     }
     return stackStream.str();
 }
@@ -386,10 +400,10 @@ Interpreter::printError(const Token & token, const std::string & errorMessage) {
     error = true;
 
     std::stringstream errorStream;
-    errorStream << "Line: " << token.position.fileLine - BuiltinDefinitions::builtinNumber()
+    errorStream << "Line: " << token.position.fileLine
                 << ", Column: " << token.position.fileColumn << std::endl
                 << errorMessage << std::endl 
-                << token.position.currentLineText << std::endl;
+                << token.position.currentLineText() << std::endl;
     ERROR(errorStream.str());
     ERROR(getStackTraceString());
 
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "../../utils/operator.hpp"
+#include "../../utils/ringBuffer.hpp"
 
 #include "../../defs/token.hpp"
 #include "../../defs/values.hpp"
+#include "operations.hpp"
+#include "matchTable.hpp"
+#include "pipeline.hpp"
 #include "../builtin/builtinDefinitions.hpp"
 #include "../builtin/builtinImplementations.hpp"
+#include "../runtime/collector.hpp"
+#include "../runtime/evaluator.hpp"
+#include "../runtime/memoCache.hpp"
+#include "../runtime/profiler.hpp"
 
 #include "../typeChecker/typeChecker.hpp"
 
@@ -14,13 +22,6 @@
 #include <memory>
 #include <exception>
 
-class RuntimeException : public std::exception {
-    public:
-        const char * what() const noexcept override {
-            return "RuntimeException";
-        }
-};
-
 class HaltException : public std::exception {
     public:
         const char * what() const noexcept override {
@@ -28,31 +29,42 @@ class HaltException : public std::exception {
         }
 };
 
-class Interpreter {
+// Most recent calls, printed with runtime errors
+using CallStack = RingBuffer<std::pair<std::string, Token>, 64>;
+
+class Interpreter final : public Evaluator {
     private:
+        // A call in tail position is handed back to the applyFunction running
+        // the enclosing body, which reuses its place instead of nesting
+        class TailCall {
+            public:
+                Values::FunctionValuePtr functionValue;
+                std::vector<Values::Value> arguments;
+        };
+
         ExpPtr rootExpression;
         bool error = false;
 
-        std::shared_ptr<Values::NullValue> errorNullValue;
-
-        std::vector<std::pair<std::string, Token>> callStack;
+        Values::Value errorNullValue;
 
-        Values::ValuePtr interpretProgram(const ExpPtr & expression, const Values::Environment & environment);
-        Values::ValuePtr interpretLiteral(const ExpPtr & expression, const Values::Environment & environment);
-        Values::ValuePtr interpretPrimitive(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretLet(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretReference(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretBranch(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretTypeclass(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretApplication(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretListDefinition(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretTupleDefinition(const ExpPtr & expression, Values::Environment & environment);
-        Values::ValuePtr interpretMatch(const ExpPtr & expression, Values::Environment & environment);
+        CallStack callStack;
+        TailCall pendingTailCall;
+        Profiler * profiler = nullptr; // only set on the evaluator a run starts with
 
-        template<typename PrimitiveType>
-        Values::ValuePtr doOperation(const Token & token, Operator::OperatorTypes op, const Values::ValuePtr & leftSide, const Values::ValuePtr & rightSide);
+        Values::Value interpretProgram(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretLiteral(const ExpPtr & expression, const Values::Environment & environment);
+        Values::Value interpretPrimitive(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretLet(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretReference(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretBranch(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretTypeclass(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretApplication(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretListDefinition(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretTupleDefinition(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretMatch(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value interpretPipeline(const Application & application, Values::Environment & environment);
 
-        Values::ValuePtr getName(const Token & token, Values::Environment & environment, std::string name);
+        Values::Value getName(const Token & token, const Values::Environment & environment, const Address & address, const std::string & name);
 
         const std::string getStackTraceString();
         void printError(const Token & token, const std::string & errorMessage);
@@ -60,9 +72,13 @@ class Interpreter {
     public:
         explicit Interpreter(const ExpPtr & rootExpression);
 
+        std::unique_ptr<Evaluator> fork() const override;
+
         void run();
-        Values::ValuePtr interpret(const ExpPtr & expression, Values::Environment & environment);
-        
-        void addName(Values::Environment & environment, std::string name, Values::ValuePtr value);
+        Values::Value interpret(const ExpPtr & expression, Values::Environment & environment);
+        Values::Value applyFunction(const Token & token, const Values::FunctionValuePtr & functionValue, const std::vector<Values::Value> & arguments, Values::Environment & environment) override;
+
+        void setSlot(Values::Environment & environment, const int slot, const Values::Value & value);
+        void setProfiler(Profiler * profiler) { this->profiler = profiler; }
         bool errorOccurred() { return error; }
 };
\ No newline at end of file
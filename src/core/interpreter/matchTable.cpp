@@ -0,0 +1,170 @@
+#include "matchTable.hpp"
+
+#include <algorithm>
+
+namespace {
+    // keys spread over at most this many times their count are laid out densely
+    constexpr long long DENSE_SPREAD = 4;
+    constexpr long long MAX_DENSE_SIZE = 4096;
+
+    constexpr std::uint64_t MAX_SEED = 1000;
+
+    bool
+    isAnyCase(const std::shared_ptr<Expressions::Case> & casePtr) {
+        return casePtr->ident->expType == Expressions::ExpressionTypes::REF &&
+               static_cast<Expressions::Reference *>(casePtr->ident.get())->ident == std::string("$any");
+    }
+}
+
+MatchTable::MatchTable(const std::vector<Entry> & entries, const int defaultArm, const int armCount)
+: defaultArm(defaultArm),
+  armCount(armCount) {
+    // an earlier case with the same literal is the one that matches
+    for (const auto & entry : entries) {
+        auto existing = std::find_if(this->entries.begin(), this->entries.end(), [&entry](const Entry & other) {
+            return other.keyType == entry.keyType && other.intKey == entry.intKey && other.stringKey == entry.stringKey;
+        });
+        if (existing == this->entries.end()) {
+            this->entries.push_back(entry);
+        }
+    }
+    layOut();
+}
+
+std::shared_ptr<const MatchTable>
+MatchTable::build(const Expressions::Match & match) {
+    std::vector<Entry> entries;
+    int defaultArm = -1;
+
+    for (const auto & casePtr : match.cases) {
+        int arm = static_cast<int>(entries.size());
+        if (isAnyCase(casePtr)) {
+            defaultArm = arm;
+            break;
+        } else if (casePtr->ident->expType != Expressions::ExpressionTypes::LIT) {
+            return nullptr;
+        }
+
+        auto literal = static_cast<Expressions::Literal *>(casePtr->ident.get());
+        Entry entry;
+        entry.keyType = literal->returnType->dataType;
+        entry.arm = arm;
+        if (entry.keyType == Types::DataTypes::INT) {
+            entry.intKey = std::get<int>(literal->data);
+        } else if (entry.keyType == Types::DataTypes::CHAR) {
+            entry.intKey = std::get<char>(literal->data);
+        } else if (entry.keyType == Types::DataTypes::BOOL) {
+            entry.intKey = std::get<bool>(literal->data);
+        } else if (entry.keyType == Types::DataTypes::STRING) {
+            entry.stringKey = std::get<std::string>(literal->data);
+        } else {
+            return nullptr;
+        }
+
+        if (!entries.empty() && entries.front().keyType != entry.keyType) {
+            return nullptr;
+        }
+        entries.push_back(entry);
+    }
+
+    int armCount = (defaultArm >= 0) ? defaultArm + 1 : static_cast<int>(entries.size());
+    return std::make_shared<MatchTable>(entries, defaultArm, armCount);
+}
+
+void
+MatchTable::layOut() {
+    if (entries.empty()) {
+        return;
+    }
+    keyType = entries.front().keyType;
+
+    if (keyType == Types::DataTypes::STRING) {
+        layout = Layout::HASHED;
+        std::size_t slotCount = 4;
+        while (slotCount < entries.size() * 4) {
+            slotCount *= 2;
+        }
+
+        // a seed under which no two keys share a slot, with more slots when none is found
+        while (true) {
+            for (seed = 0; seed < MAX_SEED; ++seed) {
+                slots.assign(slotCount, -1);
+                bool collided = false;
+                for (unsigned int index = 0; index < entries.size() && !collided; ++index) {
+                    auto & slot = slots[slotOf(entries[index].stringKey)];
+                    collided = (slot >= 0);
+                    slot = static_cast<int>(index);
+                }
+                if (!collided) {
+                    return;
+                }
+            }
+            slotCount *= 2;
+        }
+    }
+
+    auto bounds = std::minmax_element(entries.begin(), entries.end(), [](const Entry & entry1, const Entry & entry2) {
+        return entry1.intKey < entry2.intKey;
+    });
+    long long span = static_cast<long long>(bounds.second->intKey) - bounds.first->intKey + 1;
+
+    if (span <= std::min(static_cast<long long>(entries.size()) * DENSE_SPREAD, MAX_DENSE_SIZE)) {
+        layout = Layout::DENSE;
+        lowKey = bounds.first->intKey;
+        denseArms.assign(static_cast<std::size_t>(span), -1);
+        for (const auto & entry : entries) {
+            denseArms[entry.intKey - lowKey] = entry.arm;
+        }
+        return;
+    }
+
+    layout = Layout::SORTED;
+    for (const auto & entry : entries) {
+        sortedArms.emplace_back(entry.intKey, entry.arm);
+    }
+    std::sort(sortedArms.begin(), sortedArms.end());
+}
+
+std::size_t
+MatchTable::slotOf(const std::string_view & key) const {
+    std::uint64_t hash = 14695981039346656037ull ^ seed;
+    for (auto character : key) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash ^ (hash >> 32)) & (slots.size() - 1);
+}
+
+int
+MatchTable::find(const Values::Value & value) const {
+    if (value.dataType() != keyType) {
+        return defaultArm;
+    }
+
+    int arm = -1;
+    if (layout == Layout::HASHED) {
+        auto key = value.as<Values::StringValue>()->view();
+        auto index = slots[slotOf(key)];
+        if (index >= 0 && entries[index].stringKey == key) {
+            arm = entries[index].arm;
+        }
+    } else {
+        int key = (keyType == Types::DataTypes::INT) ? value.intData()
+                : (keyType == Types::DataTypes::CHAR) ? value.charData()
+                : value.boolData();
+
+        if (layout == Layout::DENSE) {
+            long long index = static_cast<long long>(key) - lowKey;
+            if (index >= 0 && index < static_cast<long long>(denseArms.size())) {
+                arm = denseArms[index];
+            }
+        } else {
+            auto sortedArm = std::lower_bound(sortedArms.begin(), sortedArms.end(), std::make_pair(key, -1));
+            if (sortedArm != sortedArms.end() && sortedArm->first == key) {
+                arm = sortedArm->second;
+            }
+        }
+    }
+
+    return (arm >= 0) ? arm : defaultArm;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../../defs/expressions.hpp"
+#include "../../defs/types.hpp"
+#include "../../defs/values.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A match whose cases are all literals, up to its any case, lowered to a
+// lookup from the matched value straight to the arm it selects. Int, char
+// and bool keys in a small range index an array, sparse ones are binary
+// searched, and strings go through a perfect hash. The tree walker and the
+// VM both dispatch through it, instead of comparing against each case in
+// turn.
+class MatchTable {
+    public:
+        // the literal of one case, arm is the case's index
+        class Entry {
+            public:
+                Types::DataTypes keyType;
+                int intKey = 0; // int, char and bool keys
+                std::string stringKey;
+                int arm;
+        };
+
+    private:
+        enum class Layout {
+            DENSE, SORTED, HASHED
+        };
+
+        std::vector<Entry> entries; // first entry for each key, in case order
+        int defaultArm;
+        int armCount;
+
+        Types::DataTypes keyType = Types::DataTypes::UNKNOWN;
+        Layout layout = Layout::SORTED;
+
+        int lowKey = 0;
+        std::vector<int> denseArms; // arm of lowKey + index, -1 if none
+        std::vector<std::pair<int, int>> sortedArms; // (key, arm) by key
+        std::uint64_t seed = 0;
+        std::vector<int> slots; // entry whose string hashes there, -1 if none
+
+        std::size_t slotOf(const std::string_view & key) const;
+        void layOut();
+
+    public:
+        // defaultArm is the any case, -1 if there is none. armCount counts
+        // the cases up to and including it.
+        MatchTable(const std::vector<Entry> & entries, const int defaultArm, const int armCount);
+
+        // nullptr if a case before any is not a literal; such a match has
+        // to evaluate its cases in order
+        static std::shared_ptr<const MatchTable> build(const Expressions::Match & match);
+
+        // arm the matched value selects, -1 if no case matches it
+        int find(const Values::Value & value) const;
+
+        const std::vector<Entry> & getEntries() const { return entries; }
+        int getDefaultArm() const { return defaultArm; }
+        int getArmCount() const { return armCount; }
+};
+
+using MatchTablePtr = std::shared_ptr<const MatchTable>;
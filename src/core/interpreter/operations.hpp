@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../../utils/operator.hpp"
+#include "../../defs/values.hpp"
+
+#include <memory>
+
+// Binary operators on primitive values, shared by the tree walker and the VM
+namespace Operations {
+    inline bool
+    isDivisionByZero(const Operator::OperatorTypes op, const Values::Value & rightSide) {
+        return (op == Operator::OperatorTypes::DIV && rightSide.intData() == 0);
+    }
+
+    template<typename DataType>
+    Values::Value
+    compare(const Operator::OperatorTypes op, const DataType & leftData, const DataType & rightData) {
+        if (op == Operator::OperatorTypes::GRT) {
+            return Values::makeBool(leftData > rightData);
+        } else if (op == Operator::OperatorTypes::LST) {
+            return Values::makeBool(leftData < rightData);
+        } else if (op == Operator::OperatorTypes::NOT || op == Operator::OperatorTypes::EQ) {
+            return Values::makeBool(leftData == rightData);
+        } else if (op == Operator::OperatorTypes::NOTEQ) {
+            return Values::makeBool(leftData != rightData);
+        } else if (op == Operator::OperatorTypes::GRTEQ) {
+            return Values::makeBool(leftData >= rightData);
+        } else if (op == Operator::OperatorTypes::LSTEQ) {
+            return Values::makeBool(leftData <= rightData);
+        }
+        return Values::Value();
+    }
+
+    // Dispatches on the type of the left operand, empty if it is not a primitive
+    inline Values::Value
+    doPrimitive(const Operator::OperatorTypes op, const Values::Value & leftSide, const Values::Value & rightSide) {
+        auto dataType = leftSide.dataType();
+        if (dataType != Types::DataTypes::INT && dataType != Types::DataTypes::CHAR &&
+            dataType != Types::DataTypes::STRING && dataType != Types::DataTypes::BOOL) {
+            return Values::Value();
+        }
+
+        if (op == Operator::OperatorTypes::PLUS) {
+            return Values::makeInt(leftSide.intData() + rightSide.intData());
+        } else if (op == Operator::OperatorTypes::MINUS) {
+            return Values::makeInt(leftSide.intData() - rightSide.intData());
+        } else if (op == Operator::OperatorTypes::TIMES) {
+            return Values::makeInt(leftSide.intData() * rightSide.intData());
+        } else if (op == Operator::OperatorTypes::DIV) {
+            return Values::makeInt(leftSide.intData() / rightSide.intData());
+        } else if (op == Operator::OperatorTypes::MOD) {
+            return Values::makeInt(leftSide.intData() % rightSide.intData());
+        } else if (op == Operator::OperatorTypes::AND) {
+            return Values::makeBool(leftSide.boolData() && rightSide.boolData());
+        } else if (op == Operator::OperatorTypes::OR) {
+            return Values::makeBool(leftSide.boolData() || rightSide.boolData());
+        }
+
+        if (dataType == Types::DataTypes::INT) {
+            return compare(op, leftSide.intData(), rightSide.intData());
+        } else if (dataType == Types::DataTypes::CHAR) {
+            return compare(op, leftSide.charData(), rightSide.charData());
+        } else if (dataType == Types::DataTypes::STRING) {
+            return compare(op, leftSide.as<Values::StringValue>()->view(), rightSide.as<Values::StringValue>()->view());
+        }
+        return compare(op, leftSide.boolData(), rightSide.boolData());
+    }
+}
@@ -0,0 +1,209 @@
+#include "pipeline.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    using Step = Pipeline::Step;
+
+    bool
+    isStage(const Step step) {
+        return step == Step::MAP || step == Step::FILTER;
+    }
+
+    bool
+    isSink(const Step step) {
+        return isStage(step) || step == Step::FOLDL || step == Step::FOREACH || step == Step::SUM;
+    }
+
+    // has no effect, and holds no function that can have one, so it can be
+    // evaluated before the steps inside it run and its functions called
+    // element by element rather than step after step
+    bool
+    isPure(const Expressions::ExpPtr & expression) {
+        auto value = expression;
+        if (value->expType == Expressions::ExpressionTypes::PROG) {
+            value = static_cast<Expressions::Program *>(value.get())->body;
+        } else if (value->expType == Expressions::ExpressionTypes::LIT) {
+            return true;
+        }
+
+        if (value->expType != Expressions::ExpressionTypes::REF) {
+            return false;
+        }
+        // names made after type checking are not marked, and only ever hold
+        // values the checked names they stand in for did
+        auto reference = static_cast<Expressions::Reference *>(value.get());
+        return reference->pure || !Types::holdsFunctions(reference->returnType);
+    }
+
+    // the applications of the chain application is the outside of, with
+    // the builtin stepOf finds each applies, innermost first; empty if
+    // application is not the outside of a chain
+    template<typename StepOf>
+    std::vector<std::pair<const Expressions::Application *, Step>>
+    collectLinks(const Expressions::Application & application, const StepOf & stepOf) {
+        std::vector<std::pair<const Expressions::Application *, Step>> links;
+
+        auto link = &application;
+        auto step = stepOf(application);
+        if (!isSink(step)) {
+            return links;
+        }
+
+        while (static_cast<int>(link->arguments.size()) == BuiltinDefinitions::getDefinition(step).arity) {
+            // unfused, the steps inside run before the other arguments here
+            // are evaluated, and each step calls its function on every element
+            // before the next step starts, so none of them may have an effect
+            if (!std::all_of(link->arguments.begin() + 1, link->arguments.end(), isPure)) {
+                break;
+            }
+
+            links.emplace_back(link, step);
+            if (step == Step::GENERATE || link->arguments.front()->expType != Expressions::ExpressionTypes::APP) {
+                break;
+            }
+
+            auto inner = static_cast<const Expressions::Application *>(link->arguments.front().get());
+            auto innerStep = stepOf(*inner);
+            if (!isStage(innerStep) && innerStep != Step::GENERATE) {
+                break;
+            }
+            link = inner;
+            step = innerStep;
+        }
+
+        if (links.size() < 2) {
+            links.clear();
+        }
+        std::reverse(links.begin(), links.end());
+        return links;
+    }
+
+    const Expressions::Reference *
+    identReference(const Expressions::Application & application) {
+        if (application.ident->expType != Expressions::ExpressionTypes::REF) {
+            return nullptr;
+        }
+        auto reference = static_cast<const Expressions::Reference *>(application.ident.get());
+        return (reference->fieldIdent.empty()) ? reference : nullptr;
+    }
+}
+
+Pipeline::Pipeline(const std::vector<Step> & steps, const std::vector<Expressions::ExpPtr> & arguments)
+: steps(steps),
+  arguments(arguments) { }
+
+bool
+Pipeline::chains(const Expressions::Application & application) {
+    return !collectLinks(application, [](const Expressions::Application & link) {
+        auto reference = identReference(link);
+        return (reference) ? BuiltinDefinitions::getBuiltin(reference->ident) : Step::BUILTINNUM;
+    }).empty();
+}
+
+std::shared_ptr<const Pipeline>
+Pipeline::build(const Expressions::Application & application, const BuiltinOf & builtinOf) {
+    auto links = collectLinks(application, [&builtinOf](const Expressions::Application & link) {
+        auto reference = identReference(link);
+        return (reference) ? builtinOf(*reference) : Step::BUILTINNUM;
+    });
+    if (links.empty()) {
+        return nullptr;
+    }
+
+    std::vector<Step> steps;
+    std::vector<Expressions::ExpPtr> arguments;
+    for (const auto & link : links) {
+        // past the innermost, the first argument is the list the step inside makes
+        auto first = link.first->arguments.begin() + ((steps.empty()) ? 0 : 1);
+        arguments.insert(arguments.end(), first, link.first->arguments.end());
+        steps.push_back(link.second);
+    }
+    return std::make_shared<Pipeline>(steps, arguments);
+}
+
+Values::Value
+Pipeline::run(const Token & token, const std::vector<Values::Value> & arguments, Values::Environment & environment, Evaluator & evaluator) const {
+    class Stage {
+        public:
+            Step step;
+            Values::FunctionValuePtr function;
+    };
+
+    bool generated = (steps.front() == Step::GENERATE);
+    unsigned int argumentIndex = (generated) ? 3 : 1;
+
+    std::vector<Stage> stages;
+    for (auto step : steps) {
+        if (isStage(step)) {
+            stages.push_back({step, arguments.at(argumentIndex++).as<Values::FunctionValue>()});
+        }
+    }
+
+    auto sink = steps.back();
+    Values::Value foldValue;
+    Values::FunctionValuePtr sinkFunction;
+    if (sink == Step::FOLDL) {
+        foldValue = arguments.at(argumentIndex);
+        sinkFunction = arguments.at(argumentIndex + 1).as<Values::FunctionValue>();
+    } else if (sink == Step::FOREACH) {
+        sinkFunction = arguments.at(argumentIndex).as<Values::FunctionValue>();
+    }
+
+    std::vector<Values::Value> listData;
+    unsigned int sum = 0; // wraps as the sum builtin does
+    auto take = [&](Values::Value value) {
+        for (const auto & stage : stages) {
+            auto result = evaluator.applyFunction(token, stage.function, {value}, environment);
+            if (stage.step == Step::MAP) {
+                value = result;
+            } else if (!result.boolData()) {
+                return;
+            }
+        }
+
+        if (sink == Step::FOLDL) {
+            foldValue = evaluator.applyFunction(token, sinkFunction, {foldValue, value}, environment);
+        } else if (sink == Step::FOREACH) {
+            evaluator.applyFunction(token, sinkFunction, {value}, environment);
+        } else if (sink == Step::SUM) {
+            sum += static_cast<unsigned int>(value.intData());
+        } else {
+            listData.push_back(value);
+        }
+    };
+
+    // each list made is typed as the list it came from, as map and filter do
+    Types::TypePtr listType;
+    if (generated) {
+        int lowerBound = arguments.at(0).intData();
+        int upperBound = arguments.at(1).intData();
+        auto generator = arguments.at(2).as<Values::FunctionValue>();
+        for (int i = lowerBound; i <= upperBound; ++i) {
+            take(evaluator.applyFunction(token, generator, {Values::makeInt(i)}, environment));
+        }
+        listType = Types::listOf(Types::intType());
+    } else {
+        auto listValue = arguments.at(0).as<Values::ListValue>();
+        auto sourceData = listValue->listData;
+        for (const auto & value : sourceData) {
+            take(value);
+        }
+        listType = Types::intern(listValue->type);
+    }
+
+    if (sink == Step::FOLDL) {
+        return foldValue;
+    } else if (sink == Step::FOREACH) {
+        return Values::makeNull();
+    } else if (sink == Step::SUM) {
+        return Values::makeInt(static_cast<int>(sum));
+    }
+    return std::make_shared<Values::ListValue>(listType, listData);
+}
+
+std::string_view
+Pipeline::name() const {
+    return BuiltinDefinitions::getDefinition(steps.back()).name;
+}
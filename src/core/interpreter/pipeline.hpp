@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../defs/expressions.hpp"
+#include "../../defs/token.hpp"
+#include "../../defs/values.hpp"
+#include "../builtin/builtinDefinitions.hpp"
+#include "../runtime/evaluator.hpp"
+
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// A chain of list builtins, each applied to the list the one inside it
+// makes, as in foldl(filter(map(generate(0, n, f), g), p), 0, h), run as
+// one loop that takes each element through every step before the next
+// element starts. No list is made between the steps: only a map or filter
+// on the outside of the chain makes one, to hold what comes out of it.
+//
+// The chain starts with generate or with a map or filter of a list, goes
+// through maps and filters, and ends with a map, filter, foldl, foreach or
+// sum. Its functions are called element by element rather than step after
+// step, so their calls interleave: a chain is only fused when the type
+// checker has marked every one of its functions pure, and so the order of
+// their calls cannot be seen.
+class Pipeline {
+    public:
+        using Step = BuiltinDefinitions::BuiltinEnums;
+        // the builtin the ident of an application names, BUILTINNUM if none
+        using BuiltinOf = std::function<Step(const Expressions::Reference &)>;
+
+    private:
+        std::vector<Step> steps; // innermost first
+        std::vector<Expressions::ExpPtr> arguments;
+
+    public:
+        Pipeline(const std::vector<Step> & steps, const std::vector<Expressions::ExpPtr> & arguments);
+
+        // whether the names of the builtins make application the outside of
+        // a chain; the inside of one is left nested when it is converted to
+        // A-normal form, so that it can still be fused once names are resolved
+        static bool chains(const Expressions::Application & application);
+
+        // nullptr unless application is the outside of a chain whose idents
+        // all name the builtins
+        static std::shared_ptr<const Pipeline> build(const Expressions::Application & application, const BuiltinOf & builtinOf);
+
+        // arguments are the values of getArguments(), in that order
+        Values::Value run(const Token & token, const std::vector<Values::Value> & arguments, Values::Environment & environment, Evaluator & evaluator) const;
+
+        const std::vector<Step> & getSteps() const { return steps; }
+        // the arguments of the chain's builtins besides the lists passed
+        // between them, in the order the unfused calls evaluate them; empty
+        // for a pipeline read back from a cached chunk
+        const std::vector<Expressions::ExpPtr> & getArguments() const { return arguments; }
+        // of the builtin on the outside, which the chain is reported as
+        std::string_view name() const;
+};
+
+using PipelinePtr = std::shared_ptr<const Pipeline>;
@@ -1,33 +1,90 @@
 #include "lexer.hpp"
 
-const std::string
-Lexer::CHAR_DELIMS{"[](){}=->:;,*/+<!'\".&|%"};
-
-const std::set<std::string>
-Lexer::KEYWORDS{
-	"if", "else",
-	"func",
-    "typeclass", "type",
-	"val", "List", "Tuple",
-	"true", "false", 
-    "int", "bool", "char", "null", "string",
-	"case", "match", "any",
-    "import", ".."
-};
-
-const std::set<std::string> 
-Lexer::DELIMITERS{
-	"[", "]", "(", ")", "{", "}",
-	"=", "->", ":", ";", ",", "'", "\"", ".",
-	"+", "-", "/", "*", "%",
-	"<", ">", "!", "&&", "||",
-	"==", "!=", "<=", ">="
-};
-
-const std::regex
-Lexer::IDENT_REGEX("^[a-zA-z_][a-zA-Z0-9_]*$");
-
-bool Lexer::inQuotes = false;
+#include <algorithm>
+#include <array>
+
+namespace {
+    enum CharacterClass : unsigned char {
+        VALID = 1 << 0,      // allowed outside of quotes
+        DELIMITER = 1 << 1,  // ends the token before it
+        QUOTE = 1 << 2,
+        DIGIT = 1 << 3,
+        IDENT_START = 1 << 4,
+        IDENT_PART = 1 << 5
+    };
+
+    constexpr std::string_view CHAR_DELIMS{"[](){}=->:;,*/+<!'\".&|%"};
+
+    constexpr std::array<unsigned char, 256>
+    makeCharacterClasses() {
+        std::array<unsigned char, 256> classes{};
+        for (int character = '0'; character <= '9'; ++character)
+            classes[character] |= VALID | DIGIT | IDENT_PART;
+        for (int character = 'a'; character <= 'z'; ++character)
+            classes[character] |= VALID | IDENT_PART;
+        for (int character = 'A'; character <= 'Z'; ++character)
+            classes[character] |= VALID | IDENT_PART;
+        // identifiers start in the range A-z, which takes in [\]^_`
+        for (int character = 'A'; character <= 'z'; ++character)
+            classes[character] |= IDENT_START;
+        for (const char character : CHAR_DELIMS)
+            classes[static_cast<unsigned char>(character)] |= VALID | DELIMITER;
+        classes['_'] |= VALID | IDENT_PART;
+        classes['\\'] |= VALID;
+        classes['\''] |= QUOTE;
+        classes['"'] |= QUOTE;
+        return classes;
+    }
+
+    constexpr std::array<unsigned char, 256> CHARACTER_CLASSES = makeCharacterClasses();
+
+    constexpr unsigned char
+    characterClass(const char character) {
+        return CHARACTER_CLASSES[static_cast<unsigned char>(character)];
+    }
+
+    constexpr std::array<std::string_view, 23> KEYWORDS{{
+        "if", "else",
+        "func", "memo",
+        "typeclass", "type",
+        "val", "List", "Tuple", "Set", "Map",
+        "true", "false",
+        "int", "bool", "char", "null", "string",
+        "case", "match", "any",
+        "import", ".."
+    }};
+
+    // collision free over KEYWORDS, all of which are at least two long
+    constexpr size_t KEYWORD_TABLE_SIZE = 64;
+
+    constexpr size_t
+    keywordHash(const std::string_view & tokenString) {
+        return (3 * static_cast<unsigned char>(tokenString.front())
+                + 20 * static_cast<unsigned char>(tokenString[1])
+                + 17 * static_cast<unsigned char>(tokenString.back())
+                + tokenString.size()) % KEYWORD_TABLE_SIZE;
+    }
+
+    constexpr std::array<std::string_view, KEYWORD_TABLE_SIZE>
+    makeKeywordTable() {
+        std::array<std::string_view, KEYWORD_TABLE_SIZE> table{};
+        for (const auto & keyword : KEYWORDS)
+            table[keywordHash(keyword)] = keyword;
+        return table;
+    }
+
+    constexpr std::array<std::string_view, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = makeKeywordTable();
+
+    constexpr bool
+    keywordTableIsComplete() {
+        for (const auto & keyword : KEYWORDS) {
+            if (KEYWORD_TABLE[keywordHash(keyword)] != keyword)
+                return false;
+        }
+        return true;
+    }
+    static_assert(keywordTableIsComplete(), "keywords collide in the keyword table");
+}
 
 std::string
 Lexer::readFile(const std::string & sourceFileName) {
@@ -39,7 +96,7 @@ Lexer::readFile(const std::string & sourceFileName) {
     }
 
     std::ifstream sourceFile(sourceFileName);
-    
+
     std::string sourceStream;
     if (sourceFile.is_open()) {
         std::ostringstream sourceFileStream;
@@ -51,24 +108,27 @@ Lexer::readFile(const std::string & sourceFileName) {
     return sourceStream;
 }
 
-Lexer::Lexer(const std::string & sourceStream) 
-: sourceStream(sourceStream),
-  currentPosition(1, 1, "") {
+Lexer::Lexer(const std::string & sourceStream, SourceManager & sourceManager)
+: Lexer(std::string(sourceStream), sourceManager) { }
+
+Lexer::Lexer(std::string && sourceStream, SourceManager & sourceManager)
+: sourceManager(sourceManager),
+  sourceStream(sourceManager.intern(std::move(sourceStream))) {
     HEADER("Source text");
-    HEADER(sourceStream);
+    HEADER(std::string(this->sourceStream));
     HEADER("Lexing Errors");
 }
 
-const std::vector<Token>
+std::vector<Token>
 Lexer::makeTokenStream() {
-    for (const auto character : sourceStream)
-        lexCharacter(character);
+    for (size_t position = 0; position < sourceStream.size(); ++position)
+        lexCharacter(sourceStream[position], position);
 
-    if (!currentTokenBlock.empty())
-        lexCharacter('\n');
+    if (!blockEmpty)
+        lexCharacter('\n', sourceStream.size());
 
     HEADER("Tokens");
-    
+
     std::stringstream tokenStringStream;
     for (const auto & token : tokenStream) {
         tokenStringStream << token.toString() << std::endl;
@@ -76,209 +136,218 @@ Lexer::makeTokenStream() {
 
     HEADER(tokenStringStream.str());
 
-    return tokenStream;
+    return std::move(tokenStream);
 }
 
 void
-Lexer::lexCharacter(const char character) {
-    if (filterComments(character)) {
-        if (filterWhitespace(character)) {
-            std::string tokenString;
-            for (auto tokenIter = currentTokenBlock.begin(); tokenIter < currentTokenBlock.end(); ++tokenIter) {
-                if ((isCharDelimiter(*tokenIter) && !inQuotes) || *tokenIter == '\"' || *tokenIter == '\'') {
-                    if (!tokenString.empty()) {
-                        tokenStream.push_back(makeToken(tokenString));
-                        tokenString = "";
-                    }
-
-                    if (isCharDelimiter(*std::next(tokenIter))) {
-                        std::string delimString{*tokenIter, *std::next(tokenIter)};
-                        if (isDelimiter(delimString)) {
-                            tokenStream.push_back(makeToken(delimString));
-                        } else {
-                            tokenStream.push_back(makeToken(std::string(1, *tokenIter)));
-                            tokenStream.push_back(makeToken(std::string(1, *std::next(tokenIter))));
-                        }
-                        ++tokenIter;
-                    } else {
-                        tokenStream.push_back(makeToken(std::string(1, *tokenIter)));
-                    }
-                } else {
-                    tokenString += *tokenIter;
-                }
-            }
+Lexer::lexCharacter(const char character, const size_t position) {
+    if (inComment && character != '\n')
+        return;
 
-            if (!tokenString.empty()) {
-                tokenStream.push_back(makeToken(tokenString));
-                tokenString = "";
-            }
-            currentTokenBlock = "";
-        }
-    }
-
-    if (updateFilePosition) {
-        currentPosition.fileLine += 1;
-        currentPosition.fileColumn = 1;
-        currentPosition.currentLineText = "";
-
-        updateFilePosition = false;
-    }
-}
-
-bool
-Lexer::filterComments(const char character) {
     switch (character) {
         case '#': {
-            inComment = (!inQuotes);
-            return (inQuotes);
+            if (!inQuotes) {
+                inComment = true;
+                return;
+            }
         }
             break;
         case '\n': {
             inComment = false;
-            return true;
-        }
-            break;
-        default:
-            break;
-    }
-    if (inComment) 
-        return false;
-    return true;
-}
-
-bool
-Lexer::filterWhitespace(const char character) {
-    switch (character) {
-        case ' ': {
-            currentPosition.fileColumn += 1;
-            currentPosition.currentLineText += character;
-
             if (inQuotes)
-                currentTokenBlock += character;
+                printError(std::string({character}));
 
-            return !inQuotes; // if in quotes, return false
+            splitBlock();
+
+            fileLine += 1;
+            fileColumn = 1;
+            lineStart = lineTextEnd = position + 1;
+            lineHasCarriageReturn = false;
+            return;
         }
-            break;
+        case ' ':
         case '\t': {
-            currentPosition.fileColumn += 8;
-            currentPosition.currentLineText += character;
+            fileColumn += (character == ' ') ? 1 : 8;
+            lineTextEnd = position + 1;
 
             if (inQuotes)
-                currentTokenBlock += character;
-
-            return !inQuotes; // if in quotes, return false
+                addToBlock(position);
+            else
+                splitBlock();
+            return;
         }
-            break;
         case '\r': {
-            return false;
+            lineHasCarriageReturn = true;
+            return;
         }
+        default:
             break;
-        case '\n': {
-            updateFilePosition = true;
+    }
 
-            if (inQuotes)
-                printError(std::string({character}));
-            
-            return true;
-        }
-            break;
-        case '\"': 
-        case '\'': {
-            currentPosition.fileColumn += 1;
-            currentPosition.currentLineText += character;
-            currentTokenBlock += character;
-
-            if (inQuotes) {
-                inQuotes = false;
-                return true;
-            }
+    fileColumn += 1;
+    lineTextEnd = position + 1;
+
+    if (characterClass(character) & QUOTE) {
+        addToBlock(position);
+        inQuotes = !inQuotes;
+        if (!inQuotes)
+            splitBlock();
+    } else if ((characterClass(character) & VALID) || inQuotes) {
+        addToBlock(position);
+    } else {
+        printError(std::string({character}));
+    }
+}
 
-            inQuotes = true;
-            return false;
-        }
-            break;
-        default: {
-            if (isValidCharacter(character) || inQuotes) {
-                currentPosition.fileColumn += 1;
-                currentPosition.currentLineText += character;
-                currentTokenBlock += character;
-                return false;
+void
+Lexer::addToBlock(const size_t position) {
+    if (blockEmpty) {
+        blockStart = position;
+        blockEnd = position + 1;
+        blockEmpty = false;
+    } else if (blockCopied) {
+        blockBuffer += sourceStream[position];
+    } else if (position == blockEnd) {
+        ++blockEnd;
+    } else {
+        blockBuffer.assign(sourceStream.substr(blockStart, blockEnd - blockStart));
+        blockBuffer += sourceStream[position];
+        blockCopied = true;
+    }
+}
+
+void
+Lexer::splitBlock() {
+    if (blockEmpty)
+        return;
+
+    const std::string_view lineText = currentLineText();
+    const std::string_view block = blockCopied
+        ? sourceManager.intern(std::move(blockBuffer))
+        : sourceStream.substr(blockStart, blockEnd - blockStart);
+
+    size_t tokenStart = 0;
+    for (size_t index = 0; index < block.size(); ++index) {
+        const unsigned char currentClass = characterClass(block[index]);
+        if (((currentClass & DELIMITER) && !inQuotes) || (currentClass & QUOTE)) {
+            if (index > tokenStart)
+                makeToken(block.substr(tokenStart, index - tokenStart), lineText);
+
+            if (index + 1 < block.size() && (characterClass(block[index + 1]) & DELIMITER)) {
+                const std::string_view delimString = block.substr(index, 2);
+                if (isDelimiter(delimString)) {
+                    makeToken(delimString, lineText);
+                } else {
+                    makeToken(block.substr(index, 1), lineText);
+                    makeToken(block.substr(index + 1, 1), lineText);
+                }
+                ++index;
             } else {
-                currentPosition.fileColumn += 1;
-                currentPosition.currentLineText += character;
-                printError(std::string({character}));
-                return false;
+                makeToken(block.substr(index, 1), lineText);
             }
+            tokenStart = index + 1;
         }
     }
+
+    if (tokenStart < block.size())
+        makeToken(block.substr(tokenStart), lineText);
+
+    blockEmpty = true;
+    blockCopied = false;
+    blockBuffer.clear();
 }
 
-const Token
-Lexer::makeToken(const std::string & tokenString) {
-    FilePosition filePosition(currentPosition.fileLine, 
-                            currentPosition.fileColumn - tokenString.length(),
-                            currentPosition.currentLineText);
+void
+Lexer::makeToken(const std::string_view & tokenString, const std::string_view & lineText) {
+    FilePosition filePosition(fileLine,
+                            fileColumn - tokenString.length(),
+                            lineText);
     if (isDelimiter(tokenString)) {
-        return Token(Token::TokenType::DELIM, filePosition, tokenString);
+        tokenStream.emplace_back(Token::TokenType::DELIM, filePosition, tokenString);
     }
     else if (isKeyword(tokenString)) {
-        return Token(Token::TokenType::KEYWORD, filePosition, tokenString);
+        tokenStream.emplace_back(Token::TokenType::KEYWORD, filePosition, tokenString);
     }
     else if (isValue(tokenString)) {
-        return Token(Token::TokenType::VAL, filePosition, tokenString);
+        tokenStream.emplace_back(Token::TokenType::VAL, filePosition, tokenString);
     }
     else if (isIdentity(tokenString)) {
-        return Token(Token::TokenType::IDENT, filePosition, tokenString);
+        tokenStream.emplace_back(Token::TokenType::IDENT, filePosition, tokenString);
+    }
+    else {
+        printError(std::string(tokenString));
+        tokenStream.emplace_back(Token::TokenType::ERROR, filePosition, tokenString);
     }
-    
-    printError(tokenString);
-    return Token(Token::TokenType::ERROR, filePosition, tokenString);
-}
-
-bool
-Lexer::isValidCharacter(const char character) {
-    return (isalnum(character) || isCharDelimiter(character) || character == '_' || character == '\\');
 }
 
 bool
-Lexer::isCharDelimiter(const char character) {
-    return (CHAR_DELIMS.find(character) != std::string::npos);
+Lexer::isDelimiter(const std::string_view & tokenString) {
+    if (tokenString.size() == 1) {
+        switch (tokenString[0]) {
+            case '\'':
+            case '"':
+                inQuotes = !inQuotes;
+                return true;
+            case '&':
+            case '|':
+                return false;
+            default:
+                return (characterClass(tokenString[0]) & DELIMITER) != 0;
+        }
+    } else if (tokenString.size() == 2) {
+        return (tokenString == "->" || tokenString == "&&" || tokenString == "||" ||
+                tokenString == "==" || tokenString == "!=" || tokenString == "<=" || tokenString == ">=");
+    }
+    return false;
 }
 
 bool
-Lexer::isDelimiter(const std::string & tokenString) {
-    if (tokenString == "'" || tokenString == "\"")
-		inQuotes = !inQuotes;
-    return (DELIMITERS.find(tokenString) != DELIMITERS.end());
+Lexer::isKeyword(const std::string_view & tokenString) {
+    return (tokenString.size() >= 2 && KEYWORD_TABLE[keywordHash(tokenString)] == tokenString);
 }
 
 bool
-Lexer::isKeyword(const std::string & tokenString) {
-    return (KEYWORDS.find(tokenString) != KEYWORDS.end());
+Lexer::isValue(const std::string_view & tokenString) {
+    for (const char character : tokenString) {
+        if (!(characterClass(character) & DIGIT))
+            return false;
+    }
+    return true;
 }
 
 bool
-Lexer::isValue(const std::string & tokenString) {
-    for (char const & character : tokenString) {
-        if (std::isdigit(character) == 0) 
+Lexer::isIdentity(const std::string_view & tokenString) const {
+    if (inQuotes)
+        return true;
+    if (tokenString.empty() || !(characterClass(tokenString[0]) & IDENT_START))
+        return false;
+    for (const char character : tokenString.substr(1)) {
+        if (!(characterClass(character) & IDENT_PART))
             return false;
     }
     return true;
 }
 
-bool
-Lexer::isIdentity(const std::string & tokenString) {
-    return (std::regex_match(tokenString, IDENT_REGEX) || inQuotes);
+// the line so far, without the carriage returns and comment it may hold
+std::string_view
+Lexer::currentLineText() const {
+    const std::string_view lineText = sourceStream.substr(lineStart, lineTextEnd - lineStart);
+    if (!lineHasCarriageReturn || lineText.find('\r') == std::string_view::npos)
+        return lineText;
+
+    std::string strippedLineText(lineText);
+    strippedLineText.erase(std::remove(strippedLineText.begin(), strippedLineText.end(), '\r'), strippedLineText.end());
+    return sourceManager.intern(std::move(strippedLineText));
 }
 
 void
 Lexer::printError(const std::string & culprit) {
     error = true;
     std::stringstream errorStream;
-    errorStream << "Line: " << currentPosition.fileLine
-                << ", Column: " << currentPosition.fileColumn - 1 << std::endl
+    errorStream << "Line: " << fileLine
+                << ", Column: " << fileColumn - 1 << std::endl
                 << "Unexpected character: " << culprit << std::endl << std::endl
-                << currentPosition.currentLineText << std::endl
-                << std::string(currentPosition.fileColumn - culprit.length() - 1, ' ') << "^";
+                << currentLineText() << std::endl
+                << std::string(fileColumn - culprit.length() - 1, ' ') << "^";
     ERROR(errorStream.str());
 }
\ No newline at end of file
@@ -4,53 +4,64 @@
 #include "../../utils/filePosition.hpp"
 #include "../builtin/builtinDefinitions.hpp"
 #include "../../defs/token.hpp"
+#include "../../utils/sourceManager.hpp"
 
 #include <vector>
 #include <fstream>
 #include <sstream>
-#include <set>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <cstdio>
 
+// Scans the source in one pass, classifying characters through a lookup
+// table. The source is cut into blocks at whitespace, newlines and closing
+// quotes, and each block into tokens at delimiters; every token of a block
+// is given the position reached at the end of the block. Tokens are views
+// into the source, which is handed to the program's SourceManager to keep.
 class Lexer {
     private:
-        static const std::string CHAR_DELIMS;
-        static const std::set<std::string> DELIMITERS;
-        static const std::set<std::string> KEYWORDS;
-        static const std::regex IDENT_REGEX;
-
-        std::string sourceStream;
+        SourceManager & sourceManager;
+        std::string_view sourceStream;
 
         std::vector<Token> tokenStream;
 
-        FilePosition currentPosition;
-        std::string currentTokenBlock;
-        
-        bool updateFilePosition = false;
+        // the current block is a range of the source, copied into
+        // blockBuffer only once a skipped character splits it
+        size_t blockStart = 0;
+        size_t blockEnd = 0;
+        bool blockEmpty = true;
+        bool blockCopied = false;
+        std::string blockBuffer;
+
+        int fileLine = 1;
+        int fileColumn = 1;
+        size_t lineStart = 0;
+        size_t lineTextEnd = 0;
+        bool lineHasCarriageReturn = false;
+
         bool inComment = false;
-        static bool inQuotes;
+        bool inQuotes = false;
         bool error = false;
 
-        void lexCharacter(const char character);
-        bool filterComments(const char character);
-        bool filterWhitespace(const char character);
-        const Token makeToken(const std::string & tokenString);
+        void lexCharacter(const char character, const size_t position);
+        void addToBlock(const size_t position);
+        void splitBlock();
+        void makeToken(const std::string_view & tokenString, const std::string_view & lineText);
 
-        static bool isValidCharacter(const char character);
-        static bool isCharDelimiter(const char character);
-        static bool isDelimiter(const std::string & tokenString);
-        static bool isKeyword(const std::string & tokenString);
-        static bool isValue(const std::string & tokenString);
-        static bool isIdentity(const std::string & tokenString);
+        bool isDelimiter(const std::string_view & tokenString);
+        static bool isKeyword(const std::string_view & tokenString);
+        static bool isValue(const std::string_view & tokenString);
+        bool isIdentity(const std::string_view & tokenString) const;
 
+        std::string_view currentLineText() const;
         void printError(const std::string & culprit);
 
     public:
         static std::string readFile(const std::string & sourceFileName);
-        
-        explicit Lexer(const std::string & sourceStream);
-        
-        const std::vector<Token> makeTokenStream();
+
+        Lexer(const std::string & sourceStream, SourceManager & sourceManager);
+        Lexer(std::string && sourceStream, SourceManager & sourceManager);
+
+        std::vector<Token> makeTokenStream();
         bool errorOccurred() const { return error; }
 };
\ No newline at end of file
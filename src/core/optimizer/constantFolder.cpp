@@ -0,0 +1,207 @@
+#include "constantFolder.hpp"
+
+bool
+ConstantFolder::run(const ExpPtr & rootExpression) {
+    changed = false;
+    scope.clear();
+    fold(rootExpression);
+    return changed;
+}
+
+ExpPtr
+ConstantFolder::fold(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG)
+        return foldProgram(expression);
+    else if (expression->expType == ExpressionTypes::PRIM)
+        return foldPrimitive(expression);
+    else if (expression->expType == ExpressionTypes::LET)
+        return foldLet(expression);
+    else if (expression->expType == ExpressionTypes::REF)
+        return foldReference(expression);
+    else if (expression->expType == ExpressionTypes::BRANCH)
+        return foldBranch(expression);
+    else if (expression->expType == ExpressionTypes::MATCH)
+        return foldMatch(expression);
+
+    ExpressionUtils::forEachChild(expression, [this](ExpPtr & child) { child = fold(child); });
+    return expression;
+}
+
+ExpPtr
+ConstantFolder::foldProgram(const ExpPtr & expression) {
+    auto program = std::static_pointer_cast<Program>(expression);
+    auto scopeSize = scope.size();
+
+    for (auto & function : program->functions) {
+        scope.emplace_back(function->name, nullptr);
+    }
+
+    for (auto & function : program->functions) {
+        auto functionScopeSize = scope.size();
+        for (auto & parameter : function->parameters) {
+            scope.emplace_back(parameter->name, nullptr);
+        }
+        function->functionBody = fold(function->functionBody);
+        scope.resize(functionScopeSize);
+    }
+
+    program->body = fold(program->body);
+    scope.resize(scopeSize);
+    return program;
+}
+
+ExpPtr
+ConstantFolder::foldPrimitive(const ExpPtr & expression) {
+    auto primitive = std::static_pointer_cast<Primitive>(expression);
+    primitive->leftSide = fold(primitive->leftSide);
+    primitive->rightSide = fold(primitive->rightSide);
+
+    if (primitive->leftSide->expType != ExpressionTypes::LIT ||
+        primitive->rightSide->expType != ExpressionTypes::LIT) {
+        return primitive;
+    }
+
+    auto leftValue = toValue(std::static_pointer_cast<Literal>(primitive->leftSide));
+    auto rightValue = toValue(std::static_pointer_cast<Literal>(primitive->rightSide));
+    if (!leftValue || !rightValue) {
+        return primitive;
+    }
+
+    if ((primitive->op == Operator::OperatorTypes::DIV || primitive->op == Operator::OperatorTypes::MOD) &&
+        rightValue.intData() == 0) {
+        return primitive;
+    }
+
+    auto literal = toLiteral(primitive->token, Operations::doPrimitive(primitive->op, leftValue, rightValue));
+    if (!literal) {
+        return primitive;
+    }
+
+    changed = true;
+    return literal;
+}
+
+ExpPtr
+ConstantFolder::foldLet(const ExpPtr & expression) {
+    auto let = std::static_pointer_cast<Let>(expression);
+    let->value = fold(let->value);
+
+    auto scopeSize = scope.size();
+    if (let->value->expType == ExpressionTypes::TYPECLASS) {
+        scope.emplace_back(std::static_pointer_cast<Typeclass>(let->value)->ident, nullptr);
+    }
+    scope.emplace_back(let->ident, (let->value->expType == ExpressionTypes::LIT) ?
+                                   std::static_pointer_cast<Literal>(let->value) : nullptr);
+
+    let->afterLet = fold(let->afterLet);
+    scope.resize(scopeSize);
+    return let;
+}
+
+ExpPtr
+ConstantFolder::foldReference(const ExpPtr & expression) {
+    auto reference = std::static_pointer_cast<Reference>(expression);
+    if (!reference->fieldIdent.empty()) {
+        return reference;
+    }
+
+    auto literal = findLiteral(reference->ident);
+    if (!literal) {
+        return reference;
+    }
+
+    changed = true;
+    auto copy = makeInArena<Literal>(arena, *literal);
+    copy->token = reference->token;
+    return copy;
+}
+
+ExpPtr
+ConstantFolder::foldBranch(const ExpPtr & expression) {
+    auto branch = std::static_pointer_cast<Branch>(expression);
+    branch->condition = fold(branch->condition);
+
+    if (branch->condition->expType == ExpressionTypes::LIT &&
+        branch->condition->returnType->dataType == Types::DataTypes::BOOL) {
+        changed = true;
+        return fold((std::static_pointer_cast<Literal>(branch->condition)->getData<bool>()) ?
+                    branch->ifBranch : branch->elseBranch);
+    }
+
+    branch->ifBranch = fold(branch->ifBranch);
+    branch->elseBranch = fold(branch->elseBranch);
+    return branch;
+}
+
+ExpPtr
+ConstantFolder::foldMatch(const ExpPtr & expression) {
+    auto match = std::static_pointer_cast<Match>(expression);
+
+    auto literal = findLiteral(match->ident);
+    auto matchValue = (literal) ? toValue(literal) : Values::Value();
+    for (auto & casePtr : match->cases) {
+        casePtr->ident = fold(casePtr->ident);
+        if (!matchValue) {
+            continue;
+        }
+
+        if (ExpressionUtils::isAnyCase(casePtr->ident)) {
+            changed = true;
+            return fold(casePtr->body);
+        }
+
+        auto caseValue = (casePtr->ident->expType == ExpressionTypes::LIT) ?
+                         toValue(std::static_pointer_cast<Literal>(casePtr->ident)) : Values::Value();
+        if (!caseValue || caseValue.dataType() != matchValue.dataType()) {
+            matchValue = Values::Value(); // can not tell which case is taken
+            continue;
+        }
+
+        if (Operations::doPrimitive(Operator::OperatorTypes::EQ, matchValue, caseValue).boolData()) {
+            changed = true;
+            return fold(casePtr->body);
+        }
+    }
+
+    for (auto & casePtr : match->cases) {
+        casePtr->body = fold(casePtr->body);
+    }
+    return match;
+}
+
+std::shared_ptr<Literal>
+ConstantFolder::findLiteral(const std::string & name) const {
+    for (auto scopeName = scope.rbegin(); scopeName != scope.rend(); ++scopeName) {
+        if (scopeName->first == name) {
+            return scopeName->second;
+        }
+    }
+    return nullptr;
+}
+
+Values::Value
+ConstantFolder::toValue(const std::shared_ptr<Literal> & literal) {
+    auto dataType = literal->returnType->dataType;
+    if (dataType == Types::DataTypes::INT && std::holds_alternative<int>(literal->data)) {
+        return Values::makeInt(literal->getData<int>());
+    } else if (dataType == Types::DataTypes::CHAR && std::holds_alternative<char>(literal->data)) {
+        return Values::makeChar(literal->getData<char>());
+    } else if (dataType == Types::DataTypes::BOOL && std::holds_alternative<bool>(literal->data)) {
+        return Values::makeBool(literal->getData<bool>());
+    } else if (dataType == Types::DataTypes::STRING && std::holds_alternative<std::string>(literal->data)) {
+        return std::make_shared<Values::StringValue>(literal->returnType, literal->getData<std::string>());
+    }
+    return Values::Value();
+}
+
+std::shared_ptr<Literal>
+ConstantFolder::toLiteral(const Token & token, const Values::Value & value) {
+    if (value.dataType() == Types::DataTypes::INT) {
+        return makeInArena<Literal>(arena, token, Types::intType(), value.intData());
+    } else if (value.dataType() == Types::DataTypes::CHAR) {
+        return makeInArena<Literal>(arena, token, Types::charType(), value.charData());
+    } else if (value.dataType() == Types::DataTypes::BOOL) {
+        return makeInArena<Literal>(arena, token, Types::boolType(), value.boolData());
+    }
+    return nullptr;
+}
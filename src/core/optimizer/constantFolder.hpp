@@ -0,0 +1,40 @@
+#pragma once
+
+#include "optimizer.hpp"
+#include "expressionUtils.hpp"
+#include "../interpreter/operations.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Evaluates primitives over literals, substitutes names bound to literals
+// and picks the taken arm of branches and matches on known values.
+// Division by zero is left for the runtime to report.
+class ConstantFolder : public Pass {
+    private:
+        // names in scope, with the literal each is bound to if it is one
+        std::vector<std::pair<std::string, std::shared_ptr<Literal>>> scope;
+        bool changed = false;
+
+        ExpPtr fold(const ExpPtr & expression);
+
+        ExpPtr foldProgram(const ExpPtr & expression);
+        ExpPtr foldPrimitive(const ExpPtr & expression);
+        ExpPtr foldLet(const ExpPtr & expression);
+        ExpPtr foldReference(const ExpPtr & expression);
+        ExpPtr foldBranch(const ExpPtr & expression);
+        ExpPtr foldMatch(const ExpPtr & expression);
+
+        std::shared_ptr<Literal> findLiteral(const std::string & name) const;
+
+        static Values::Value toValue(const std::shared_ptr<Literal> & literal);
+        std::shared_ptr<Literal> toLiteral(const Token & token, const Values::Value & value);
+
+    public:
+        using Pass::Pass;
+
+        const std::string name() const override { return "constant folding"; }
+        bool run(const ExpPtr & rootExpression) override;
+};
@@ -0,0 +1,72 @@
+#include "deadLetEliminator.hpp"
+
+bool
+DeadLetEliminator::run(const ExpPtr & rootExpression) {
+    bool removedAny = false;
+
+    // removing a let can leave the names its value used unreferenced
+    do {
+        changed = false;
+        referenceCounts.clear();
+        countReferences(rootExpression);
+        eliminate(rootExpression);
+        removedAny = removedAny || changed;
+    } while (changed);
+
+    return removedAny;
+}
+
+void
+DeadLetEliminator::countReferences(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::REF) {
+        ++referenceCounts[std::static_pointer_cast<Reference>(expression)->ident];
+    } else if (expression->expType == ExpressionTypes::MATCH) {
+        ++referenceCounts[std::static_pointer_cast<Match>(expression)->ident];
+    }
+    ExpressionUtils::forEachChild(expression, [this](ExpPtr & child) { countReferences(child); });
+}
+
+ExpPtr
+DeadLetEliminator::eliminate(const ExpPtr & expression) {
+    ExpressionUtils::forEachChild(expression, [this](ExpPtr & child) { child = eliminate(child); });
+
+    if (expression->expType != ExpressionTypes::LET) {
+        return expression;
+    }
+
+    auto let = std::static_pointer_cast<Let>(expression);
+    if (referenceCounts[let->ident] == 0 && isPure(let->value)) {
+        changed = true;
+        return let->afterLet;
+    }
+    return let;
+}
+
+bool
+DeadLetEliminator::isPure(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::LIT ||
+        expression->expType == ExpressionTypes::REF ||
+        expression->expType == ExpressionTypes::END) {
+        return true;
+    } else if (expression->expType == ExpressionTypes::PRIM) {
+        auto primitive = std::static_pointer_cast<Primitive>(expression);
+        if (primitive->op == Operator::OperatorTypes::DIV || primitive->op == Operator::OperatorTypes::MOD) {
+            auto rightSide = primitive->rightSide;
+            if (rightSide->expType != ExpressionTypes::LIT ||
+                !std::holds_alternative<int>(std::static_pointer_cast<Literal>(rightSide)->data) ||
+                std::static_pointer_cast<Literal>(rightSide)->getData<int>() == 0) {
+                return false;
+            }
+        }
+        return isPure(primitive->leftSide) && isPure(primitive->rightSide);
+    } else if (expression->expType == ExpressionTypes::LIST_DEF ||
+               expression->expType == ExpressionTypes::TUPLE_DEF ||
+               expression->expType == ExpressionTypes::BRANCH) {
+        bool pure = true;
+        ExpressionUtils::forEachChild(expression, [&pure](ExpPtr & child) { pure = pure && isPure(child); });
+        return pure;
+    }
+
+    // applications can have effects or fail, blocks and typeclasses bind names
+    return false;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "optimizer.hpp"
+#include "expressionUtils.hpp"
+
+#include <map>
+#include <string>
+
+// Removes lets whose name is never referenced and whose value can not fail
+// or have an effect. Names the resolver leaves to runtime lookup are found
+// by name, so a binding only counts as unused if no reference anywhere in
+// the program has its name.
+class DeadLetEliminator : public Pass {
+    private:
+        std::map<std::string, int> referenceCounts;
+        bool changed = false;
+
+        void countReferences(const ExpPtr & expression);
+        ExpPtr eliminate(const ExpPtr & expression);
+
+        static bool isPure(const ExpPtr & expression);
+
+    public:
+        using Pass::Pass;
+
+        const std::string name() const override { return "dead let elimination"; }
+        bool run(const ExpPtr & rootExpression) override;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../../defs/expressions.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+using namespace Expressions;
+
+// Tree helpers shared by the optimization passes
+namespace ExpressionUtils {
+    // visits every direct subexpression slot of expression so it can be replaced
+    inline void
+    forEachChild(const ExpPtr & expression, const std::function<void(ExpPtr &)> & visit) {
+        if (expression->expType == ExpressionTypes::PROG) {
+            auto program = std::static_pointer_cast<Program>(expression);
+            for (auto & function : program->functions) {
+                visit(function->functionBody);
+            }
+            visit(program->body);
+        } else if (expression->expType == ExpressionTypes::PRIM) {
+            auto primitive = std::static_pointer_cast<Primitive>(expression);
+            visit(primitive->leftSide);
+            visit(primitive->rightSide);
+        } else if (expression->expType == ExpressionTypes::LET) {
+            auto let = std::static_pointer_cast<Let>(expression);
+            visit(let->value);
+            visit(let->afterLet);
+        } else if (expression->expType == ExpressionTypes::BRANCH) {
+            auto branch = std::static_pointer_cast<Branch>(expression);
+            visit(branch->condition);
+            visit(branch->ifBranch);
+            visit(branch->elseBranch);
+        } else if (expression->expType == ExpressionTypes::APP) {
+            auto application = std::static_pointer_cast<Application>(expression);
+            visit(application->ident);
+            for (auto & argument : application->arguments) {
+                visit(argument);
+            }
+        } else if (expression->expType == ExpressionTypes::LIST_DEF) {
+            for (auto & value : std::static_pointer_cast<ListDefinition>(expression)->values) {
+                visit(value);
+            }
+        } else if (expression->expType == ExpressionTypes::TUPLE_DEF) {
+            for (auto & value : std::static_pointer_cast<TupleDefinition>(expression)->values) {
+                visit(value);
+            }
+        } else if (expression->expType == ExpressionTypes::MATCH) {
+            for (auto & casePtr : std::static_pointer_cast<Match>(expression)->cases) {
+                visit(casePtr->ident);
+                visit(casePtr->body);
+            }
+        }
+    }
+
+    inline bool
+    isAnyCase(const ExpPtr & expression) {
+        return expression->expType == ExpressionTypes::REF &&
+               std::static_pointer_cast<Reference>(expression)->ident == std::string("$any");
+    }
+
+    // number of nodes in the tree under expression
+    inline int
+    size(const ExpPtr & expression) {
+        int count = 1;
+        forEachChild(expression, [&count](ExpPtr & child) { count += size(child); });
+        return count;
+    }
+
+    // deep copy of a tree without blocks or typeclasses, which bind
+    // names the copy would have to rename, made in arena
+    inline ExpPtr
+    clone(const ExpPtr & expression, const ArenaPtr & arena) {
+        ExpPtr copy;
+        if (expression->expType == ExpressionTypes::LIT) {
+            copy = makeInArena<Literal>(arena, *std::static_pointer_cast<Literal>(expression));
+        } else if (expression->expType == ExpressionTypes::PRIM) {
+            copy = makeInArena<Primitive>(arena, *std::static_pointer_cast<Primitive>(expression));
+        } else if (expression->expType == ExpressionTypes::LET) {
+            copy = makeInArena<Let>(arena, *std::static_pointer_cast<Let>(expression));
+        } else if (expression->expType == ExpressionTypes::REF) {
+            copy = makeInArena<Reference>(arena, *std::static_pointer_cast<Reference>(expression));
+        } else if (expression->expType == ExpressionTypes::BRANCH) {
+            copy = makeInArena<Branch>(arena, *std::static_pointer_cast<Branch>(expression));
+        } else if (expression->expType == ExpressionTypes::APP) {
+            auto application = makeInArena<Application>(arena, *std::static_pointer_cast<Application>(expression));
+            application->isTailCall = false;
+            copy = application;
+        } else if (expression->expType == ExpressionTypes::LIST_DEF) {
+            copy = makeInArena<ListDefinition>(arena, *std::static_pointer_cast<ListDefinition>(expression));
+        } else if (expression->expType == ExpressionTypes::TUPLE_DEF) {
+            copy = makeInArena<TupleDefinition>(arena, *std::static_pointer_cast<TupleDefinition>(expression));
+        } else if (expression->expType == ExpressionTypes::MATCH) {
+            auto match = makeInArena<Match>(arena, *std::static_pointer_cast<Match>(expression));
+            for (auto & casePtr : match->cases) {
+                casePtr = makeInArena<Case>(arena, *casePtr);
+            }
+            copy = match;
+        } else {
+            return expression;
+        }
+
+        forEachChild(copy, [&arena](ExpPtr & child) { child = clone(child, arena); });
+        return copy;
+    }
+}
@@ -0,0 +1,278 @@
+#include "inliner.hpp"
+
+bool
+Inliner::run(const ExpPtr & rootExpression) {
+    changed = false;
+    scope.clear();
+    candidates.clear();
+    inlineCalls(rootExpression);
+    return changed;
+}
+
+ExpPtr
+Inliner::inlineCalls(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG)
+        return inlineProgram(expression);
+    else if (expression->expType == ExpressionTypes::LET)
+        return inlineLet(expression);
+    else if (expression->expType == ExpressionTypes::APP)
+        return inlineApplication(expression);
+
+    ExpressionUtils::forEachChild(expression, [this](ExpPtr & child) { child = inlineCalls(child); });
+    return expression;
+}
+
+ExpPtr
+Inliner::inlineProgram(const ExpPtr & expression) {
+    auto program = std::static_pointer_cast<Program>(expression);
+    auto scopeSize = scope.size();
+
+    for (auto & function : program->functions) {
+        scope.emplace_back(function->name, function.get());
+    }
+    addCandidates(program);
+
+    for (auto & function : program->functions) {
+        auto functionScopeSize = scope.size();
+        for (auto & parameter : function->parameters) {
+            scope.emplace_back(parameter->name, parameter.get());
+        }
+        function->functionBody = inlineCalls(function->functionBody);
+        scope.resize(functionScopeSize);
+    }
+
+    program->body = inlineCalls(program->body);
+    scope.resize(scopeSize);
+    return program;
+}
+
+ExpPtr
+Inliner::inlineLet(const ExpPtr & expression) {
+    auto let = std::static_pointer_cast<Let>(expression);
+    let->value = inlineCalls(let->value);
+
+    auto scopeSize = scope.size();
+    if (let->value->expType == ExpressionTypes::TYPECLASS) {
+        scope.emplace_back(std::static_pointer_cast<Typeclass>(let->value)->ident, let->value.get());
+    }
+    scope.emplace_back(let->ident, let.get());
+
+    let->afterLet = inlineCalls(let->afterLet);
+    scope.resize(scopeSize);
+    return let;
+}
+
+ExpPtr
+Inliner::inlineApplication(const ExpPtr & expression) {
+    auto application = std::static_pointer_cast<Application>(expression);
+    ExpressionUtils::forEachChild(application, [this](ExpPtr & child) { child = inlineCalls(child); });
+
+    if (application->ident->expType != ExpressionTypes::REF ||
+        !std::static_pointer_cast<Reference>(application->ident)->fieldIdent.empty()) {
+        return application;
+    }
+
+    auto candidate = candidates.find(findBinder(scope, std::static_pointer_cast<Reference>(application->ident)->ident));
+    if (candidate == candidates.end() || !canExpand(candidate->second, application)) {
+        return application;
+    }
+
+    return expand(candidate->second, application);
+}
+
+// Functions of the block that could be expanded anywhere their name is in scope
+void
+Inliner::addCandidates(const std::shared_ptr<Program> & program) {
+    std::map<std::string, std::set<std::string>> calledNames;
+    for (auto & function : program->functions) {
+        std::vector<std::string> boundNames;
+        for (auto & parameter : function->parameters) {
+            boundNames.push_back(parameter->name);
+        }
+        collectFreeNames(function->functionBody, boundNames, calledNames[function->name]);
+    }
+
+    for (auto & function : program->functions) {
+        // a memo func expanded would run on every call instead of once per arguments
+        if (function->isBuiltin || BuiltinDefinitions::isBuiltin(function->name) ||
+            !function->genericParameters.empty() || function->memoized) {
+            continue;
+        }
+
+        // recursive if its own name is reachable through the functions of the block it uses
+        bool isRecursive = false;
+        std::set<std::string> visited;
+        std::vector<std::string> pending(calledNames[function->name].begin(), calledNames[function->name].end());
+        while (!pending.empty() && !isRecursive) {
+            auto name = pending.back();
+            pending.pop_back();
+
+            if (name == function->name) {
+                isRecursive = true;
+            } else if (calledNames.count(name) && visited.insert(name).second) {
+                pending.insert(pending.end(), calledNames[name].begin(), calledNames[name].end());
+            }
+        }
+
+        if (!isRecursive) {
+            candidates[function.get()] = Candidate{function, scope};
+        }
+    }
+}
+
+bool
+Inliner::canExpand(const Candidate & candidate, const std::shared_ptr<Application> & application) const {
+    const auto & function = candidate.function;
+    if (application->arguments.size() != function->parameters.size() ||
+        ExpressionUtils::size(function->functionBody) > MAX_INLINE_SIZE ||
+        containsBlocks(function->functionBody)) {
+        return false;
+    }
+
+    std::vector<std::string> boundNames;
+    for (auto & parameter : function->parameters) {
+        boundNames.push_back(parameter->name);
+    }
+    std::set<std::string> freeNames;
+    collectFreeNames(function->functionBody, boundNames, freeNames);
+
+    for (const auto & freeName : freeNames) {
+        auto binder = findBinder(candidate.definitionScope, freeName);
+        if (binder == nullptr || binder != findBinder(scope, freeName)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ExpPtr
+Inliner::expand(const Candidate & candidate, const std::shared_ptr<Application> & application) {
+    const auto & function = candidate.function;
+
+    // fresh parameter names, so arguments naming the caller's variables are not captured
+    std::map<std::string, std::string> renames;
+    for (auto & parameter : function->parameters) {
+        renames[parameter->name] = std::string("i$") + std::to_string(inlineCount++);
+    }
+
+    auto body = ExpressionUtils::clone(function->functionBody, arena);
+    rename(body, renames);
+
+    for (auto parameterIndex = function->parameters.size(); parameterIndex > 0; --parameterIndex) {
+        const auto & parameter = function->parameters.at(parameterIndex - 1);
+        const auto & argument = application->arguments.at(parameterIndex - 1);
+        body = makeInArena<Let>(arena, argument->token, renames[parameter->name], parameter->returnType, argument, body);
+    }
+
+    changed = true;
+    return body;
+}
+
+const Expression *
+Inliner::findBinder(const Scope & scope, const std::string & name) {
+    for (auto scopeName = scope.rbegin(); scopeName != scope.rend(); ++scopeName) {
+        if (scopeName->first == name) {
+            return scopeName->second;
+        }
+    }
+    return nullptr;
+}
+
+bool
+Inliner::containsBlocks(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG || expression->expType == ExpressionTypes::TYPECLASS) {
+        return true;
+    }
+
+    bool found = false;
+    ExpressionUtils::forEachChild(expression, [&found](ExpPtr & child) { found = found || containsBlocks(child); });
+    return found;
+}
+
+void
+Inliner::collectFreeNames(const ExpPtr & expression, std::vector<std::string> & boundNames, std::set<std::string> & freeNames) {
+    auto isBound = [&boundNames](const std::string & name) {
+        return std::find(boundNames.begin(), boundNames.end(), name) != boundNames.end();
+    };
+
+    if (expression->expType == ExpressionTypes::REF) {
+        auto reference = std::static_pointer_cast<Reference>(expression);
+        if (!ExpressionUtils::isAnyCase(reference) && !isBound(reference->ident)) {
+            freeNames.insert(reference->ident);
+        }
+        return;
+    } else if (expression->expType == ExpressionTypes::LET) {
+        auto let = std::static_pointer_cast<Let>(expression);
+        auto boundSize = boundNames.size();
+
+        collectFreeNames(let->value, boundNames, freeNames);
+        if (let->value->expType == ExpressionTypes::TYPECLASS) {
+            boundNames.push_back(std::static_pointer_cast<Typeclass>(let->value)->ident);
+        }
+        boundNames.push_back(let->ident);
+        collectFreeNames(let->afterLet, boundNames, freeNames);
+
+        boundNames.resize(boundSize);
+        return;
+    } else if (expression->expType == ExpressionTypes::PROG) {
+        auto program = std::static_pointer_cast<Program>(expression);
+        auto boundSize = boundNames.size();
+
+        for (auto & function : program->functions) {
+            boundNames.push_back(function->name);
+        }
+        for (auto & function : program->functions) {
+            auto functionBoundSize = boundNames.size();
+            for (auto & parameter : function->parameters) {
+                boundNames.push_back(parameter->name);
+            }
+            collectFreeNames(function->functionBody, boundNames, freeNames);
+            boundNames.resize(functionBoundSize);
+        }
+        collectFreeNames(program->body, boundNames, freeNames);
+
+        boundNames.resize(boundSize);
+        return;
+    } else if (expression->expType == ExpressionTypes::MATCH) {
+        auto match = std::static_pointer_cast<Match>(expression);
+        if (!isBound(match->ident)) {
+            freeNames.insert(match->ident);
+        }
+    }
+
+    ExpressionUtils::forEachChild(expression, [&boundNames, &freeNames](ExpPtr & child) {
+        collectFreeNames(child, boundNames, freeNames);
+    });
+}
+
+// Renames references to the keys of renames, up to where a let shadows them.
+// Only used on copies without blocks or typeclasses.
+void
+Inliner::rename(ExpPtr & expression, std::map<std::string, std::string> renames) {
+    if (renames.empty()) {
+        return;
+    }
+
+    if (expression->expType == ExpressionTypes::REF) {
+        auto reference = std::static_pointer_cast<Reference>(expression);
+        auto newName = renames.find(reference->ident);
+        if (newName != renames.end()) {
+            reference->ident = newName->second;
+        }
+        return;
+    } else if (expression->expType == ExpressionTypes::LET) {
+        auto let = std::static_pointer_cast<Let>(expression);
+        rename(let->value, renames);
+        renames.erase(let->ident);
+        rename(let->afterLet, renames);
+        return;
+    } else if (expression->expType == ExpressionTypes::MATCH) {
+        auto match = std::static_pointer_cast<Match>(expression);
+        auto newName = renames.find(match->ident);
+        if (newName != renames.end()) {
+            match->ident = newName->second;
+        }
+    }
+
+    ExpressionUtils::forEachChild(expression, [&renames](ExpPtr & child) { rename(child, renames); });
+}
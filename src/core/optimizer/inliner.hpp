@@ -0,0 +1,58 @@
+#pragma once
+
+#include "optimizer.hpp"
+#include "expressionUtils.hpp"
+#include "../builtin/builtinDefinitions.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Replaces calls to small, non-generic, non-recursive functions with a copy
+// of their body, the arguments bound to fresh lets in place of the
+// parameters. A call is only expanded if every name the body uses from
+// outside refers to the same binding at the call site as where the
+// function is defined.
+class Inliner : public Pass {
+    private:
+        static constexpr int MAX_INLINE_SIZE = 16;
+
+        // names in scope in binding order, with the node that binds each
+        using Scope = std::vector<std::pair<std::string, const Expression *>>;
+
+        class Candidate {
+            public:
+                std::shared_ptr<Function> function;
+                Scope definitionScope;
+        };
+
+        Scope scope;
+        std::map<const Expression *, Candidate> candidates;
+        int inlineCount = 0;
+        bool changed = false;
+
+        ExpPtr inlineCalls(const ExpPtr & expression);
+
+        ExpPtr inlineProgram(const ExpPtr & expression);
+        ExpPtr inlineLet(const ExpPtr & expression);
+        ExpPtr inlineApplication(const ExpPtr & expression);
+
+        void addCandidates(const std::shared_ptr<Program> & program);
+        bool canExpand(const Candidate & candidate, const std::shared_ptr<Application> & application) const;
+        ExpPtr expand(const Candidate & candidate, const std::shared_ptr<Application> & application);
+
+        static const Expression * findBinder(const Scope & scope, const std::string & name);
+        static bool containsBlocks(const ExpPtr & expression);
+        static void collectFreeNames(const ExpPtr & expression, std::vector<std::string> & boundNames, std::set<std::string> & freeNames);
+        static void rename(ExpPtr & expression, std::map<std::string, std::string> renames);
+
+    public:
+        using Pass::Pass;
+
+        const std::string name() const override { return "inlining"; }
+        bool run(const ExpPtr & rootExpression) override;
+};
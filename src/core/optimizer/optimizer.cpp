@@ -0,0 +1,43 @@
+#include "optimizer.hpp"
+#include "constantFolder.hpp"
+#include "deadLetEliminator.hpp"
+#include "inliner.hpp"
+
+Optimizer::Optimizer(const ExpPtr & rootExpression, const ArenaPtr & arena, const int level)
+: rootExpression(rootExpression),
+  arena(arena),
+  level(level) {
+    if (level >= 2) {
+        passes.push_back(std::make_unique<Inliner>(arena));
+    }
+    passes.push_back(std::make_unique<ConstantFolder>(arena));
+    passes.push_back(std::make_unique<DeadLetEliminator>(arena));
+}
+
+void
+Optimizer::optimize() {
+    HEADER(std::string("Optimizing -O") + std::to_string(level));
+
+    int rounds = (level >= 2) ? MAX_ROUNDS : 1;
+    for (int round = 0; round < rounds; ++round) {
+        bool changed = false;
+        for (auto & pass : passes) {
+            if (pass->run(rootExpression)) {
+                HEADER(pass->name() + std::string(" changed round ") + std::to_string(round));
+                changed = true;
+            }
+        }
+
+        if (!changed) {
+            break;
+        }
+    }
+
+    HEADER("Optimizing Done");
+
+    HEADER("Optimized AST");
+    if (Logger::current().getLevel() == DEBUG) {
+        PrettyPrint printer;
+        printer.print(rootExpression);
+    }
+}
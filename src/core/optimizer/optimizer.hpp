@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../../utils/logger.hpp"
+#include "../../utils/prettyprint.hpp"
+#include "../../defs/expressions.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Expressions;
+
+// One rewrite of a program tree, run is true if anything changed
+class Pass {
+    public:
+        // new nodes go in the arena of the tree being rewritten
+        ArenaPtr arena;
+
+        explicit Pass(const ArenaPtr & arena) : arena(arena) { }
+        virtual ~Pass() = default;
+
+        virtual const std::string name() const = 0;
+        virtual bool run(const ExpPtr & rootExpression) = 0;
+};
+
+// Runs the passes for an optimization level over a type checked tree,
+// before names are resolved:
+//  -O1: constant folding, dead let elimination
+//  -O2: adds inlining of small non-recursive functions, repeated until
+//       nothing changes
+class Optimizer {
+    private:
+        static constexpr int MAX_ROUNDS = 4;
+
+        ExpPtr rootExpression;
+        ArenaPtr arena;
+        int level;
+        std::vector<std::unique_ptr<Pass>> passes;
+
+    public:
+        Optimizer(const ExpPtr & rootExpression, const ArenaPtr & arena, const int level);
+        void optimize();
+};
@@ -1,7 +1,8 @@
 #include "parser.hpp"
 
-Parser::Parser(const std::vector<Token> & tokenStream)
-: tokenStream(tokenStream) { }
+Parser::Parser(const std::vector<Token> & tokenStream, const ArenaPtr & arena)
+: tokenStream(tokenStream),
+  arena(arena) { }
 
 ExpPtr
 Parser::makeTree() {
@@ -18,63 +19,92 @@ Parser::parseProgram() {
     Token token = currentToken();
 
     std::vector<std::shared_ptr<Function>> functions;
-    while (match(Token::TokenType::KEYWORD, "func"))
+    while (startsFunc()) {
+        bool memoized = match(Token::TokenType::KEYWORD, "memo");
+        skip("func");
         functions.push_back(parseFunc());
+        functions.back()->memoized = memoized;
+    }
 
-    return std::make_shared<Program>(token, functions, parseExpression());
+    return makeInArena<Program>(arena, token, functions, parseExpression());
 }
 
 void
 Parser::preprocessImports() {
-    bool importing = false;
-    do {
-        importing = false;
-        for (unsigned int tokenIndex = 0; tokenIndex < tokenStream.size(); ++tokenIndex) {
-            if (tokenStream.at(tokenIndex).text == "import") {
-                importing = true;
-                auto newStream = parseImport(tokenIndex);
-                
-                if (!newStream.empty())
-                    tokenStream.insert(tokenStream.begin() + tokenIndex, newStream.begin(), newStream.end());
-            }
-        }
-    } while (importing);
+    std::vector<Token> expandedStream;
+    expandedStream.reserve(tokenStream.size());
+
+    std::vector<std::string> importChain;
+    expandImports(tokenStream, expandedStream, importChain);
+    tokenStream = std::move(expandedStream);
 }
 
-std::vector<Token>
-Parser::parseImport(int tokenIndex) {
-    tokenStream.erase(tokenStream.begin() + tokenIndex); // remove import token
+// Appends the tokens of a file with each import replaced by the tokens of
+// the file it names. A file is lexed and spliced in only where it is first
+// imported, later imports of it are dropped
+void
+Parser::expandImports(const std::vector<Token> & fileTokens, std::vector<Token> & expandedStream, std::vector<std::string> & importChain) {
+    for (unsigned int tokenIndex = 0; tokenIndex < fileTokens.size(); ++tokenIndex) {
+        const Token & importToken = fileTokens.at(tokenIndex);
+        if (importToken.text != "import") {
+            expandedStream.push_back(importToken);
+            continue;
+        }
 
-    std::string sourceFileName = tokenStream.at(tokenIndex).text;
-    tokenStream.erase(tokenStream.begin() + tokenIndex); // remove file name token, now on first token of next
+        if (tokenIndex + 1 >= fileTokens.size()) {
+            printImportError(importToken, "Error: import requires a file name");
+            return;
+        }
 
-    while (tokenStream.at(tokenIndex).text == "/") {
-        sourceFileName += tokenStream.at(tokenIndex).text; // add "/"
-        tokenStream.erase(tokenStream.begin() + tokenIndex);
+        std::string sourceFileName(fileTokens.at(++tokenIndex).text);
+        while (tokenIndex + 2 < fileTokens.size() && fileTokens.at(tokenIndex + 1).text == "/") {
+            sourceFileName += std::string("/") + std::string(fileTokens.at(tokenIndex + 2).text); // nested file
+            tokenIndex += 2;
+        }
+        sourceFileName = std::filesystem::path(sourceFileName + std::string(".bnt")).lexically_normal().string();
 
-        sourceFileName += tokenStream.at(tokenIndex).text; // nested file
-        tokenStream.erase(tokenStream.begin() + tokenIndex);
-    }
+        if (std::find(importChain.begin(), importChain.end(), sourceFileName) != importChain.end()) {
+            std::string cycle;
+            for (const auto & fileName : importChain) {
+                cycle += fileName + std::string(" -> ");
+            }
+            printImportError(importToken, std::string("Error: Import cycle: ") + cycle + sourceFileName);
+            continue;
+        }
 
-    std::string stream = Lexer::readFile(sourceFileName + std::string(".bnt"));
+        if (!importedFileSet.insert(sourceFileName).second) {
+            continue;
+        }
+        importedFiles.push_back(sourceFileName);
 
-    if (stream.empty())
-        return std::vector<Token>{};
+        std::string stream = Lexer::readFile(sourceFileName);
 
-    if (stream.back() != ';')
-        stream += std::string(";");
+        if (stream.empty())
+            continue;
+
+        auto lastCharacter = stream.find_last_not_of(" \t\r\n");
+        if (lastCharacter == std::string::npos || stream.at(lastCharacter) != ';')
+            stream += std::string(";");
+
+        auto lexer = Lexer(std::move(stream), arena->sources());
+        auto importedTokens = lexer.makeTokenStream();
+        if (lexer.errorOccurred()) {
+            error = true;
+        }
 
-    auto lexer = Lexer(std::move(stream));
-    return lexer.makeTokenStream();
+        importChain.push_back(sourceFileName);
+        expandImports(importedTokens, expandedStream, importChain);
+        importChain.pop_back();
+    }
 }
 
 ExpPtr
 Parser::parseExpression() {
     if (!inBounds())
-        return Expression::End();
+        return Expression::End(arena);
 
     if (match(Token::TokenType::KEYWORD, "val")) {
-        const std::string ident = currentToken().text;
+        const std::string ident(currentToken().text);
         Token token = currentToken();
         advance();
 
@@ -84,13 +114,13 @@ Parser::parseExpression() {
         ExpPtr valueExpression = parseSimpleExpression();
         skip(";");
         ExpPtr afterExpression = parseExpression();
-        return std::make_shared<Let>(token, ident, valueType, valueExpression, afterExpression);
+        return makeInArena<Let>(arena, token, ident, valueType, valueExpression, afterExpression);
     } else {
         Token token = currentToken();
         ExpPtr simpleExpression = parseSimpleExpression();
         if (match(Token::TokenType::DELIM, ";")) {
             ExpPtr expression = parseExpression();
-            return std::make_shared<Let>(token, dummy(), std::make_shared<Types::UnknownType>(), simpleExpression, expression);
+            return makeInArena<Let>(arena, token, dummy(), makeInArena<Types::UnknownType>(arena), simpleExpression, expression);
         }
         return simpleExpression;
     }
@@ -108,7 +138,7 @@ Parser::parseSimpleExpression() {
         return parseMatch();
     } else if (match(Token::TokenType::KEYWORD, "type")) {
         return parseTypeclass();
-    } else if (matchNoAdvance(Token::TokenType::KEYWORD, "func")) {
+    } else if (startsFunc()) {
         return parseProgram();
     }
     return parseUtight(0);
@@ -117,7 +147,7 @@ Parser::parseSimpleExpression() {
 std::shared_ptr<Typeclass>
 Parser::parseTypeclass() {
     Token token = currentToken();
-    const std::string ident = currentToken().text;
+    const std::string ident(currentToken().text);
     advance();
     skip("{");
 
@@ -147,8 +177,8 @@ Parser::parseTypeclass() {
 	    fieldTypes.push_back(std::pair<std::string, Types::TypePtr>(field->name, field->returnType));
     }
 
-    Types::TypeclassTypePtr type = std::make_shared<Types::TypeclassType>(ident, fieldTypes);
-    return std::make_shared<Typeclass>(token, ident, fields, type);
+    Types::TypeclassTypePtr type = makeInArena<Types::TypeclassType>(arena, ident, fieldTypes);
+    return makeInArena<Typeclass>(arena, token, ident, fields, type);
 }
 
 std::shared_ptr<Branch>
@@ -160,11 +190,11 @@ Parser::parseBranch() {
 
     ExpPtr trueBranch = parseSimpleExpression();
     if (match(Token::TokenType::KEYWORD, "else")) {
-        return std::make_shared<Branch>(token, condition, 
+        return makeInArena<Branch>(arena, token, condition, 
                                         trueBranch, parseSimpleExpression());
     }
-    return std::make_shared<Branch>(token, condition, 
-                                    trueBranch, std::make_shared<Literal>(token));
+    return makeInArena<Branch>(arena, token, condition, 
+                                    trueBranch, makeInArena<Literal>(arena, token));
 }
 
 std::shared_ptr<ListDefinition>
@@ -182,16 +212,16 @@ Parser::parseList() {
 
     std::shared_ptr<ListDefinition> listDefinition;
     if (listValues.empty()) {
-        listDefinition = std::make_shared<ListDefinition>(token, listValues);
+        listDefinition = makeInArena<ListDefinition>(arena, token, listValues);
     } else {
         auto listType = listValues.at(0)->returnType;
         for (auto & value : listValues) {
             if (!listType->compare(value->returnType)) {
-                ERROR(std::string("Error: List types must match: ") + currentToken().position.currentLineText);
-	            return listDefinition = std::make_shared<ListDefinition>(token, listValues);
+                ERROR(std::string("Error: List types must match: ") + currentToken().position.currentLineText());
+	            return listDefinition = makeInArena<ListDefinition>(arena, token, listValues);
             }
         }
-        listDefinition = std::make_shared<ListDefinition>(token, listValues, std::make_shared<Types::ListType>(listType));
+        listDefinition = makeInArena<ListDefinition>(arena, token, listValues, makeInArena<Types::ListType>(arena, listType));
     }
 
     skip("}");
@@ -213,15 +243,15 @@ Parser::parseTuple() {
 
     std::shared_ptr<TupleDefinition> tupleDefinition;
     if (tupleValues.empty()) {
-        tupleDefinition = std::make_shared<TupleDefinition>(token, tupleValues);
+        tupleDefinition = makeInArena<TupleDefinition>(arena, token, tupleValues);
     } else {
         std::vector<Types::TypePtr> tupleTypes;
         std::transform(tupleValues.begin(), tupleValues.end(), std::back_inserter(tupleTypes),
                     [](const ExpPtr & value) -> Types::TypePtr { 
                        return value->returnType; 
                     });
-        auto tupleType = std::make_shared<Types::TupleType>(tupleTypes);
-        tupleDefinition = std::make_shared<TupleDefinition>(token, tupleType, tupleValues);
+        auto tupleType = makeInArena<Types::TupleType>(arena, tupleTypes);
+        tupleDefinition = makeInArena<TupleDefinition>(arena, token, tupleType, tupleValues);
     }
 
     skip("}");
@@ -232,7 +262,7 @@ std::shared_ptr<Match>
 Parser::parseMatch() {
     const Token token = currentToken();
     skip("(");
-    const std::string ident = currentToken().text;
+    const std::string ident(currentToken().text);
     advance();
     skip(")");
 	skip("{");
@@ -243,7 +273,7 @@ Parser::parseMatch() {
     }
     skip("}");
     
-    return std::make_shared<Match>(token, ident, cases);
+    return makeInArena<Match>(arena, token, ident, cases);
 }
 
 std::shared_ptr<Case>
@@ -251,7 +281,7 @@ Parser::parseCase() {
     const Token token = currentToken();
     ExpPtr ident;
     if (match(Token::TokenType::KEYWORD, "any")) {
-        ident = std::make_shared<Reference>(token, std::make_shared<Types::NullType>(), std::string("$any"));
+        ident = makeInArena<Reference>(arena, token, Types::nullType(), std::string("$any"));
     } else {
         ident = parseAtom();
     }
@@ -260,7 +290,7 @@ Parser::parseCase() {
     ExpPtr block = parseSimpleExpression();
     skip("}");
     skip(";");
-    return std::make_shared<Case>(token, ident, block);
+    return makeInArena<Case>(arena, token, ident, block);
 }
 
 ExpPtr
@@ -274,7 +304,7 @@ Parser::parseUtight(int min) {
 
         int tempMin = Operator::getPrecedence(op) + 1;
         ExpPtr rightSide = parseUtight(tempMin);
-        leftSide = std::make_shared<Primitive>(token, leftSide->returnType, op, leftSide, rightSide);
+        leftSide = makeInArena<Primitive>(arena, token, leftSide->returnType, op, leftSide, rightSide);
     }
     return leftSide;
 }
@@ -294,9 +324,9 @@ Parser::parseUtight() {
 
     ExpPtr rightSide = parseTight();
     if (op == Operator::OperatorTypes::PLUS || op == Operator::OperatorTypes::MINUS) {
-		return std::make_shared<Primitive>(token, std::make_shared<Types::IntType>(), op, std::make_shared<Literal>(token, std::make_shared<Types::IntType>(), 0), rightSide);
+		return makeInArena<Primitive>(arena, token, Types::intType(), op, makeInArena<Literal>(arena, token, Types::intType(), 0), rightSide);
 	} else if (op == Operator::OperatorTypes::NOT) {
-		return std::make_shared<Primitive>(token, std::make_shared<Types::BoolType>(), op, std::make_shared<Literal>(token, std::make_shared<Types::BoolType>(), false), rightSide);
+		return makeInArena<Primitive>(arena, token, Types::boolType(), op, makeInArena<Literal>(arena, token, Types::boolType(), false), rightSide);
 	}
 	return rightSide;
 }
@@ -336,7 +366,7 @@ Parser::parseApplication() {
         }
         skip(")");
 
-        std::shared_ptr<Application> app = std::make_shared<Application>(token, ident, arguments);
+        std::shared_ptr<Application> app = makeInArena<Application>(arena, token, ident, arguments);
         app->genericReplacementTypes = genericReplacementTypes;
 
         while (match(Token::TokenType::DELIM, "(")) {
@@ -350,7 +380,7 @@ Parser::parseApplication() {
                 argumentsOuter.push_back(parseSimpleExpression());	
             }
             skip(")");
-            app = std::make_shared<Application>(token, app, argumentsOuter);
+            app = makeInArena<Application>(arena, token, app, argumentsOuter);
         }
         return app;
     }
@@ -360,17 +390,17 @@ Parser::parseApplication() {
 
 std::shared_ptr<Function>
 Parser::parseFunc() {
-    const std::string functionName = currentToken().text;
+    const std::string functionName(currentToken().text);
     Token token = currentToken();
     advance();
 
     std::vector<Types::GenTypePtr> genericTypes;
     if (match(Token::TokenType::DELIM, "[")) {
-        Types::GenTypePtr genericType = std::make_shared<Types::GenType>(currentToken().text);
+        Types::GenTypePtr genericType = makeInArena<Types::GenType>(arena, std::string(currentToken().text));
         advance();
         genericTypes.push_back(genericType);
         while (match(Token::TokenType::DELIM, ",")) {
-            Types::GenTypePtr genericType2 = std::make_shared<Types::GenType>(currentToken().text);
+            Types::GenTypePtr genericType2 = makeInArena<Types::GenType>(arena, std::string(currentToken().text));
             advance();
             genericTypes.push_back(genericType2);
         }
@@ -399,24 +429,24 @@ Parser::parseFunc() {
         functionArgumentNames.push_back(argumentType->name);
     }
 
-    Types::FuncTypePtr functionType = std::make_shared<Types::FuncType>(genericTypes, functionTypeArgumentTypes, functionReturnType);
+    Types::FuncTypePtr functionType = makeInArena<Types::FuncType>(arena, genericTypes, functionTypeArgumentTypes, functionReturnType);
 
     functionType->functionBody = functionBody;
     functionType->argumentNames = functionArgumentNames;
 	
     skip(";");
-    return std::make_shared<Function>(token, functionType, functionName, genericTypes, argumentTypes, functionBody);
+    return makeInArena<Function>(arena, token, functionType, functionName, genericTypes, argumentTypes, functionBody);
 }
 
 std::shared_ptr<Argument>
 Parser::parseArg(const std::vector<Types::GenTypePtr> & genericParameterList) {
-    const std::string argumentName = currentToken().text;
+    const std::string argumentName(currentToken().text);
     Token token = currentToken();
     advance();
     skip(":");
     Types::TypePtr argumentType = parseType(genericParameterList);
 
-    return std::make_shared<Argument>(token, argumentType, argumentName);
+    return makeInArena<Argument>(arena, token, argumentType, argumentName);
 }
 
 ExpPtr
@@ -428,72 +458,73 @@ Parser::parseAtom() {
     } else if (inBounds()) {
         if (currentToken().type == Token::TokenType::IDENT) {
             Token token = currentToken();
-            const std::string ident = currentToken().text;
+            const std::string ident(currentToken().text);
 		    advance();
 
             if (match(Token::TokenType::DELIM, ".")) {
-                const std::string fieldIdent = currentToken().text;
+                const std::string fieldIdent(currentToken().text);
                 advance();
-                return std::make_shared<Reference>(token, std::make_shared<Types::UnknownType>(), ident, fieldIdent);
+                return makeInArena<Reference>(arena, token, makeInArena<Types::UnknownType>(arena), ident, fieldIdent);
             }
             
-            return std::make_shared<Reference>(token, std::make_shared<Types::UnknownType>(), ident);
+            return makeInArena<Reference>(arena, token, makeInArena<Types::UnknownType>(arena), ident);
         } else {
             Token token = currentToken();
             if (matchNoAdvance(Token::TokenType::KEYWORD, "true") ||
                 matchNoAdvance(Token::TokenType::KEYWORD, "false")) {
-                std::shared_ptr<Literal> lit = std::make_shared<Literal>(currentToken(), std::make_shared<Types::BoolType>(), (currentToken().text == "true"));
+                std::shared_ptr<Literal> lit = makeInArena<Literal>(arena, currentToken(), Types::boolType(), (currentToken().text == "true"));
                 advance();
                 return lit;
             } else if (match(Token::TokenType::KEYWORD, "null")) {
-                return std::make_shared<Literal>(token);
-            } else if (isValue(currentToken().text)) {
-                std::shared_ptr<Literal> lit = std::make_shared<Literal>(currentToken(), std::make_shared<Types::IntType>(), std::stoi(currentToken().text));
+                return makeInArena<Literal>(arena, token);
+            } else if (isValue(std::string(currentToken().text))) {
+                std::shared_ptr<Literal> lit = makeInArena<Literal>(arena, currentToken(), Types::intType(), std::stoi(std::string(currentToken().text)));
                 advance();
                 return lit;
             } else if (match(Token::TokenType::DELIM, "'") && currentToken().text.length() <= 2) {
-                std::shared_ptr<Literal> lit = std::make_shared<Literal>(currentToken(), std::make_shared<Types::CharType>(), getEscapedCharacter(currentToken().text));
+                std::shared_ptr<Literal> lit = makeInArena<Literal>(arena, currentToken(), Types::charType(), getEscapedCharacter(std::string(currentToken().text)));
                 advance();
                 skip("'");
                 return lit;
             } else if (match(Token::TokenType::DELIM, "\"")) {
-                std::shared_ptr<Literal> lit = std::make_shared<Literal>(currentToken(), std::make_shared<Types::StringType>(), currentToken().text);
+                std::shared_ptr<Literal> lit = makeInArena<Literal>(arena, currentToken(), Types::stringType(), std::string(currentToken().text));
                 advance();
                 skip("\"");
                 return lit;
             } else {
-                printError(true, currentToken().text, "<literal>");
+                printError(true, std::string(currentToken().text), "<literal>");
             }
         }
     }
     
-	return Expression::End();
+	return Expression::End(arena);
 }
 
 Types::TypePtr
 Parser::parseType(const std::vector<Types::GenTypePtr> & genericParameterList) {
-    if (inBounds() && currentToken().type == Token::TokenType::KEYWORD && currentToken().text != "List" && currentToken().text != "Tuple") {
-		std::string typeString = currentToken().text;
+    if (inBounds() && currentToken().type == Token::TokenType::KEYWORD && currentToken().text != "List" && currentToken().text != "Tuple" &&
+        currentToken().text != "Set" && currentToken().text != "Map") {
+		std::string typeString(currentToken().text);
         
 		Types::TypePtr type;
-		if (typeString == "int") type = std::make_shared<Types::IntType>();
-		else if (typeString == "bool") type = std::make_shared<Types::BoolType>();
-		else if (typeString == "char") type = std::make_shared<Types::CharType>();
-        else if (typeString == "string") type = std::make_shared<Types::StringType>();
-		else if (typeString == "null") type = std::make_shared<Types::NullType>();
+		if (typeString == "int") type = Types::intType();
+		else if (typeString == "bool") type = Types::boolType();
+		else if (typeString == "char") type = Types::charType();
+        else if (typeString == "string") type = Types::stringType();
+		else if (typeString == "null") type = Types::nullType();
         else if (typeString == "type") {
             advance();
             typeString = currentToken().text;
-            type = std::make_shared<Types::TypeclassType>(typeString);
+            type = makeInArena<Types::TypeclassType>(arena, typeString);
         } else {
 			ERROR(std::string("Unexpected type: ") + typeString);
-			return std::make_shared<Types::UnknownType>();
+			return makeInArena<Types::UnknownType>(arena);
 		}
 		advance();
 		
 		if (match(Token::TokenType::DELIM, "->")) {
             std::vector<Types::TypePtr> functionTypeArgumentTypes{type};
-            return std::make_shared<Types::FuncType>(genericParameterList, functionTypeArgumentTypes, parseType(genericParameterList));
+            return makeInArena<Types::FuncType>(arena, genericParameterList, functionTypeArgumentTypes, parseType(genericParameterList));
 		}
 
 		return type;
@@ -501,7 +532,19 @@ Parser::parseType(const std::vector<Types::GenTypePtr> & genericParameterList) {
         skip("[");
         Types::TypePtr listDataType = parseType(genericParameterList);
         skip("]");
-        return std::make_shared<Types::ListType>(listDataType);
+        return Types::listOf(listDataType);
+    } else if (match(Token::TokenType::KEYWORD, "Set")) {
+        skip("[");
+        Types::TypePtr setDataType = parseType(genericParameterList);
+        skip("]");
+        return Types::setOf(setDataType);
+    } else if (match(Token::TokenType::KEYWORD, "Map")) {
+        skip("[");
+        Types::TypePtr keyType = parseType(genericParameterList);
+        skip(",");
+        Types::TypePtr valueType = parseType(genericParameterList);
+        skip("]");
+        return Types::mapOf(keyType, valueType);
     } else if (match(Token::TokenType::KEYWORD, "Tuple")) {
         skip("[");
         std::vector<Types::TypePtr> tupleTypes{parseType(genericParameterList)};
@@ -509,7 +552,7 @@ Parser::parseType(const std::vector<Types::GenTypePtr> & genericParameterList) {
 			tupleTypes.push_back(parseType(genericParameterList));	
 		}
 		skip("]");
-        return std::make_shared<Types::TupleType>(tupleTypes);
+        return Types::tupleOf(tupleTypes);
     } else if (match(Token::TokenType::DELIM, "(")) {
         std::vector<Types::TypePtr> functionArgumentTypes{parseType(genericParameterList)};
         while (match(Token::TokenType::DELIM, ",")) {
@@ -517,22 +560,22 @@ Parser::parseType(const std::vector<Types::GenTypePtr> & genericParameterList) {
 		}
 		skip(")");
 		skip("->");
-		return std::make_shared<Types::FuncType>(genericParameterList, functionArgumentTypes, parseType(genericParameterList));
+		return makeInArena<Types::FuncType>(arena, genericParameterList, functionArgumentTypes, parseType(genericParameterList));
     } else {
-        const std::string parameterName = currentToken().text;
+        const std::string parameterName(currentToken().text);
 		bool genericNameMatches = false;
 
 		Types::TypePtr type;
         if (std::any_of(genericParameterList.begin(), genericParameterList.end(), 
                         [&parameterName](const Types::GenTypePtr & genType) { return (genType->identifier == parameterName); })) {
-            type = std::make_shared<Types::GenType>(parameterName);
+            type = makeInArena<Types::GenType>(arena, parameterName);
 			genericNameMatches = true;
 			advance();
         }
 
 		if (!genericNameMatches) {
             ERROR(std::string("Undefined generic type: ") + parameterName);
-			return std::make_shared<Types::UnknownType>();
+			return makeInArena<Types::UnknownType>(arena);
 		}
 
 		return type;
@@ -559,15 +602,20 @@ Parser::matchNoAdvance(const Token::TokenType tokenType, const std::string & tex
 void
 Parser::skip(const std::string & text) {
     if (inBounds() && currentToken().text != text) {
-        printError(true, currentToken().text, text);
+        printError(true, std::string(currentToken().text), text);
     }
     advance();
 }
 
+// a func, or a memo func
+bool
+Parser::startsFunc() {
+    return matchNoAdvance(Token::TokenType::KEYWORD, "func") || matchNoAdvance(Token::TokenType::KEYWORD, "memo");
+}
+
 std::string
 Parser::dummy() {
-    static int dummy_count = 0;
-	return ("dummy$" + std::to_string(dummy_count++));
+	return ("dummy$" + std::to_string(dummyCount++));
 }
 
 bool
@@ -623,11 +671,23 @@ Parser::printError(bool useUnexpected, const std::string & errorString, const st
     std::string characterArrow = (useUnexpected) ? std::string(position.fileColumn - static_cast<int>(errorString.length()) - 1, ' ') + std::string("^") : std::string("");
 
     std::stringstream errorStream;
-    errorStream << "Line: " << position.fileLine - BuiltinDefinitions::builtinNumber()
+    errorStream << "Line: " << position.fileLine
                 << ", Column: " << position.fileColumn - 1 << std::endl
                 << unexpectedCharacterString << errorString << expectedString
                 << std::endl << std::endl
-                << position.currentLineText << std::endl
+                << position.currentLineText() << std::endl
                 << characterArrow;
     ERROR(errorStream.str());
+}
+
+void
+Parser::printImportError(const Token & importToken, const std::string & errorString) {
+    error = true;
+
+    std::stringstream errorStream;
+    errorStream << "Line: " << importToken.position.fileLine
+                << ", Column: " << importToken.position.fileColumn - 1 << std::endl
+                << errorString << std::endl << std::endl
+                << importToken.position.currentLineText() << std::endl;
+    ERROR(errorStream.str());
 }
\ No newline at end of file
@@ -8,7 +8,10 @@
 
 #include "../lexer/lexer.hpp"
 
+#include <algorithm>
+#include <filesystem>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -19,14 +22,19 @@ using namespace Expressions;
 class Parser {
     private:
         std::vector<Token> tokenStream;
+        ArenaPtr arena;
 
         unsigned int currentTokenIndex = 0;
         bool error = false;
+        int dummyCount = 0;
+
+        std::vector<std::string> importedFiles;
+        std::set<std::string> importedFileSet;
         
         // Token parsing/Tree making
         std::shared_ptr<Program> parseProgram();
         void preprocessImports();
-        std::vector<Token> parseImport(int tokenIndex);
+        void expandImports(const std::vector<Token> & fileTokens, std::vector<Token> & expandedStream, std::vector<std::string> & importChain);
         ExpPtr parseExpression();
         ExpPtr parseSimpleExpression();
         std::shared_ptr<Typeclass> parseTypeclass();
@@ -53,16 +61,19 @@ class Parser {
         bool match(const Token::TokenType tokenType, const std::string & text);
         bool matchNoAdvance(const Token::TokenType tokenType, const std::string & text);
         void skip(const std::string & text);
+        bool startsFunc();
 
         std::string dummy();
         bool isValue(const std::string & valueString);
         char getEscapedCharacter(const std::string & escapeSequence);
 
         void printError(bool useUnexpected, const std::string & errorString, const std::string & expected = "$");
+        void printImportError(const Token & importToken, const std::string & errorString);
 
     public:
-        explicit Parser(const std::vector<Token> & tokenStream);
+        Parser(const std::vector<Token> & tokenStream, const ArenaPtr & arena);
 
         ExpPtr makeTree();
         bool errorOccurred() const { return error; }
+        const std::vector<std::string> & getImportedFiles() const { return importedFiles; }
 };
\ No newline at end of file
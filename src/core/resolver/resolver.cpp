@@ -0,0 +1,285 @@
+#include "resolver.hpp"
+
+#include <algorithm>
+
+Resolver::Resolver(const ExpPtr & rootExpression)
+: rootExpression(rootExpression) { }
+
+void
+Resolver::resolve() {
+    HEADER("Resolving names");
+    pushScope();
+    resolve(rootExpression);
+
+    auto rootLayout = popScope();
+    if (rootExpression->expType == ExpressionTypes::PROG) {
+        static_cast<Program *>(rootExpression.get())->frameLayout = rootLayout;
+    }
+    // the type checker has already rejected names bound nowhere, so any left
+    // here are reported when they are read
+    forwardReferences.clear();
+    HEADER("Resolving names Done");
+}
+
+void
+Resolver::resolve(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG)
+        resolveProgram(expression);
+    else if (expression->expType == ExpressionTypes::PRIM)
+        resolvePrimitive(expression);
+    else if (expression->expType == ExpressionTypes::LET)
+        resolveLet(expression);
+    else if (expression->expType == ExpressionTypes::REF)
+        resolveReference(expression);
+    else if (expression->expType == ExpressionTypes::BRANCH)
+        resolveBranch(expression);
+    else if (expression->expType == ExpressionTypes::TYPECLASS)
+        resolveTypeclass(expression);
+    else if (expression->expType == ExpressionTypes::APP)
+        resolveApplication(expression);
+    else if (expression->expType == ExpressionTypes::LIST_DEF)
+        resolveListDefinition(expression);
+    else if (expression->expType == ExpressionTypes::TUPLE_DEF)
+        resolveTupleDefinition(expression);
+    else if (expression->expType == ExpressionTypes::MATCH)
+        resolveMatch(expression);
+    else if (expression->expType == ExpressionTypes::LIT)
+        resolveLiteral(expression);
+    // END binds and references nothing
+}
+
+void
+Resolver::resolveProgram(const ExpPtr & expression) {
+    auto program = static_cast<Program *>(expression.get());
+
+    // every function of a block is bound before any body runs
+    for (auto & function : program->functions) {
+        function->slot = bindName(function->name);
+        if (scopes.size() == 1 && BuiltinDefinitions::isBuiltin(function->name)) {
+            rootBuiltins.resize(std::max(rootBuiltins.size(), static_cast<std::size_t>(function->slot) + 1),
+                                BuiltinDefinitions::BuiltinEnums::BUILTINNUM);
+            rootBuiltins[function->slot] = BuiltinDefinitions::getBuiltin(function->name);
+        }
+    }
+
+    for (auto & function : program->functions) {
+        resolveFunction(function);
+    }
+
+    resolve(program->body);
+}
+
+void
+Resolver::resolveFunction(const std::shared_ptr<Function> & function) {
+    pushScope();
+
+    // parameters always occupy the leading slots of the frame
+    for (auto & parameter : function->parameters) {
+        parameter->slot = bindName(parameter->name);
+    }
+
+    resolve(function->functionBody);
+    markTailCalls(function->functionBody);
+
+    function->frameLayout = popScope();
+}
+
+// Literals of the same string all give one value, made here once rather
+// than on every evaluation
+void
+Resolver::resolveLiteral(const ExpPtr & expression) {
+    auto literal = static_cast<Literal *>(expression.get());
+    if (literal->returnType->dataType != Types::DataTypes::STRING || !std::holds_alternative<std::string>(literal->data)) {
+        return;
+    }
+
+    const auto & text = std::get<std::string>(literal->data);
+    auto interned = internedStrings.find(text);
+    if (interned == internedStrings.end()) {
+        interned = internedStrings.emplace(text, std::make_shared<Values::StringValue>(literal->returnType, text)).first;
+    }
+    literal->stringValue = interned->second;
+}
+
+void
+Resolver::resolvePrimitive(const ExpPtr & expression) {
+    auto primitive = static_cast<Primitive *>(expression.get());
+    resolve(primitive->leftSide);
+    resolve(primitive->rightSide);
+}
+
+void
+Resolver::resolveLet(const ExpPtr & expression) {
+    auto let = static_cast<Let *>(expression.get());
+    auto visibleCount = scopes.back().visibleNames.size();
+
+    resolve(let->value);
+    let->slot = bindName(let->ident);
+    resolve(let->afterLet);
+
+    scopes.back().visibleNames.resize(visibleCount);
+}
+
+void
+Resolver::resolveReference(const ExpPtr & expression) {
+    auto reference = static_cast<Reference *>(expression.get());
+
+    if (reference->ident != std::string("$any")) {
+        placeName(reference->address, reference->ident);
+    }
+}
+
+void
+Resolver::resolveBranch(const ExpPtr & expression) {
+    auto branch = static_cast<Branch *>(expression.get());
+    resolve(branch->condition);
+    resolve(branch->ifBranch);
+    resolve(branch->elseBranch);
+}
+
+void
+Resolver::resolveTypeclass(const ExpPtr & expression) {
+    auto typeclass = static_cast<Typeclass *>(expression.get());
+    typeclass->slot = bindName(typeclass->ident);
+}
+
+void
+Resolver::resolveApplication(const ExpPtr & expression) {
+    auto application = static_cast<Application *>(expression.get());
+
+    resolve(application->ident);
+    for (auto & argument : application->arguments) {
+        resolve(argument);
+    }
+
+    application->pipeline = Pipeline::build(*application, [this](const Reference & reference) {
+        return builtinAt(reference.address);
+    });
+}
+
+void
+Resolver::resolveListDefinition(const ExpPtr & expression) {
+    auto listDefinition = static_cast<ListDefinition *>(expression.get());
+
+    for (auto & value : listDefinition->values) {
+        resolve(value);
+    }
+}
+
+void
+Resolver::resolveTupleDefinition(const ExpPtr & expression) {
+    auto tupleDefinition = static_cast<TupleDefinition *>(expression.get());
+
+    for (auto & value : tupleDefinition->values) {
+        resolve(value);
+    }
+}
+
+void
+Resolver::resolveMatch(const ExpPtr & expression) {
+    auto match = static_cast<Match *>(expression.get());
+    placeName(match->address, match->ident);
+
+    for (auto & casePtr : match->cases) {
+        resolve(casePtr->ident);
+        resolve(casePtr->body);
+    }
+
+    match->table = MatchTable::build(*match);
+}
+
+// Only follows the subexpressions whose value is returned as is
+void
+Resolver::markTailCalls(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG) {
+        markTailCalls(static_cast<Program *>(expression.get())->body);
+    } else if (expression->expType == ExpressionTypes::LET) {
+        markTailCalls(static_cast<Let *>(expression.get())->afterLet);
+    } else if (expression->expType == ExpressionTypes::BRANCH) {
+        auto branch = static_cast<Branch *>(expression.get());
+        markTailCalls(branch->ifBranch);
+        markTailCalls(branch->elseBranch);
+    } else if (expression->expType == ExpressionTypes::MATCH) {
+        for (auto & casePtr : static_cast<Match *>(expression.get())->cases) {
+            markTailCalls(casePtr->body);
+        }
+    } else if (expression->expType == ExpressionTypes::APP) {
+        static_cast<Application *>(expression.get())->isTailCall = true;
+    }
+}
+
+void
+Resolver::pushScope() {
+    scopes.emplace_back();
+}
+
+FrameLayout
+Resolver::popScope() {
+    int closedScope = static_cast<int>(scopes.size()) - 1;
+    for (auto & forwardReference : forwardReferences) {
+        forwardReference.outermostOpenScope = std::min(forwardReference.outermostOpenScope, closedScope - 1);
+    }
+
+    auto layout = scopes.back().layout;
+    scopes.pop_back();
+    return layout;
+}
+
+int
+Resolver::bindName(const std::string & name) {
+    auto & scope = scopes.back();
+    int scopeIndex = static_cast<int>(scopes.size()) - 1;
+    int slot = static_cast<int>(scope.layout->size());
+
+    scope.layout->push_back(name);
+    scope.visibleNames.push_back(std::make_pair(name, slot));
+
+    // places the earlier uses of the name within this scope
+    auto placed = std::remove_if(forwardReferences.begin(), forwardReferences.end(),
+                                 [&](const ForwardReference & forwardReference) {
+        if (forwardReference.name != name || forwardReference.outermostOpenScope < scopeIndex) {
+            return false;
+        }
+        forwardReference.address->depth = forwardReference.useScope - scopeIndex;
+        forwardReference.address->slot = slot;
+        return true;
+    });
+    forwardReferences.erase(placed, forwardReferences.end());
+    return slot;
+}
+
+// the name's address if it is bound already, else placed by bindName once it is
+void
+Resolver::placeName(Address & address, const std::string & name) {
+    address = findName(name);
+    if (address.depth < 0) {
+        int useScope = static_cast<int>(scopes.size()) - 1;
+        forwardReferences.push_back(ForwardReference{&address, name, useScope, useScope});
+    }
+}
+
+Address
+Resolver::findName(const std::string & name) const {
+    Address address;
+    for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+        for (auto visibleName = scope->visibleNames.rbegin(); visibleName != scope->visibleNames.rend(); ++visibleName) {
+            if (visibleName->first == name) {
+                address.depth = static_cast<int>(std::distance(scopes.rbegin(), scope));
+                address.slot = visibleName->second;
+                return address;
+            }
+        }
+    }
+    return address;
+}
+
+// the builtin bound at address, BUILTINNUM if a name of the program's own
+// is bound there instead
+BuiltinDefinitions::BuiltinEnums
+Resolver::builtinAt(const Address & address) const {
+    bool rootSlot = (address.depth == static_cast<int>(scopes.size()) - 1);
+    if (!rootSlot || address.slot < 0 || address.slot >= static_cast<int>(rootBuiltins.size())) {
+        return BuiltinDefinitions::BuiltinEnums::BUILTINNUM;
+    }
+    return rootBuiltins[address.slot];
+}
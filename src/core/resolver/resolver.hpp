@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../../utils/logger.hpp"
+#include "../../defs/expressions.hpp"
+#include "../../defs/values.hpp"
+#include "../interpreter/matchTable.hpp"
+#include "../interpreter/pipeline.hpp"
+#include "../builtin/builtinDefinitions.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Expressions;
+
+class Resolver {
+    private:
+        class Scope {
+            public:
+                FrameLayout layout;
+                std::vector<std::pair<std::string, int>> visibleNames;
+
+                Scope()
+                : layout(std::make_shared<std::vector<std::string>>()) { }
+        };
+
+        // A reference to a name not bound yet where it is used, such as a
+        // function calling one declared in a later block. It is placed once
+        // the name is bound in a scope enclosing its use.
+        class ForwardReference {
+            public:
+                Address * address;
+                std::string name;
+                int useScope; // index in scopes of the scope it is used in
+                int outermostOpenScope; // scopes above this one have closed since
+        };
+
+        ExpPtr rootExpression;
+        std::vector<Scope> scopes;
+        std::vector<BuiltinDefinitions::BuiltinEnums> rootBuiltins; // of each root slot, BUILTINNUM if not a builtin
+        std::unordered_map<std::string, Values::StringValuePtr> internedStrings;
+        std::vector<ForwardReference> forwardReferences;
+
+        void resolve(const ExpPtr & expression);
+
+        void resolveProgram(const ExpPtr & expression);
+        void resolveFunction(const std::shared_ptr<Function> & function);
+        void resolvePrimitive(const ExpPtr & expression);
+        void resolveLet(const ExpPtr & expression);
+        void resolveReference(const ExpPtr & expression);
+        void resolveBranch(const ExpPtr & expression);
+        void resolveTypeclass(const ExpPtr & expression);
+        void resolveApplication(const ExpPtr & expression);
+        void resolveListDefinition(const ExpPtr & expression);
+        void resolveTupleDefinition(const ExpPtr & expression);
+        void resolveMatch(const ExpPtr & expression);
+        void resolveLiteral(const ExpPtr & expression);
+
+        void markTailCalls(const ExpPtr & expression);
+
+        void pushScope();
+        FrameLayout popScope();
+
+        int bindName(const std::string & name);
+        void placeName(Address & address, const std::string & name);
+        Address findName(const std::string & name) const;
+        BuiltinDefinitions::BuiltinEnums builtinAt(const Address & address) const;
+
+    public:
+        explicit Resolver(const ExpPtr & rootExpression);
+
+        void resolve();
+};
@@ -0,0 +1,356 @@
+#include "bantRuntime.hpp"
+
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../typeChecker/typeChecker.hpp"
+#include "../cpsConverter/cpsConverter.hpp"
+#include "../optimizer/optimizer.hpp"
+#include "../resolver/resolver.hpp"
+#include "../compiler/compiler.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../vm/virtualMachine.hpp"
+#include "../builtin/prelude.hpp"
+#include "../cache/chunkCache.hpp"
+#include "../../utils/allocationCounter.hpp"
+#include "../../utils/output.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+#include <sys/resource.h>
+
+BantRuntime::BantRuntime(const RunOptions & options)
+: options(options) {
+    if (options.debug) {
+        logger.setLevel(DEBUG);
+    }
+}
+
+bool
+BantRuntime::run(const std::string & sourceStream) {
+    Logger::Scope loggerScope(logger);
+    error = false;
+    phaseTimes.clear();
+    runProgram(sourceStream);
+    if (options.phaseTimes) {
+        writePhaseTimes();
+    }
+    return !error;
+}
+
+ExpPtr
+BantRuntime::buildTree(const std::string & sourceStream, const ArenaPtr & arena, int & phase, std::vector<std::string> & importedFiles) {
+    startPhase();
+    auto lexer = Lexer(sourceStream, arena->sources());
+    auto tokenStream = lexer.makeTokenStream();
+    endPhase("lex");
+
+    if (lexer.errorOccurred()) {
+        fail("One or more errors occurred during lexing, exiting");
+        return nullptr;
+    }
+
+    phase++;
+
+    // imported files are lexed as they are parsed, so their lexing counts
+    // here, as does parsing the builtins' signatures into the prelude
+    startPhase();
+    auto parser = Parser(tokenStream, arena);
+    auto tree = parser.makeTree();
+    importedFiles = parser.getImportedFiles();
+
+    if (parser.errorOccurred()) {
+        fail("One or more errors occurred during parsing, exiting");
+        return nullptr;
+    }
+
+    if (options.runWithBuiltins) {
+        Prelude::seed(tree, arena);
+    }
+    endPhase("parse");
+
+    phase++;
+
+    startPhase();
+    auto typeChecker = TypeChecker(tree, arena);
+    typeChecker.check();
+    endPhase("typecheck");
+
+    if (typeChecker.errorOccurred()) {
+        fail("One or more errors occurred during type checking, exiting");
+        return nullptr;
+    }
+
+    if (options.runWithCPSPhase || options.optimizationLevel > 0) {
+        startPhase();
+        auto cpsConverter = CPSConverter(tree, arena);
+        cpsConverter.convert();
+        endPhase("cps");
+    }
+
+    if (options.optimizationLevel > 0) {
+        startPhase();
+        auto optimizer = Optimizer(tree, arena, options.optimizationLevel);
+        optimizer.optimize();
+        endPhase("optimize");
+    }
+
+    startPhase();
+    auto resolver = Resolver(tree);
+    resolver.resolve();
+    endPhase("resolve");
+
+    return tree;
+}
+
+void
+BantRuntime::runProgram(const std::string & sourceStream) {
+    int phase = 0;
+    // started just before the program runs, so building it is not counted
+    std::optional<Profiler> profiler;
+    // the collections made before the program runs, when reporting memory
+    std::optional<Collector::Stats> startStats;
+    try {
+        HEADER("Building...");
+
+        auto builtProgram = findBuiltProgram(sourceStream);
+        if (builtProgram) {
+            HEADER("Reusing built program");
+        }
+
+        if (options.runWithVM) {
+            Bytecode::ChunkPtr chunk = (builtProgram) ? builtProgram->chunk : nullptr;
+
+            if (!chunk) {
+                // owns the nodes of the tree, freed with the last of them
+                auto arena = std::make_shared<Arena>();
+
+                // a cached chunk stands in for every phase up to running it
+                auto chunkCache = ChunkCache(sourceStream, options.buildKey());
+                chunk = (options.useCache) ? chunkCache.load(arena) : nullptr;
+                std::vector<std::string> importedFiles = chunkCache.getImportedFiles();
+
+                if (!chunk) {
+                    auto tree = buildTree(sourceStream, arena, phase, importedFiles);
+                    if (!tree) {
+                        return;
+                    }
+
+                    startPhase();
+                    auto compiler = Compiler(tree);
+                    chunk = compiler.compile();
+                    endPhase("compile");
+                    chunkCache.store(chunk, importedFiles);
+                }
+                chunk->arena = arena;
+                keepBuiltProgram(sourceStream, nullptr, chunk, importedFiles);
+            }
+
+            HEADER("Successful Build, Running...");
+
+            phase = 3;
+
+            auto virtualMachine = VirtualMachine(chunk);
+            if (options.profile) {
+                virtualMachine.setProfiler(&profiler.emplace());
+            }
+            if (options.memStats) {
+                startStats = Collector::stats();
+                AllocationCounter::resetPeakLiveBytes();
+            }
+            startPhase();
+            virtualMachine.run();
+            endPhase("run");
+            if (profiler) {
+                writeProfile(*profiler);
+            }
+            writeMemoryStats(startStats);
+
+            if (virtualMachine.errorOccurred()) {
+                fail("One or more errors occurred at runtime, exiting");
+                return;
+            }
+            return;
+        }
+
+        auto tree = (builtProgram) ? builtProgram->tree : nullptr;
+        if (!tree) {
+            auto arena = std::make_shared<Arena>();
+            std::vector<std::string> importedFiles;
+            tree = buildTree(sourceStream, arena, phase, importedFiles);
+            if (!tree) {
+                return;
+            }
+            keepBuiltProgram(sourceStream, tree, nullptr, importedFiles);
+        }
+
+        HEADER("Successful Build, Running...");
+
+        phase = 3;
+
+        auto interpreter = Interpreter(tree);
+        if (options.profile) {
+            interpreter.setProfiler(&profiler.emplace());
+        }
+        if (options.memStats) {
+            startStats = Collector::stats();
+            AllocationCounter::resetPeakLiveBytes();
+        }
+        startPhase();
+        interpreter.run();
+        endPhase("run");
+        if (profiler) {
+            writeProfile(*profiler);
+        }
+        writeMemoryStats(startStats);
+
+        if (interpreter.errorOccurred()) {
+            fail("One or more errors occurred at runtime, exiting");
+            return;
+        }
+    } catch (HaltException & haltException) {
+        Output::flush();
+        if (profiler) {
+            writeProfile(*profiler);
+        }
+        writeMemoryStats(startStats);
+        return;
+    } catch (RuntimeException & runtimeException) {
+        if (profiler) {
+            writeProfile(*profiler);
+        }
+        writeMemoryStats(startStats);
+        fail("Exiting.");
+        return;
+    } catch (std::runtime_error & runtimeError) {
+        displayExceptionError(phase);
+    } catch (std::logic_error & logicError) {
+        displayExceptionError(phase);
+    }
+}
+
+// flat report on stderr, leaving the program's own output alone
+void
+BantRuntime::writeProfile(Profiler & profiler) {
+    profiler.finish();
+    Output::flush();
+    profiler.writeReport(std::cerr);
+
+    std::ofstream stacksFile(options.profilePath);
+    if (!stacksFile.is_open()) {
+        ERROR(std::string("Error: Could not write profile: ") + options.profilePath);
+        return;
+    }
+    profiler.writeCollapsedStacks(stacksFile);
+}
+
+// on stderr as the profile is; what is still live once the run has
+// returned is what its last frame did not free
+void
+BantRuntime::writeMemoryStats(const std::optional<Collector::Stats> & startStats) {
+    if (!startStats) {
+        return;
+    }
+
+    auto stats = Collector::stats();
+    Output::flush();
+    std::cerr << "live objects:      " << Values::LiveCounts::objects.load() << '\n'
+              << "live frames:       " << Values::LiveCounts::frames.load() << '\n'
+              << "peak bytes:        " << AllocationCounter::peakLiveBytes() << '\n'
+              << "collections:       " << stats.collections - startStats->collections << '\n'
+              << "reclaimed frames:  " << stats.reclaimedFrames - startStats->reclaimedFrames << '\n';
+}
+
+// "<phase> <milliseconds>" a line, then the peak resident set of the
+// process so far, on stderr; a phase left by an error is not listed
+void
+BantRuntime::writePhaseTimes() {
+    Output::flush();
+    std::cerr << std::fixed << std::setprecision(3);
+    for (const auto & phaseTime : phaseTimes) {
+        std::cerr << "phase " << phaseTime.first << ' '
+                  << std::chrono::duration<double, std::milli>(phaseTime.second).count() << '\n';
+    }
+    std::cerr << std::defaultfloat;
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        // kilobytes on Linux, bytes on macOS
+#if defined(__APPLE__)
+        std::cerr << "peak_rss_kb " << usage.ru_maxrss / 1024 << '\n';
+#else
+        std::cerr << "peak_rss_kb " << usage.ru_maxrss << '\n';
+#endif
+    }
+}
+
+const BantRuntime::BuiltProgram *
+BantRuntime::findBuiltProgram(const std::string & sourceStream) {
+    auto builtProgram = builtPrograms.find(sourceStream);
+    if (builtProgram == builtPrograms.end()) {
+        return nullptr;
+    }
+
+    for (const auto & importedFile : builtProgram->second.importedFiles) {
+        uint64_t fileHash = 0;
+        if (!ChunkCache::hashFile(importedFile.first, fileHash) || fileHash != importedFile.second) {
+            HEADER(std::string("Built program out of date: ") + importedFile.first + std::string(" changed"));
+            builtOrder.erase(std::find(builtOrder.begin(), builtOrder.end(), sourceStream));
+            builtPrograms.erase(builtProgram);
+            return nullptr;
+        }
+    }
+    return &builtProgram->second;
+}
+
+void
+BantRuntime::keepBuiltProgram(const std::string & sourceStream, const ExpPtr & tree, const Bytecode::ChunkPtr & chunk, const std::vector<std::string> & importedFiles) {
+    if (builtPrograms.size() >= MAX_BUILT_PROGRAMS) {
+        builtPrograms.erase(builtOrder.front());
+        builtOrder.pop_front();
+    }
+
+    BuiltProgram builtProgram;
+    builtProgram.tree = tree;
+    builtProgram.chunk = chunk;
+    for (const auto & importedFile : importedFiles) {
+        uint64_t fileHash = 0;
+        ChunkCache::hashFile(importedFile, fileHash);
+        builtProgram.importedFiles.emplace_back(importedFile, fileHash);
+    }
+
+    builtPrograms[sourceStream] = std::move(builtProgram);
+    builtOrder.push_back(sourceStream);
+}
+
+void
+BantRuntime::fail(const std::string & errorMessage) {
+    error = true;
+    ERROR(errorMessage);
+}
+
+void
+BantRuntime::displayExceptionError(const int & phase) {
+    std::string errorExitMessage = "Unexpected error occurred";
+    switch (phase) {
+        case 0:
+            errorExitMessage += std::string(" during lexing");
+            break;
+        case 1:
+            errorExitMessage += std::string(" during parsing");
+            break;
+        case 2:
+            errorExitMessage += std::string(" during type checking");
+            break;
+        case 3:
+            errorExitMessage += std::string(" during interpretation");
+            break;
+        default:
+            break;
+    }
+    errorExitMessage += std::string(", exiting");
+
+    fail(errorExitMessage);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../../defs/expressions.hpp"
+#include "../../utils/arena.hpp"
+#include "../../utils/logger.hpp"
+#include "../compiler/bytecode.hpp"
+#include "collector.hpp"
+#include "profiler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Flags that pick the phases a run goes through
+class RunOptions {
+    public:
+        bool debug = false;
+        bool runWithBuiltins = true;
+        bool runWithCPSPhase = false;
+        int optimizationLevel = 0;
+        bool runWithVM = false;
+        bool useCache = true;
+        bool profile = false;
+        std::string profilePath = "profile.folded"; // collapsed stacks, written after each profiled run
+        bool memStats = false; // needs the live counts turned on before anything is allocated
+        bool phaseTimes = false;
+
+        // the options that change the compiled program, part of its cache key
+        std::string buildKey() const {
+            return std::string("builtins=") + std::to_string(runWithBuiltins) +
+                   std::string(" cps=") + std::to_string(runWithCPSPhase) +
+                   std::string(" O=") + std::to_string(optimizationLevel);
+        }
+};
+
+// Builds and runs Bant programs. Every phase, and the interpreter or VM a
+// program runs on, belongs to the run, so runtimes on separate threads can
+// each run a program at the same time. What they share is guarded where it
+// lives: interned types, the bytecode cache on disk, and the thread pool of
+// the parallel builtins. Source text belongs to the program built from it.
+//
+// A runtime keeps the programs it has built, so running the same source
+// again, as -serve and -batch do, goes straight to the interpreter or VM.
+// Each run still starts from a fresh root frame: nothing a program
+// computes is seen by the next one.
+class BantRuntime {
+    private:
+        // A checked tree, or compiled chunk when running on the VM. Neither
+        // is changed by running it, so one is shared by every later run of
+        // its source for as long as the files it imports are unchanged.
+        class BuiltProgram {
+            public:
+                Expressions::ExpPtr tree;
+                Bytecode::ChunkPtr chunk;
+                std::vector<std::pair<std::string, uint64_t>> importedFiles;
+        };
+
+        static constexpr std::size_t MAX_BUILT_PROGRAMS = 64;
+
+        RunOptions options;
+        Logger logger;
+        bool error = false;
+
+        using Clock = std::chrono::steady_clock;
+        // of the phases the last run went through, in order, for -phase-times
+        std::vector<std::pair<std::string_view, Clock::duration>> phaseTimes;
+        Clock::time_point phaseStart;
+
+        std::unordered_map<std::string, BuiltProgram> builtPrograms;
+        std::deque<std::string> builtOrder; // oldest first, dropped once full
+
+        Expressions::ExpPtr buildTree(const std::string & sourceStream, const ArenaPtr & arena, int & phase, std::vector<std::string> & importedFiles);
+        void runProgram(const std::string & sourceStream);
+        void writeProfile(Profiler & profiler);
+        void writeMemoryStats(const std::optional<Collector::Stats> & startStats);
+        void startPhase() { phaseStart = Clock::now(); }
+        void endPhase(const std::string_view & name) { phaseTimes.emplace_back(name, Clock::now() - phaseStart); }
+        void writePhaseTimes();
+
+        const BuiltProgram * findBuiltProgram(const std::string & sourceStream);
+        void keepBuiltProgram(const std::string & sourceStream, const Expressions::ExpPtr & tree, const Bytecode::ChunkPtr & chunk, const std::vector<std::string> & importedFiles);
+        void fail(const std::string & errorMessage);
+        void displayExceptionError(const int & phase);
+
+    public:
+        explicit BantRuntime(const RunOptions & options);
+
+        // false if the program did not build or stopped on an error
+        bool run(const std::string & sourceStream);
+        bool errorOccurred() const { return error; }
+};
@@ -0,0 +1,305 @@
+#include "collector.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+    // a collection starts once twice as many frames are tracked as
+    // survived the last one, and at least this many
+    constexpr std::size_t MIN_TRACKED_FRAMES = 1024;
+
+    class TrackedFrames {
+        public:
+            std::vector<Collector::TrackedFrame> frames;
+            std::size_t nextCollection = MIN_TRACKED_FRAMES;
+            Collector::Stats stats;
+    };
+
+    thread_local TrackedFrames trackedFrames;
+    // the section of the range the thread is running, if any
+    thread_local Collector::ParallelSection * currentSection = nullptr;
+
+    // What the tracked frames reach, read without taking a reference to
+    // any of it, so that the use counts stay as they were
+    class Graph {
+        public:
+            class Node {
+                public:
+                    Values::Frame * frame = nullptr; // or else object
+                    Values::Object * object = nullptr;
+                    long useCount = 0;
+                    long internalReferences = 0;
+                    bool reached = false;
+
+                    // for a frame, what owns it: a reference to it found
+                    // on the way, or else the tracked frame it is
+                    const Values::Environment * owner = nullptr;
+                    int trackedIndex = -1;
+
+                    // of edges, those from this node
+                    std::size_t firstEdge = 0;
+                    std::size_t edgeCount = 0;
+            };
+
+            std::vector<Node> nodes;
+
+            explicit Graph(const std::size_t trackedCount) {
+                nodes.reserve(trackedCount * 2);
+                indices.reserve(trackedCount * 4);
+            }
+
+            void addTracked(const int trackedIndex) {
+                const auto & tracked = trackedFrames.frames[trackedIndex];
+                auto index = nodeOf(tracked.first, tracked.second.use_count());
+                if (nodes[index].trackedIndex < 0) {
+                    nodes[index].trackedIndex = trackedIndex;
+                }
+            }
+
+            // adds the nodes reachable from those added so far
+            void expand() {
+                while (!pending.empty()) {
+                    auto index = pending.back();
+                    pending.pop_back();
+                    // a node's edges are all added before the next node's
+                    nodes[index].firstEdge = edges.size();
+
+                    if (nodes[index].frame) {
+                        const auto frame = nodes[index].frame;
+                        for (const auto & slot : frame->slots) {
+                            refer(slot);
+                        }
+                        refer(frame->parent);
+                    } else {
+                        referFrom(nodes[index].object);
+                    }
+
+                    while (!inlined.empty()) {
+                        auto object = inlined.back();
+                        inlined.pop_back();
+                        referFrom(object);
+                    }
+                    nodes[index].edgeCount = edges.size() - nodes[index].firstEdge;
+                }
+            }
+
+            // marks what is held from outside the graph, and all it reaches
+            void reach() {
+                for (std::size_t index = 0; index < nodes.size(); ++index) {
+                    if (nodes[index].useCount > nodes[index].internalReferences) {
+                        pending.push_back(index);
+                    }
+                }
+
+                while (!pending.empty()) {
+                    auto index = pending.back();
+                    pending.pop_back();
+                    if (nodes[index].reached) {
+                        continue;
+                    }
+                    nodes[index].reached = true;
+                    for (auto edge = nodes[index].firstEdge; edge < nodes[index].firstEdge + nodes[index].edgeCount; ++edge) {
+                        if (!nodes[edges[edge]].reached) {
+                            pending.push_back(edges[edge]);
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::unordered_map<const void *, std::size_t> indices;
+            std::vector<std::size_t> pending;
+            std::vector<std::size_t> edges;
+            // held by nothing but the node being expanded, so taken as part of it
+            std::vector<Values::Object *> inlined;
+
+            std::size_t nodeOf(Values::Frame * frame, const long useCount) {
+                auto found = indices.find(frame);
+                if (found != indices.end()) {
+                    return found->second;
+                }
+
+                Node node;
+                node.frame = frame;
+                node.useCount = useCount;
+                return add(frame, node);
+            }
+
+            std::size_t add(const void * address, Node & node) {
+                auto index = nodes.size();
+                indices.emplace(address, index);
+                nodes.push_back(std::move(node));
+                pending.push_back(index);
+                return index;
+            }
+
+            void referFrom(Values::Object * object) {
+                switch (object->type->dataType) {
+                    case Types::DataTypes::FUNC:
+                        refer(static_cast<Values::FunctionValue *>(object)->functionBodyEnvironment);
+                        break;
+                    case Types::DataTypes::TUPLE:
+                        for (const auto & element : static_cast<Values::TupleValue *>(object)->tupleData) {
+                            refer(element);
+                        }
+                        break;
+                    case Types::DataTypes::TYPECLASS:
+                        for (const auto & field : static_cast<Values::TypeclassValue *>(object)->fields) {
+                            refer(field);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            void refer(const Values::Environment & frame) {
+                if (!frame) {
+                    return;
+                }
+
+                auto index = nodeOf(frame.get(), frame.use_count());
+                if (!nodes[index].owner) {
+                    nodes[index].owner = &frame;
+                }
+                ++nodes[index].internalReferences;
+                edges.push_back(index);
+            }
+
+            void refer(const Values::Value & value) {
+                const auto & pointer = value.pointer();
+                if (!pointer) {
+                    return;
+                }
+
+                auto dataType = pointer->type->dataType;
+                if (dataType != Types::DataTypes::FUNC && dataType != Types::DataTypes::TUPLE &&
+                    dataType != Types::DataTypes::TYPECLASS) {
+                    return;
+                }
+
+                if (pointer.use_count() == 1) {
+                    inlined.push_back(pointer.get());
+                    return;
+                }
+
+                std::size_t index;
+                auto found = indices.find(pointer.get());
+                if (found != indices.end()) {
+                    index = found->second;
+                } else {
+                    Node node;
+                    node.object = pointer.get();
+                    node.useCount = pointer.use_count();
+                    index = add(pointer.get(), node);
+                }
+                ++nodes[index].internalReferences;
+                edges.push_back(index);
+            }
+    };
+
+    void
+    scheduleNextCollection() {
+        trackedFrames.nextCollection = std::max(MIN_TRACKED_FRAMES, trackedFrames.frames.size() * 2);
+    }
+
+    void
+    dropExpired() {
+        auto & frames = trackedFrames.frames;
+        frames.erase(std::remove_if(frames.begin(), frames.end(),
+                                    [](const Collector::TrackedFrame & tracked) {
+                                        return tracked.second.expired();
+                                    }),
+                     frames.end());
+    }
+}
+
+Collector::ParallelSection::Range::Range(ParallelSection & section)
+: outerSection(currentSection) {
+    currentSection = &section;
+}
+
+Collector::ParallelSection::Range::~Range() {
+    currentSection = outerSection;
+}
+
+Collector::ParallelSection::~ParallelSection() {
+    for (const auto & tracked : frames) {
+        auto frame = tracked.second.lock();
+        if (frame) {
+            Collector::track(frame);
+        }
+    }
+}
+
+void
+Collector::ParallelSection::track(const Values::Environment & frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    frames.emplace_back(frame.get(), frame);
+}
+
+void
+Collector::track(const Values::Environment & frame) {
+    if (currentSection) {
+        currentSection->track(frame);
+        return;
+    }
+
+    auto & frames = trackedFrames.frames;
+    // a function defining several closures makes them over the same frame
+    if (!frames.empty() && frames.back().first == frame.get() && !frames.back().second.expired()) {
+        return;
+    }
+
+    frames.emplace_back(frame.get(), frame);
+    if (frames.size() >= trackedFrames.nextCollection) {
+        collect();
+    }
+}
+
+void
+Collector::collect() {
+    if (currentSection) {
+        return;
+    }
+    dropExpired();
+
+    Graph graph(trackedFrames.frames.size());
+    for (std::size_t trackedIndex = 0; trackedIndex < trackedFrames.frames.size(); ++trackedIndex) {
+        graph.addTracked(static_cast<int>(trackedIndex));
+    }
+    graph.expand();
+    graph.reach();
+
+    // held before any is cleared, so none is freed while they are
+    std::vector<Values::Environment> garbage;
+    for (const auto & node : graph.nodes) {
+        if (node.frame && !node.reached) {
+            garbage.push_back((node.owner) ? *node.owner : trackedFrames.frames[node.trackedIndex].second.lock());
+        }
+    }
+
+    std::vector<TrackedFrame> survivors;
+    for (const auto & node : graph.nodes) {
+        if (node.frame && node.reached && node.trackedIndex >= 0) {
+            survivors.push_back(std::move(trackedFrames.frames[node.trackedIndex]));
+        }
+    }
+    trackedFrames.frames = std::move(survivors);
+
+    for (auto & frame : garbage) {
+        frame->clear();
+    }
+
+    ++trackedFrames.stats.collections;
+    trackedFrames.stats.reclaimedFrames += garbage.size();
+    scheduleNextCollection();
+}
+
+Collector::Stats
+Collector::stats() {
+    return trackedFrames.stats;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../../defs/values.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Reclaims the frames that only a cycle keeps alive. A closure holds the
+// frame it was made in, and that frame usually holds the closure, so
+// reference counting alone frees neither once the call that made them
+// returns.
+//
+// Every frame a closure is made over is tracked, and once enough are they
+// are collected by trial deletion over them and the frames, functions,
+// tuples and typeclasses they reach: the references each of those gets
+// from the others are taken off its use count, and one with references
+// left is held from outside, by a running call, the VM's stack or a list.
+// Whatever those reach stays. The rest of the frames are cleared, which
+// breaks their cycles and frees them. Lists, sets and maps are not looked
+// into, so what they hold is only ever kept alive by them.
+//
+// A collection only looks at the frames tracked by the thread running it,
+// which are those of one run. The frames closures are made over inside the
+// ranges of a parallel builtin are handed back to the thread that started
+// it once they are done, and no collection runs inside a range, since the
+// counts of what is shared with the other ranges change underneath it.
+class Collector {
+    public:
+        class Stats {
+            public:
+                std::size_t collections = 0;
+                std::size_t reclaimedFrames = 0;
+        };
+
+        using TrackedFrame = std::pair<Values::Frame *, std::weak_ptr<Values::Frame>>;
+
+        // Alive on the thread starting a parallel builtin while its ranges
+        // run, which take the frames they track to it
+        class ParallelSection {
+            private:
+                std::mutex mutex;
+                std::vector<TrackedFrame> frames;
+
+            public:
+                // alive while a thread runs one of the section's ranges
+                class Range {
+                    private:
+                        ParallelSection * outerSection;
+
+                    public:
+                        explicit Range(ParallelSection & section);
+                        ~Range();
+
+                        Range(const Range &) = delete;
+                        Range & operator=(const Range &) = delete;
+                };
+
+                ParallelSection() = default;
+                // tracks what the ranges did on the calling thread
+                ~ParallelSection();
+
+                ParallelSection(const ParallelSection &) = delete;
+                ParallelSection & operator=(const ParallelSection &) = delete;
+
+                void track(const Values::Environment & frame);
+        };
+
+        // called whenever a closure is made over frame
+        static void track(const Values::Environment & frame);
+        // collects now, unless in the range of a parallel builtin
+        static void collect();
+
+        // of the collections on the calling thread so far
+        static Stats stats();
+};
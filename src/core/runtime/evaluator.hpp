@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../../defs/token.hpp"
+#include "../../defs/values.hpp"
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+// Thrown once a runtime error has been reported, by the interpreter, the VM
+// or a builtin, to stop the program
+class RuntimeException : public std::exception {
+    public:
+        const char * what() const noexcept override {
+            return "RuntimeException";
+        }
+};
+
+// What a builtin sees of the interpreter or VM that called it: a way to
+// call back into the program, and to get one of its own for another thread.
+// Builtins are handed the evaluator running them rather than reaching for a
+// shared one, so programs running side by side never meet.
+class Evaluator {
+    public:
+        virtual ~Evaluator() = default;
+
+        virtual Values::Value applyFunction(const Token & token, const Values::FunctionValuePtr & functionValue, const std::vector<Values::Value> & arguments, Values::Environment & environment) = 0;
+
+        // evaluator of the same program for another thread, its stack trace
+        // starts with the calls made here so far
+        virtual std::unique_ptr<Evaluator> fork() const = 0;
+};
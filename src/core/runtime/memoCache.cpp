@@ -0,0 +1,50 @@
+#include "memoCache.hpp"
+
+#include <algorithm>
+
+std::size_t
+MemoCache::ArgumentsHash::operator()(const Arguments & arguments) const {
+    std::size_t seed = arguments.size();
+    for (const auto & argument : arguments) {
+        seed = Values::combineHashes(seed, Values::hashValue(argument));
+    }
+    return seed;
+}
+
+bool
+MemoCache::ArgumentsEqual::operator()(const Arguments & arguments1, const Arguments & arguments2) const {
+    return arguments1.size() == arguments2.size() &&
+           std::equal(arguments1.begin(), arguments1.end(), arguments2.begin(), Values::ValueEqual());
+}
+
+Values::Value
+MemoCache::find(const Arguments & arguments) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(arguments);
+    if (found == entries.end()) {
+        return Values::Value();
+    }
+
+    recentUses.splice(recentUses.begin(), recentUses, found->second.recentUse);
+    return found->second.result;
+}
+
+void
+MemoCache::store(const Arguments & arguments, const Values::Value & result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto inserted = entries.try_emplace(arguments);
+    if (!inserted.second) {
+        // another thread made the same call meanwhile
+        return;
+    }
+
+    recentUses.push_front(&inserted.first->first);
+    inserted.first->second = Entry{result, recentUses.begin()};
+
+    if (entries.size() > CAPACITY) {
+        // the key is copied, erasing the entry frees what it points to
+        Arguments oldest = *recentUses.back();
+        recentUses.pop_back();
+        entries.erase(oldest);
+    }
+}
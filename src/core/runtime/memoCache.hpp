@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../../defs/values.hpp"
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// The results of one memo func's calls, keyed by their arguments, which
+// are hashed and compared as the elements of a set are. Only the function
+// value made for the func holds it, so a memo func declared inside another
+// function starts with an empty cache on every call of that function.
+//
+// At most CAPACITY results are kept. Past that the one least recently
+// found or stored is dropped. The builtins that run calls in parallel can
+// reach the same cache from several threads, so every use is locked.
+class MemoCache {
+    public:
+        static constexpr std::size_t CAPACITY = 1 << 16;
+
+        using Arguments = std::vector<Values::Value>;
+
+    private:
+        class ArgumentsHash {
+            public:
+                std::size_t operator()(const Arguments & arguments) const;
+        };
+
+        class ArgumentsEqual {
+            public:
+                bool operator()(const Arguments & arguments1, const Arguments & arguments2) const;
+        };
+
+        class Entry {
+            public:
+                Values::Value result;
+                std::list<const Arguments *>::iterator recentUse;
+        };
+
+        std::mutex mutex;
+        std::unordered_map<Arguments, Entry, ArgumentsHash, ArgumentsEqual> entries;
+        // keys of entries, most recently used first
+        std::list<const Arguments *> recentUses;
+
+    public:
+        MemoCache() = default;
+
+        MemoCache(const MemoCache &) = delete;
+        MemoCache & operator=(const MemoCache &) = delete;
+
+        // the result stored for arguments, empty if there is none
+        Values::Value find(const Arguments & arguments);
+        void store(const Arguments & arguments, const Values::Value & result);
+};
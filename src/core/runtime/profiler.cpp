@@ -0,0 +1,142 @@
+#include "profiler.hpp"
+#include "../../utils/allocationCounter.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+    const std::string_view PROGRAM_NAME = "<program>";
+
+    double
+    toMilliseconds(const std::chrono::steady_clock::duration & duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+Profiler::Profiler() {
+    pathNodes.emplace_back(PROGRAM_NAME, -1);
+    frames.push_back(Frame{&functionStats[std::string(PROGRAM_NAME)], 0, Clock::now(),
+                           Clock::duration{0}, AllocationCounter::allocations(), AllocationCounter::allocatedBytes()});
+    frames.back().stats->calls = 1;
+    frames.back().stats->activeCalls = 1;
+}
+
+void
+Profiler::enter(const std::string_view & name, const bool isBuiltin) {
+    auto stats = functionStats.find(name);
+    if (stats == functionStats.end()) {
+        stats = functionStats.emplace(std::string(name), FunctionStats()).first;
+        stats->second.isBuiltin = isBuiltin;
+    }
+    ++stats->second.calls;
+    ++stats->second.activeCalls;
+
+    auto parentNode = frames.back().pathNode;
+    auto child = pathNodes[parentNode].children.find(name);
+    int pathNode;
+    if (child == pathNodes[parentNode].children.end()) {
+        pathNode = static_cast<int>(pathNodes.size());
+        pathNodes[parentNode].children.emplace(std::string(name), pathNode);
+        pathNodes.emplace_back(name, parentNode);
+    } else {
+        pathNode = child->second;
+    }
+
+    frames.push_back(Frame{&stats->second, pathNode, Clock::now(),
+                           Clock::duration{0}, AllocationCounter::allocations(), AllocationCounter::allocatedBytes()});
+}
+
+void
+Profiler::exit() {
+    // the root frame is only closed by finish
+    if (frames.size() > 1) {
+        closeFrame(Clock::now());
+    }
+}
+
+void
+Profiler::replace(const std::string_view & name) {
+    exit();
+    enter(name, false);
+}
+
+void
+Profiler::finish() {
+    auto now = Clock::now();
+    while (!frames.empty()) {
+        closeFrame(now);
+    }
+}
+
+void
+Profiler::closeFrame(const Clock::time_point & now) {
+    auto frame = frames.back();
+    frames.pop_back();
+
+    auto elapsed = now - frame.start;
+    auto allocations = AllocationCounter::allocations() - frame.startAllocations;
+    auto allocatedBytes = AllocationCounter::allocatedBytes() - frame.startAllocatedBytes;
+
+    auto & stats = *frame.stats;
+    stats.exclusiveTime += elapsed - frame.calleeTime;
+    stats.allocations += allocations - frame.calleeAllocations;
+    stats.allocatedBytes += allocatedBytes - frame.calleeAllocatedBytes;
+    if (--stats.activeCalls == 0) {
+        stats.inclusiveTime += elapsed;
+    }
+    pathNodes[frame.pathNode].exclusiveTime += elapsed - frame.calleeTime;
+
+    if (!frames.empty()) {
+        frames.back().calleeTime += elapsed;
+        frames.back().calleeAllocations += allocations;
+        frames.back().calleeAllocatedBytes += allocatedBytes;
+    }
+}
+
+// one line per function, the most exclusive time first
+void
+Profiler::writeReport(std::ostream & output) const {
+    std::vector<std::pair<std::string, const FunctionStats *>> rows;
+    for (const auto & stats : functionStats) {
+        rows.emplace_back(stats.first, &stats.second);
+    }
+    std::sort(rows.begin(), rows.end(),
+              [](const std::pair<std::string, const FunctionStats *> & row1, const std::pair<std::string, const FunctionStats *> & row2) {
+                  return row1.second->exclusiveTime > row2.second->exclusiveTime;
+              });
+
+    output << std::setw(10) << "calls" << std::setw(14) << "incl ms" << std::setw(14) << "excl ms"
+           << std::setw(12) << "allocs" << std::setw(14) << "bytes" << "  function" << '\n';
+    output << std::fixed << std::setprecision(3);
+    for (const auto & row : rows) {
+        const auto & stats = *row.second;
+        output << std::setw(10) << stats.calls
+               << std::setw(14) << toMilliseconds(stats.inclusiveTime)
+               << std::setw(14) << toMilliseconds(stats.exclusiveTime)
+               << std::setw(12) << stats.allocations
+               << std::setw(14) << stats.allocatedBytes
+               << "  " << row.first << ((stats.isBuiltin) ? " (builtin)" : "") << '\n';
+    }
+    output << std::defaultfloat;
+}
+
+// "<program>;caller;callee microseconds" for each path with time of its own
+void
+Profiler::writeCollapsedStacks(std::ostream & output) const {
+    for (unsigned int index = 0; index < pathNodes.size(); ++index) {
+        auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(pathNodes[index].exclusiveTime).count();
+        if (microseconds <= 0) {
+            continue;
+        }
+
+        std::vector<const std::string *> path;
+        for (int node = static_cast<int>(index); node >= 0; node = pathNodes[node].parent) {
+            path.push_back(&pathNodes[node].name);
+        }
+
+        for (auto name = path.rbegin(); name != path.rend(); ++name) {
+            output << ((name == path.rbegin()) ? "" : ";") << **name;
+        }
+        output << ' ' << microseconds << '\n';
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Records, for every function and builtin a program calls, how often it was
+// called, the time spent in it with and without its callees, and the heap
+// allocations it made itself. Times are also kept per call path, which is
+// what writeCollapsedStacks emits for flame graph tools.
+//
+// Only the thread running the program records. The work a parallel builtin
+// hands to other threads counts toward the builtin.
+class Profiler {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        class FunctionStats {
+            public:
+                bool isBuiltin = false;
+                std::size_t calls = 0;
+                Clock::duration inclusiveTime{0};
+                Clock::duration exclusiveTime{0};
+                std::size_t allocations = 0;
+                std::size_t allocatedBytes = 0;
+                int activeCalls = 0; // a recursive call's time is already in the outermost one
+        };
+
+        // one per distinct call path, children keyed by function name
+        class PathNode {
+            public:
+                std::string name;
+                int parent;
+                std::map<std::string, int, std::less<>> children;
+                Clock::duration exclusiveTime{0};
+
+                PathNode(const std::string_view & name, const int parent) : name(name), parent(parent) { }
+        };
+
+        class Frame {
+            public:
+                FunctionStats * stats;
+                int pathNode;
+                Clock::time_point start;
+                Clock::duration calleeTime{0};
+                std::size_t startAllocations;
+                std::size_t startAllocatedBytes;
+                std::size_t calleeAllocations = 0;
+                std::size_t calleeAllocatedBytes = 0;
+        };
+
+        std::map<std::string, FunctionStats, std::less<>> functionStats;
+        std::vector<PathNode> pathNodes;
+        std::vector<Frame> frames;
+
+        void closeFrame(const Clock::time_point & now);
+
+    public:
+        // starts timing the program itself, as the root of every call path
+        Profiler();
+
+        void enter(const std::string_view & name, const bool isBuiltin);
+        void exit();
+        // a tail call to name takes over the running function's frame
+        void replace(const std::string_view & name);
+
+        // closes any frames a runtime error or halt left open
+        void finish();
+
+        void writeReport(std::ostream & output) const;
+        void writeCollapsedStacks(std::ostream & output) const;
+};
@@ -1,18 +1,31 @@
 #include "typeChecker.hpp"
+#include "../optimizer/expressionUtils.hpp"
 
-TypeChecker::TypeChecker(const ExpPtr & rootExpression)
-: rootExpression(rootExpression) { }
+TypeChecker::TypeChecker(const ExpPtr & rootExpression, const ArenaPtr & arena)
+: rootExpression(rootExpression),
+  arena(arena) { }
 
 void
 TypeChecker::check() {
     HEADER("Type checking/inference");
-    Environment environment = std::make_shared<EnvironmentRaw>();
-    auto temp = std::make_shared<Temp>(rootExpression->token, std::make_shared<Types::UnknownType>());
+    Environment environment;
+    auto temp = makeInArena<Temp>(arena, rootExpression->token, makeInArena<Types::UnknownType>(arena));
     eval(rootExpression, environment, temp->returnType);
+
+    // the scopes refer back to the function types holding them, and nothing
+    // after type checking reads them
+    for (auto & functionType : scopedFunctionTypes) {
+        functionType->functionInnerEnvironment.clear();
+    }
+    scopedFunctionTypes.clear();
+
+    markPure(rootExpression);
+    pureNames.clear();
+    checkMemoFunctions(rootExpression);
     HEADER("Type checking/inference Done");
 
     HEADER("Typed AST");
-    if (Logger::getInstance().getLevel() == DEBUG) {
+    if (Logger::current().getLevel() == DEBUG) {
         PrettyPrint printer;
         printer.print(rootExpression);
     }
@@ -45,14 +58,14 @@ TypeChecker::eval(ExpPtr expression, Environment & environment, Types::TypePtr &
     else if (expression->expType == ExpressionTypes::END)
         return expression;
 
-    printError(expression->token, std::string("Unknown expression type: ") + expression->token.text);
+    printError(expression->token, std::string("Unknown expression type: ") + std::string(expression->token.text));
 
     return expression;
 }
 
 ExpPtr
 TypeChecker::evalProgram(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto program = std::static_pointer_cast<Program>(expression);
+    auto program = static_cast<Program *>(expression.get());
 
     for (auto & function : program->functions) {
         addName(environment, function->name, function->returnType);
@@ -66,15 +79,13 @@ TypeChecker::evalProgram(ExpPtr expression, Environment & environment, Types::Ty
         }
 
         Environment functionInnerEnvironment;
-        if (environment && !function->isBuiltin) {
-            functionInnerEnvironment = std::make_shared<EnvironmentRaw>(*environment);
-            functionInnerEnvironment->erase(function->name);
-        } else {
-            functionInnerEnvironment = std::make_shared<EnvironmentRaw>();
+        if (!function->isBuiltin) {
+            functionInnerEnvironment = environment;
+            functionInnerEnvironment.remove(function->name);
         }
 
         for (auto & genericParameter : function->genericParameters) {
-            if (functionInnerEnvironment->find(genericParameter->identifier) == functionInnerEnvironment->end()) {
+            if (!functionInnerEnvironment.find(genericParameter->identifier)) {
                 addName(functionInnerEnvironment, genericParameter->identifier, genericParameter);
             }
         }
@@ -82,14 +93,16 @@ TypeChecker::evalProgram(ExpPtr expression, Environment & environment, Types::Ty
         for (auto & parameter : function->parameters) {
             if (parameter->returnType->dataType == Types::DataTypes::GEN) {
                 auto genericType = std::static_pointer_cast<Types::GenType>(parameter->returnType);
-                auto realType = functionInnerEnvironment->find(genericType->identifier)->second;
+                auto realType = functionInnerEnvironment.find(genericType->identifier);
                 addName(functionInnerEnvironment, parameter->name, realType);
             } else {
                 addName(functionInnerEnvironment, parameter->name, parameter->returnType);
             }
         }
 
-        std::static_pointer_cast<Types::FuncType>(function->returnType)->functionInnerEnvironment = functionInnerEnvironment;
+        auto functionType = std::static_pointer_cast<Types::FuncType>(function->returnType);
+        functionType->functionInnerEnvironment = functionInnerEnvironment;
+        scopedFunctionTypes.push_back(functionType);
     }
 
     return eval(program->body, environment, expectedType);
@@ -97,18 +110,18 @@ TypeChecker::evalProgram(ExpPtr expression, Environment & environment, Types::Ty
 
 ExpPtr
 TypeChecker::evalLiteral(ExpPtr expression, const Environment & environment, Types::TypePtr & expectedType) {
-    auto literal = std::static_pointer_cast<Literal>(expression);
+    auto literal = static_cast<Literal *>(expression.get());
     
     if (!compare(literal->returnType, expectedType)) {
         printMismatchError(literal->token, literal->returnType, expectedType);
     }
     
-    return literal;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalPrimitive(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto primitive = std::static_pointer_cast<Primitive>(expression);
+    auto primitive = static_cast<Primitive *>(expression.get());
 
     // unary op:
     //  - NOT for bool only
@@ -121,30 +134,30 @@ TypeChecker::evalPrimitive(ExpPtr expression, Environment & environment, Types::
 
     if (Operator::isUnaryOperator(primitive->op)) {
         if (primitive->op == Operator::OperatorTypes::NOT) {
-            auto temp = std::make_shared<Temp>(primitive->token, std::make_shared<Types::BoolType>());
+            auto temp = makeInArena<Temp>(arena, primitive->token, Types::boolType());
             eval(primitive->rightSide, environment, temp->returnType);
-            primitive->returnType = std::make_shared<Types::BoolType>();
+            primitive->returnType = Types::boolType();
         } else if (primitive->op == Operator::OperatorTypes::PLUS ||
                    primitive->op == Operator::OperatorTypes::MINUS) {
-            auto temp = std::make_shared<Temp>(primitive->token, std::make_shared<Types::IntType>());
+            auto temp = makeInArena<Temp>(arena, primitive->token, Types::intType());
             eval(primitive->rightSide, environment, temp->returnType);
-            primitive->returnType = std::make_shared<Types::IntType>();
+            primitive->returnType = Types::intType();
         }
     } else if (Operator::isBinaryBooleanOperator(primitive->op) ||
                Operator::isArithmeticOperator(primitive->op)) {
         if (primitive->op == Operator::OperatorTypes::AND ||
             primitive->op == Operator::OperatorTypes::OR) {
-            auto temp = std::make_shared<Temp>(primitive->token, std::make_shared<Types::BoolType>());
+            auto temp = makeInArena<Temp>(arena, primitive->token, Types::boolType());
             eval(primitive->leftSide, environment, temp->returnType);
             eval(primitive->rightSide, environment, temp->returnType);
-            primitive->returnType = std::make_shared<Types::BoolType>();
+            primitive->returnType = Types::boolType();
         } else if (Operator::isArithmeticOperator(primitive->op)) {
-            auto temp = std::make_shared<Temp>(primitive->token, std::make_shared<Types::IntType>());
+            auto temp = makeInArena<Temp>(arena, primitive->token, Types::intType());
             eval(primitive->leftSide, environment, temp->returnType);
             eval(primitive->rightSide, environment, temp->returnType);
-            primitive->returnType = std::make_shared<Types::IntType>();
+            primitive->returnType = Types::intType();
         } else { // is comparison operator
-            auto temp = std::make_shared<Temp>(primitive->token, std::make_shared<Types::UnknownType>());
+            auto temp = makeInArena<Temp>(arena, primitive->token, makeInArena<Types::UnknownType>(arena));
             eval(primitive->leftSide, environment, temp->returnType);
 
             if (!Types::isPrimitiveType(primitive->leftSide->returnType)) {
@@ -152,27 +165,20 @@ TypeChecker::evalPrimitive(ExpPtr expression, Environment & environment, Types::
             }
 
             eval(primitive->rightSide, environment, temp->returnType);
-            primitive->returnType = std::make_shared<Types::BoolType>();
+            primitive->returnType = Types::boolType();
         }
     }
 
-    return primitive;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalLet(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto let = std::static_pointer_cast<Let>(expression);
+    auto let = static_cast<Let *>(expression.get());
     
     eval(let->value, environment, let->valueType);
 
-    Environment afterLetEnvironment;
-    if (environment) {
-        afterLetEnvironment = std::make_shared<EnvironmentRaw>(*environment);        
-    } else {
-        printError(let->token, "Error: Bad environment");
-        return let->afterLet;
-    }
-
+    Environment afterLetEnvironment = environment;
     addName(afterLetEnvironment, let->ident, let->valueType);
 
     return eval(let->afterLet, afterLetEnvironment, expectedType);
@@ -180,7 +186,7 @@ TypeChecker::evalLet(ExpPtr expression, Environment & environment, Types::TypePt
 
 ExpPtr
 TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto reference = std::static_pointer_cast<Reference>(expression);
+    auto reference = static_cast<Reference *>(expression.get());
 
     auto referenceType = getName(reference->token, environment, reference->ident);
     reference->returnType = referenceType;
@@ -193,7 +199,7 @@ TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::
             tupleIndex = std::stoi(reference->fieldIdent);
         } catch (...) {
             printError(reference->token, std::string("Error: Tuple requires valid index: ") + reference->fieldIdent);
-            return reference;
+            return expression;
         }
         
         Types::TypePtr tupleElementType;
@@ -201,7 +207,7 @@ TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::
             tupleElementType = tupleType->tupleTypes.at(tupleIndex);
         } catch (...) {
             printError(reference->token, std::string("Error: Index not in range of tuple: ") + std::to_string(tupleIndex));
-            return reference;
+            return expression;
         }
 
         if (!compare(tupleElementType, expectedType)) {
@@ -209,6 +215,7 @@ TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::
         }   
         
         reference->returnType = tupleElementType;
+        reference->fieldIndex = tupleIndex;
     } else if (referenceType->dataType == Types::DataTypes::TYPECLASS && !reference->fieldIdent.empty()) {
         auto typeclassIdent = std::static_pointer_cast<Types::TypeclassType>(referenceType)->ident;
         auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(getName(reference->token, environment, typeclassIdent));
@@ -219,13 +226,13 @@ TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::
                                                 return (fieldIdent == fieldType.first);
                                             });
 
-        Types::TypePtr fieldType = (fieldTypeIterator != typeclassType->fieldTypes.end()) ? (*fieldTypeIterator).second : std::make_shared<Types::UnknownType>();
+        Types::TypePtr fieldType = (fieldTypeIterator != typeclassType->fieldTypes.end()) ? (*fieldTypeIterator).second : makeInArena<Types::UnknownType>(arena);
 
         if (fieldType->dataType == Types::DataTypes::UNKNOWN) {
             printError(reference->token, std::string("Error: typeclass ") +
                        typeclassType->ident + std::string(" has no field ") +
                        reference->fieldIdent);
-            return reference;
+            return expression;
         }
         
         if (!compare(fieldType, expectedType)) {
@@ -233,28 +240,26 @@ TypeChecker::evalReference(ExpPtr expression, Environment & environment, Types::
         }   
         
         reference->returnType = fieldType;
+        reference->fieldIndex = static_cast<int>(fieldTypeIterator - typeclassType->fieldTypes.begin());
     } else if (!reference->fieldIdent.empty()) {
         printError(reference->token, "Field given for non-typeclass or tuple type");
     }
 
-    auto resolvedReturnType = reference->returnType;
-    resolveType(resolvedReturnType, environment);
-
-    auto resolvedExpectedType = expectedType;
-    resolveType(resolvedExpectedType, environment);
+    auto resolvedReturnType = instantiate(reference->returnType, environment);
+    auto resolvedExpectedType = instantiate(expectedType, environment);
 
     if (!compare(resolvedReturnType, resolvedExpectedType)) {
         printMismatchError(reference->token, referenceType, expectedType);
     }
 
-    return reference;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalBranch(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto branch = std::static_pointer_cast<Branch>(expression);
+    auto branch = static_cast<Branch *>(expression.get());
     
-    auto temp = std::make_shared<Temp>(branch->token, std::make_shared<Types::BoolType>());
+    auto temp = makeInArena<Temp>(arena, branch->token, Types::boolType());
     eval(branch->condition, environment, temp->returnType);
 
     Types::TypePtr elseType = eval(branch->elseBranch, environment, expectedType)->returnType;
@@ -263,30 +268,30 @@ TypeChecker::evalBranch(ExpPtr expression, Environment & environment, Types::Typ
 
 ExpPtr
 TypeChecker::evalTypeclass(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto typeclass = std::static_pointer_cast<Typeclass>(expression);
+    auto typeclass = static_cast<Typeclass *>(expression.get());
     
     if (!compare(typeclass->returnType, expectedType)) {
         printMismatchError(typeclass->token, typeclass->returnType, expectedType);
-        return typeclass;
+        return expression;
     }
 
     addName(environment, typeclass->ident, typeclass->returnType);
 
-    return typeclass;       
+    return expression;       
 }
 
 ExpPtr
 TypeChecker::evalApplication(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto application = std::static_pointer_cast<Application>(expression);
+    auto application = static_cast<Application *>(expression.get());
 
-    auto temp = std::make_shared<Temp>(rootExpression->token, std::make_shared<Types::UnknownType>());
+    auto temp = makeInArena<Temp>(arena, rootExpression->token, makeInArena<Types::UnknownType>(arena));
     auto ident = eval(application->ident, environment, temp->returnType);
 
     if (ident->returnType->dataType == Types::DataTypes::FUNC) {
         auto functionType = std::static_pointer_cast<Types::FuncType>(ident->returnType);
         
         if (ident->expType == Expressions::ExpressionTypes::APP) {
-            auto identGenerics = std::static_pointer_cast<Application>(ident)->genericReplacementTypes;
+            auto identGenerics = static_cast<Application *>(ident.get())->genericReplacementTypes;
             application->genericReplacementTypes.insert(application->genericReplacementTypes.end(), identGenerics.begin(), identGenerics.end());
         }
         
@@ -302,21 +307,16 @@ TypeChecker::evalApplication(ExpPtr expression, Environment & environment, Types
             printError(application->token, "No types provided for templated function");
         }
 
-        Environment functionInnerEnvironment;
-        if (!functionType->functionInnerEnvironment) {
-            functionType->functionInnerEnvironment = std::make_shared<EnvironmentRaw>();
-        }
-        functionInnerEnvironment = std::make_shared<EnvironmentRaw>(*(functionType->functionInnerEnvironment));
+        Environment functionInnerEnvironment = functionType->functionInnerEnvironment;
 
         for (unsigned int genericIndex = 0; genericIndex < application->genericReplacementTypes.size(); ++genericIndex) {
             addName(functionInnerEnvironment, functionType->genericTypes.at(genericIndex)->identifier, application->genericReplacementTypes.at(genericIndex));
         }
 
         for (unsigned int argumentIndex = 0; argumentIndex < application->arguments.size(); ++argumentIndex) {
-            auto argumentType = copyArgumentType(functionType->argumentTypes.at(argumentIndex));
+            auto argumentType = instantiate(functionType->argumentTypes.at(argumentIndex), functionInnerEnvironment);
             auto argument = application->arguments.at(argumentIndex);
 
-            resolveType(argumentType, functionInnerEnvironment);
             eval(argument, environment, argumentType);
 
             if (!(functionType->argumentNames.empty())) {
@@ -324,8 +324,7 @@ TypeChecker::evalApplication(ExpPtr expression, Environment & environment, Types
             }
         }
 
-        auto resolvedReturnType = copyArgumentType(functionType->returnType);
-        resolveType(resolvedReturnType, functionInnerEnvironment);
+        auto resolvedReturnType = instantiate(functionType->returnType, functionInnerEnvironment);
 
         if (application->returnType->resolved == false &&
             !functionType->isBuiltin && 
@@ -341,7 +340,7 @@ TypeChecker::evalApplication(ExpPtr expression, Environment & environment, Types
         application->returnType = resolvedReturnType;
         application->returnType->resolved = true;
 
-        return application;
+        return expression;
     } else if (ident->returnType->dataType == Types::DataTypes::TYPECLASS) {
         auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(ident->returnType);
 
@@ -362,32 +361,32 @@ TypeChecker::evalApplication(ExpPtr expression, Environment & environment, Types
         }
 
         application->returnType = typeclassType;
-        return application;
+        return expression;
     } else if (ident->returnType->dataType == Types::DataTypes::LIST) {
         auto listType = std::static_pointer_cast<Types::ListType>(ident->returnType);
 
         if (application->arguments.empty()) {
             printError(application->token, "List access needs integer argument");
-            return application;
+            return expression;
         }
 
-        auto listTemp = std::make_shared<Temp>(application->token, std::make_shared<Types::IntType>());
+        auto listTemp = makeInArena<Temp>(arena, application->token, Types::intType());
         eval(application->arguments.at(0), environment, listTemp->returnType);
         
-        listTemp->returnType = std::make_shared<Types::ListType>(expectedType);
+        listTemp->returnType = makeInArena<Types::ListType>(arena, expectedType);
         eval(ident, environment, listTemp->returnType);
 
         application->returnType = listType;
-        return application;
+        return expression;
     }
 
     printError(application->token, "Bad function or typeclass application");
-    return application;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalListDefinition(ExpPtr expression, const Environment & environment, Types::TypePtr & expectedType) {
-    auto listDefinition = std::static_pointer_cast<ListDefinition>(expression);
+    auto listDefinition = static_cast<ListDefinition *>(expression.get());
     
     Types::TypePtr expType;
     if (expectedType->dataType == Types::DataTypes::LIST) {
@@ -406,24 +405,28 @@ TypeChecker::evalListDefinition(ExpPtr expression, const Environment & environme
         printMismatchError(listDefinition->token, listDefinition->returnType, expectedType);
     }
 
-    return listDefinition;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalTupleDefinition(ExpPtr expression, const Environment & environment, Types::TypePtr & expectedType) {
-    auto tupleDefinition = std::static_pointer_cast<TupleDefinition>(expression);
-    auto tupleTypeCopy = copyArgumentType(tupleDefinition->returnType);
+    auto tupleDefinition = static_cast<TupleDefinition *>(expression.get());
+    // compared through a copy so unification does not fill in the definition's own type
+    Types::TypePtr tupleTypeCopy = makeInArena<Types::UnknownType>(arena);
+    if (tupleDefinition->returnType->dataType == Types::DataTypes::TUPLE) {
+        tupleTypeCopy = makeInArena<Types::TupleType>(arena, std::static_pointer_cast<Types::TupleType>(tupleDefinition->returnType)->tupleTypes);
+    }
 
     if (!compare(tupleTypeCopy, expectedType)) {
         printMismatchError(tupleDefinition->token, tupleDefinition->returnType, expectedType);
     }
 
-    return tupleDefinition;
+    return expression;
 }
 
 ExpPtr
 TypeChecker::evalMatch(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType) {
-    auto match = std::static_pointer_cast<Match>(expression);
+    auto match = static_cast<Match *>(expression.get());
 
     auto caseType = getName(match->token, environment, match->ident);
 
@@ -434,7 +437,7 @@ TypeChecker::evalMatch(ExpPtr expression, Environment & environment, Types::Type
         }
 
         if (casePtr->ident->expType == ExpressionTypes::REF &&
-            std::static_pointer_cast<Reference>(casePtr->ident)->ident == std::string("$any")) {
+            static_cast<Reference *>(casePtr->ident.get())->ident == std::string("$any")) {
             anyOccurred = true;
             eval(casePtr->body, environment, expectedType);
         } else {
@@ -443,51 +446,389 @@ TypeChecker::evalMatch(ExpPtr expression, Environment & environment, Types::Type
         }
     }
 
-    return match;
+    return expression;
+}
+
+// Whether evaluating expression is known to have no effect, and with it
+// that no function it makes or passes on can have one. Functions of
+// blocks, and references, are marked pure on the way.
+//
+// This is conservative: a function is pure if every name in its body that
+// can hold a function names one known to be pure, a builtin without
+// effects, a pure function of a block in scope or a val bound to a pure
+// value. A parameter holding a function, or a function of a later block,
+// is never known to be pure.
+bool
+TypeChecker::markPure(const ExpPtr & expression) {
+    if (expression->expType == ExpressionTypes::PROG) {
+        auto program = static_cast<Program *>(expression.get());
+        auto scopeSize = pureNames.size();
+
+        markPureFunctions(*program);
+        bool pure = markPure(program->body);
+
+        pureNames.resize(scopeSize);
+        return pure;
+    } else if (expression->expType == ExpressionTypes::LET) {
+        auto let = static_cast<Let *>(expression.get());
+        auto scopeSize = pureNames.size();
+
+        bool pure = markPure(let->value);
+        pureNames.emplace_back(let->ident, pure);
+        pure = markPure(let->afterLet) && pure;
+
+        pureNames.resize(scopeSize);
+        return pure;
+    } else if (expression->expType == ExpressionTypes::TYPECLASS) {
+        // its name is its constructor, which only makes a value
+        pureNames.emplace_back(static_cast<Typeclass *>(expression.get())->ident, true);
+        return true;
+    } else if (expression->expType == ExpressionTypes::REF) {
+        auto reference = static_cast<Reference *>(expression.get());
+        reference->pure = ExpressionUtils::isAnyCase(expression) ||
+                          !Types::holdsFunctions(reference->returnType) ||
+                          isPureName(reference->ident);
+        return reference->pure;
+    }
+
+    // visits every child, so each reference is marked
+    bool pure = true;
+    ExpressionUtils::forEachChild(expression, [this, &pure](ExpPtr & child) { pure = markPure(child) && pure; });
+    return pure;
 }
 
+// Every function of the block is taken to be pure, and those whose bodies
+// then have an effect are marked not to be until none changes, so that
+// recursive calls do not count against a function. Each body is walked
+// once more at the end, so the references in it are marked as of the
+// final result.
 void
-TypeChecker::resolveType(Types::TypePtr & returnType, Environment & environment) {
-    switch (returnType->dataType) {
-        case Types::DataTypes::GEN: {
-            std::string identifier = std::static_pointer_cast<Types::GenType>(returnType)->identifier;
-            auto envType = environment->find(identifier);
+TypeChecker::markPureFunctions(const Program & program) {
+    auto firstFunction = pureNames.size();
+    for (auto & function : program.functions) {
+        bool pure = !function->isBuiltin || !BuiltinDefinitions::hasEffects(function->builtinEnum);
+        pureNames.emplace_back(function->name, pure);
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t index = 0; index < program.functions.size(); ++index) {
+            auto & function = program.functions[index];
+            auto & pureName = pureNames[firstFunction + index];
+            if (!function->isBuiltin && pureName.second && !markPureFunction(*function)) {
+                pureName.second = false;
+                changed = true;
+            }
+        }
+    }
 
-            if (envType == environment->end()) {
-                break;
+    for (std::size_t index = 0; index < program.functions.size(); ++index) {
+        auto & function = program.functions[index];
+        if (!function->isBuiltin) {
+            markPureFunction(*function);
+        }
+        function->pure = pureNames[firstFunction + index].second;
+    }
+}
+
+bool
+TypeChecker::markPureFunction(const Function & function) {
+    auto scopeSize = pureNames.size();
+    for (auto & parameter : function.parameters) {
+        pureNames.emplace_back(parameter->name, !Types::holdsFunctions(parameter->returnType));
+    }
+
+    bool pure = markPure(function.functionBody);
+
+    pureNames.resize(scopeSize);
+    return pure;
+}
+
+// false if name is bound to something that is not known to be pure, or
+// not bound yet
+bool
+TypeChecker::isPureName(const std::string & name) const {
+    for (auto pureName = pureNames.rbegin(); pureName != pureNames.rend(); ++pureName) {
+        if (pureName->first == name) {
+            return pureName->second;
+        }
+    }
+    return false;
+}
+
+// Keeps the names in scope as it goes, so a memo func's body can be
+// followed into the functions of the blocks it calls
+void
+TypeChecker::checkMemoFunctions(const ExpPtr & expression) {
+    auto scopeSize = memoScopeNames.size();
+    if (expression->expType == ExpressionTypes::PROG) {
+        auto program = static_cast<Program *>(expression.get());
+        for (auto & function : program->functions) {
+            memoScopeNames.push_back(MemoScopeName{function->name, function->returnType, function.get(), false});
+        }
+
+        auto blockSize = memoScopeNames.size();
+        for (auto & function : program->functions) {
+            if (function->memoized) {
+                checkMemoized(*function);
             }
 
-            returnType = envType->second;
+            for (auto & parameter : function->parameters) {
+                memoScopeNames.push_back(MemoScopeName{parameter->name, parameter->returnType, nullptr, false});
+            }
+            checkMemoFunctions(function->functionBody);
+            memoScopeNames.resize(blockSize);
+        }
+
+        checkMemoFunctions(program->body);
+        memoScopeNames.resize(scopeSize);
+    } else if (expression->expType == ExpressionTypes::LET) {
+        auto let = static_cast<Let *>(expression.get());
+
+        checkMemoFunctions(let->value);
+        memoScopeNames.push_back(MemoScopeName{let->ident, let->valueType, nullptr, false});
+        checkMemoFunctions(let->afterLet);
+
+        memoScopeNames.resize(scopeSize);
+    } else if (expression->expType == ExpressionTypes::TYPECLASS) {
+        // bound until the end of the enclosing block
+        auto typeclass = static_cast<Typeclass *>(expression.get());
+        memoScopeNames.push_back(MemoScopeName{typeclass->ident, typeclass->returnType, nullptr, true});
+    } else {
+        ExpressionUtils::forEachChild(expression, [this](ExpPtr & child) { checkMemoFunctions(child); });
+    }
+}
+
+// Its parameters and result have to be values compared and hashed by what
+// they hold that no call can change, and its body must neither reach an
+// effect nor read a List it did not make or take, or a cached result could
+// differ from what a call would have returned
+void
+TypeChecker::checkMemoized(const Function & function) {
+    if (!function.genericParameters.empty()) {
+        printError(function.token, std::string("Error: memo func ") + function.name + std::string(" cannot be generic"));
+        return;
+    }
+
+    for (auto & parameter : function.parameters) {
+        if (!isMemoValueType(parameter->returnType)) {
+            printError(parameter->token, std::string("Error: memo func parameter ") + parameter->name +
+                       std::string(" must be an int, char, bool, string, null or tuple of them"));
+        }
+    }
+
+    auto functionType = std::static_pointer_cast<Types::FuncType>(function.returnType);
+    if (!isMemoValueType(functionType->returnType)) {
+        printError(function.token, std::string("Error: memo func ") + function.name +
+                   std::string(" must return an int, char, bool, string, null or tuple of them"));
+    }
+
+    if (!function.pure) {
+        printError(function.token, std::string("Error: memo func ") + function.name +
+                   std::string(" may call a function that does I/O, draws random numbers or changes a list in place"));
+    }
+
+    std::vector<const Function *> visited;
+    if (readsOuterLists(function, visited)) {
+        printError(function.token, std::string("Error: memo func ") + function.name +
+                   std::string(" may read a List from outside it, which can change between its calls"));
+    }
+}
+
+// whether a call of function can read a List bound outside it, directly or
+// through the functions of blocks it calls; visited holds the functions
+// already followed, so recursion ends
+bool
+TypeChecker::readsOuterLists(const Function & function, std::vector<const Function *> & visited) const {
+    visited.push_back(&function);
+
+    std::vector<std::string> localNames;
+    for (auto & parameter : function.parameters) {
+        localNames.push_back(parameter->name);
+    }
+    return readsOuterLists(function.functionBody, localNames, visited);
+}
+
+bool
+TypeChecker::readsOuterLists(const ExpPtr & expression, std::vector<std::string> & localNames,
+                             std::vector<const Function *> & visited) const {
+    auto isLocal = [&localNames](const std::string & name) {
+        return std::find(localNames.begin(), localNames.end(), name) != localNames.end();
+    };
+    auto scopeSize = localNames.size();
+    bool reads = false;
+
+    if (expression->expType == ExpressionTypes::PROG) {
+        auto program = static_cast<Program *>(expression.get());
+        for (auto & function : program->functions) {
+            localNames.push_back(function->name);
+        }
+
+        auto blockSize = localNames.size();
+        for (auto & function : program->functions) {
+            for (auto & parameter : function->parameters) {
+                localNames.push_back(parameter->name);
+            }
+            reads = readsOuterLists(function->functionBody, localNames, visited) || reads;
+            localNames.resize(blockSize);
+        }
+        reads = readsOuterLists(program->body, localNames, visited) || reads;
+    } else if (expression->expType == ExpressionTypes::LET) {
+        auto let = static_cast<Let *>(expression.get());
+
+        reads = readsOuterLists(let->value, localNames, visited);
+        localNames.push_back(let->ident);
+        reads = readsOuterLists(let->afterLet, localNames, visited) || reads;
+    } else if (expression->expType == ExpressionTypes::TYPECLASS) {
+        // bound until the end of the enclosing block
+        localNames.push_back(static_cast<Typeclass *>(expression.get())->ident);
+        return false;
+    } else if (expression->expType == ExpressionTypes::REF) {
+        auto reference = static_cast<Reference *>(expression.get());
+        return !ExpressionUtils::isAnyCase(expression) && !isLocal(reference->ident) &&
+               readsOuterName(reference->ident, visited);
+    } else {
+        if (expression->expType == ExpressionTypes::MATCH) {
+            auto match = static_cast<Match *>(expression.get());
+            reads = !isLocal(match->ident) && readsOuterName(match->ident, visited);
+        }
+        ExpressionUtils::forEachChild(expression, [&](ExpPtr & child) {
+            reads = readsOuterLists(child, localNames, visited) || reads;
+        });
+    }
+
+    localNames.resize(scopeSize);
+    return reads;
+}
+
+// whether name, bound outside the function being checked, can be or hold
+// a List, or is a function that can read one. A name that can hold a
+// function and does not name a function of a block, such as a parameter or
+// a val, could hold any, so it can.
+bool
+TypeChecker::readsOuterName(const std::string & name, std::vector<const Function *> & visited) const {
+    auto scopeName = std::find_if(memoScopeNames.rbegin(), memoScopeNames.rend(),
+                                  [&name](const MemoScopeName & memoScopeName) { return memoScopeName.name == name; });
+    if (scopeName == memoScopeNames.rend()) {
+        return true;
+    } else if (scopeName->constructor) {
+        return false;
+    } else if (Types::holdsLists(scopeName->type)) {
+        return true;
+    } else if (!Types::holdsFunctions(scopeName->type)) {
+        return false;
+    } else if (scopeName->function == nullptr) {
+        return true;
+    }
+
+    auto function = scopeName->function;
+    if (function->isBuiltin || std::find(visited.begin(), visited.end(), function) != visited.end()) {
+        return false;
+    }
+    return readsOuterLists(*function, visited);
+}
+
+bool
+TypeChecker::isMemoValueType(const Types::TypePtr & type) {
+    switch (type->dataType) {
+        case Types::DataTypes::INT:
+        case Types::DataTypes::CHAR:
+        case Types::DataTypes::STRING:
+        case Types::DataTypes::BOOL:
+        case Types::DataTypes::NULLVAL:
+            return true;
+        case Types::DataTypes::TUPLE: {
+            const auto & tupleTypes = std::static_pointer_cast<Types::TupleType>(type)->tupleTypes;
+            return std::all_of(tupleTypes.begin(), tupleTypes.end(), isMemoValueType);
+        }
+        default:
+            return false;
+    }
+}
+
+// type with every generic bound in substitution replaced by its binding.
+// Only the nodes above a replaced generic are rebuilt, the rest are shared
+// with type, which is left as it was. Unknown types are never shared since
+// unification fills them in place.
+Types::TypePtr
+TypeChecker::instantiate(const Types::TypePtr & type, const Environment & substitution) {
+    switch (type->dataType) {
+        case Types::DataTypes::GEN: {
+            auto boundType = substitution.find(std::static_pointer_cast<Types::GenType>(type)->identifier);
+            return (boundType) ? boundType : type;
         }
-            break;
         case Types::DataTypes::LIST: {
-            auto listType = std::static_pointer_cast<Types::ListType>(returnType);
-            resolveType(listType->listType, environment);
+            auto listType = std::static_pointer_cast<Types::ListType>(type);
+            auto elementType = instantiate(listType->listType, substitution);
+            if (elementType == listType->listType) {
+                return type;
+            }
+            return makeInArena<Types::ListType>(arena, elementType);
         }
-            break;
         case Types::DataTypes::TUPLE: {
-            auto tupleType = std::static_pointer_cast<Types::TupleType>(returnType);
+            auto tupleType = std::static_pointer_cast<Types::TupleType>(type);
+            std::vector<Types::TypePtr> elementTypes;
+            bool changed = false;
             for (auto & tupleElementType : tupleType->tupleTypes) {
-                resolveType(tupleElementType, environment);
+                elementTypes.push_back(instantiate(tupleElementType, substitution));
+                changed = changed || (elementTypes.back() != tupleElementType);
+            }
+            if (!changed) {
+                return type;
             }
+            return makeInArena<Types::TupleType>(arena, elementTypes);
+        }
+        case Types::DataTypes::SET: {
+            auto setType = std::static_pointer_cast<Types::SetType>(type);
+            auto elementType = instantiate(setType->setType, substitution);
+            if (elementType == setType->setType) {
+                return type;
+            }
+            return makeInArena<Types::SetType>(arena, elementType);
+        }
+        case Types::DataTypes::MAP: {
+            auto mapType = std::static_pointer_cast<Types::MapType>(type);
+            auto keyType = instantiate(mapType->keyType, substitution);
+            auto valueType = instantiate(mapType->valueType, substitution);
+            if (keyType == mapType->keyType && valueType == mapType->valueType) {
+                return type;
+            }
+            return makeInArena<Types::MapType>(arena, keyType, valueType);
         }
-            break;
         case Types::DataTypes::FUNC: {
-            auto funcType = std::static_pointer_cast<Types::FuncType>(returnType);
+            auto funcType = std::static_pointer_cast<Types::FuncType>(type);
+            std::vector<Types::TypePtr> argumentTypes;
+            bool changed = false;
             for (auto & argumentType : funcType->argumentTypes) {
-                resolveType(argumentType, environment);
+                argumentTypes.push_back(instantiate(argumentType, substitution));
+                changed = changed || (argumentTypes.back() != argumentType);
+            }
+            auto returnType = instantiate(funcType->returnType, substitution);
+            if (!changed && returnType == funcType->returnType) {
+                return type;
             }
-            resolveType(funcType->returnType, environment);
+
+            auto newFuncType = makeInArena<Types::FuncType>(arena, funcType->genericTypes, argumentTypes, returnType);
+            newFuncType->argumentNames = funcType->argumentNames;
+            newFuncType->functionBody = funcType->functionBody;
+            newFuncType->functionInnerEnvironment = funcType->functionInnerEnvironment;
+            scopedFunctionTypes.push_back(newFuncType);
+            newFuncType->isBuiltin = funcType->isBuiltin;
+            return newFuncType;
         }
-            break;
+        case Types::DataTypes::UNKNOWN:
+            return makeInArena<Types::UnknownType>(arena);
         default:
-            break;
-    } 
+            return type;
+    }
 }
 
 bool 
 TypeChecker::compare(Types::TypePtr & leftType, Types::TypePtr & rightType) {
-    if (leftType->dataType == Types::DataTypes::UNKNOWN) {
+    if (leftType == rightType) {
+        return true;
+    } else if (leftType->dataType == Types::DataTypes::UNKNOWN) {
         leftType = rightType;
         return true;
     } else if (rightType->dataType ==  Types::DataTypes::UNKNOWN) {
@@ -500,69 +841,18 @@ TypeChecker::compare(Types::TypePtr & leftType, Types::TypePtr & rightType) {
 
 void
 TypeChecker::addName(Environment & environment, std::string name, Types::TypePtr type) {
-    if (environment->count(name)) {
-		environment->erase(name);
-	}
-	environment->insert(std::pair<std::string, Types::TypePtr>(name, type));
+    environment.add(name, type);
 }
 
 Types::TypePtr
 TypeChecker::getName(const Token & token, Environment & environment, std::string name) {
-    auto type = environment->find(name);
-    if (type == environment->end()) {
+    auto type = environment.find(name);
+    if (!type) {
         printError(token, std::string("Error: ") + name + 
                           std::string(" does not exist in this scope"));
-        return std::make_shared<Types::UnknownType>();
-    }
-    return type->second;
-}
-
-Types::TypePtr
-TypeChecker::copyArgumentType(Types::TypePtr argumentType) {
-    auto typeEnum = argumentType->dataType;
-    switch (typeEnum) {
-        case Types::DataTypes::INT:
-            return std::make_shared<Types::IntType>();
-            break;
-        case Types::DataTypes::BOOL:
-            return std::make_shared<Types::BoolType>();
-            break;
-        case Types::DataTypes::CHAR:
-            return std::make_shared<Types::CharType>();
-            break;
-        case Types::DataTypes::STRING:
-            return std::make_shared<Types::StringType>();
-            break;
-        case Types::DataTypes::NULLVAL:
-            return std::make_shared<Types::NullType>();
-            break;
-        case Types::DataTypes::LIST:
-            return std::make_shared<Types::ListType>(std::static_pointer_cast<Types::ListType>(argumentType)->listType);
-            break;
-        case Types::DataTypes::TUPLE:
-            return std::make_shared<Types::TupleType>(std::static_pointer_cast<Types::TupleType>(argumentType)->tupleTypes);
-            break;
-        case Types::DataTypes::FUNC: {
-            auto funcType = std::static_pointer_cast<Types::FuncType>(argumentType);
-            auto newFuncType = std::make_shared<Types::FuncType>(funcType->genericTypes, funcType->argumentTypes, funcType->returnType);
-            newFuncType->argumentNames = funcType->argumentNames;
-            newFuncType->functionBody = funcType->functionBody;
-            newFuncType->functionInnerEnvironment = funcType->functionInnerEnvironment;
-            return newFuncType;
-        }
-            break;
-        case Types::DataTypes::TYPECLASS: {
-            auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(argumentType);
-            return std::make_shared<Types::TypeclassType>(typeclassType->ident, typeclassType->fieldTypes);
-        }
-            break;
-        case Types::DataTypes::GEN:
-            return std::make_shared<Types::GenType>(std::static_pointer_cast<Types::GenType>(argumentType)->identifier);
-            break;
-        default:
-            break;
+        return makeInArena<Types::UnknownType>(arena);
     }
-    return std::make_shared<Types::UnknownType>();
+    return type;
 }
 
 void
@@ -570,11 +860,11 @@ TypeChecker::printMismatchError(const Token & token, const Types::TypePtr & type
     error = true;
 
     std::stringstream errorStream;
-    errorStream << "Line: " << token.position.fileLine - BuiltinDefinitions::builtinNumber()
+    errorStream << "Line: " << token.position.fileLine
                 << ", Column: " << token.position.fileColumn << std::endl
                 << "Mismatched type: " << type->toString()
                 << ", Expected: " << expectedType->toString()
-                << std::endl << token.position.currentLineText << std::endl;
+                << std::endl << token.position.currentLineText() << std::endl;
     ERROR(errorStream.str());
 }
 
@@ -583,9 +873,9 @@ TypeChecker::printError(const Token & token, const std::string & errorMessage) {
     error = true;
 
     std::stringstream errorStream;
-    errorStream << "Line: " << token.position.fileLine - BuiltinDefinitions::builtinNumber()
+    errorStream << "Line: " << token.position.fileLine
                 << ", Column: " << token.position.fileColumn << std::endl
                 << errorMessage << std::endl 
-                << token.position.currentLineText << std::endl;
+                << token.position.currentLineText() << std::endl;
     ERROR(errorStream.str());
 }
\ No newline at end of file
@@ -6,11 +6,33 @@
 
 #include "parser.hpp"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 class TypeChecker {
     private:
         ExpPtr rootExpression;
+        ArenaPtr arena;
         bool error = false;
 
+        // every function type given a scope, cleared once checking is done
+        std::vector<Types::FuncTypePtr> scopedFunctionTypes;
+        // the names in scope while marking pure functions, innermost last,
+        // each with whether every function it can hold is known to be pure
+        std::vector<std::pair<std::string, bool>> pureNames;
+
+        // a name in scope while checking memo funcs
+        class MemoScopeName {
+            public:
+                std::string name;
+                Types::TypePtr type; // as declared, since the bodies of functions that are not generic are not checked
+                const Function * function; // the function of a block it names, null if it names none
+                bool constructor; // names a typeclass, whose constructor only makes a value
+        };
+        // the names in scope while checking memo funcs, innermost last
+        std::vector<MemoScopeName> memoScopeNames;
+
         ExpPtr eval(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType);
         
         ExpPtr evalProgram(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType);
@@ -25,20 +47,30 @@ class TypeChecker {
         ExpPtr evalTupleDefinition(ExpPtr expression, const Environment & environment, Types::TypePtr & expectedType);
         ExpPtr evalMatch(ExpPtr expression, Environment & environment, Types::TypePtr & expectedType);
 
-        void resolveType(Types::TypePtr & returnType, Environment & environment);
+        bool markPure(const ExpPtr & expression);
+        void markPureFunctions(const Program & program);
+        bool markPureFunction(const Function & function);
+        bool isPureName(const std::string & name) const;
+        void checkMemoFunctions(const ExpPtr & expression);
+        void checkMemoized(const Function & function);
+        bool readsOuterLists(const Function & function, std::vector<const Function *> & visited) const;
+        bool readsOuterLists(const ExpPtr & expression, std::vector<std::string> & localNames,
+                             std::vector<const Function *> & visited) const;
+        bool readsOuterName(const std::string & name, std::vector<const Function *> & visited) const;
+        static bool isMemoValueType(const Types::TypePtr & type);
+
+        Types::TypePtr instantiate(const Types::TypePtr & type, const Environment & substitution);
 
         bool compare(Types::TypePtr & leftType, Types::TypePtr & rightType);
 
         void addName(Environment & environment, std::string name, Types::TypePtr type);
         Types::TypePtr getName(const Token & token, Environment & environment, std::string name);
 
-        Types::TypePtr copyArgumentType(Types::TypePtr argumentType);
-
         void printMismatchError(const Token & token, const Types::TypePtr & type, const Types::TypePtr & expectedType);
         void printError(const Token & token, const std::string & errorMessage);
 
     public:
-        explicit TypeChecker(const ExpPtr & rootExpression);
+        TypeChecker(const ExpPtr & rootExpression, const ArenaPtr & arena);
         
         void check();
         bool errorOccurred() const { return error; }
@@ -0,0 +1,382 @@
+#include "virtualMachine.hpp"
+
+VirtualMachine::VirtualMachine(const Bytecode::ChunkPtr & chunk)
+: chunk(chunk),
+  errorNullValue(Values::makeNull())
+{ }
+
+std::unique_ptr<Evaluator>
+VirtualMachine::fork() const {
+    auto forkedVirtualMachine = std::make_unique<VirtualMachine>(chunk);
+    forkedVirtualMachine->callStack = callStack;
+    return forkedVirtualMachine;
+}
+
+void
+VirtualMachine::run() {
+    Values::Environment environment = std::make_shared<Values::Frame>(chunk->frameLayout, nullptr);
+    execute(0, environment);
+    environment->clear();
+    Collector::collect();
+}
+
+Values::Value
+VirtualMachine::applyFunction(const Token & token, const Values::FunctionValuePtr & functionValue, const std::vector<Values::Value> & arguments, Values::Environment & environment) {
+    if (functionValue->memoCache) {
+        auto cachedValue = functionValue->memoCache->find(arguments);
+        if (cachedValue) {
+            return cachedValue;
+        }
+    }
+
+    Values::Environment functionEnvironment = std::make_shared<Values::Frame>(functionValue->frameLayout,
+                                                                              functionValue->functionBodyEnvironment);
+    std::copy(arguments.begin(), arguments.end(), functionEnvironment->slots.begin());
+
+    if (profiler) {
+        profiler->enter(functionValue->name, functionValue->isBuiltin);
+    }
+
+    auto resultValue = (functionValue->isBuiltin) ? BuiltinImplementations::runBuiltin(token, functionValue, functionEnvironment, *this)
+                                                  : execute(functionValue->codeEntry, functionEnvironment);
+
+    if (profiler) {
+        profiler->exit();
+    }
+
+    if (functionValue->memoCache && !error) {
+        functionValue->memoCache->store(arguments, resultValue);
+    }
+    return resultValue;
+}
+
+Values::Value
+VirtualMachine::execute(int programCounter, Values::Environment environment) {
+    // calls made by this code run in the same loop, only builtins that
+    // take a function re-enter through applyFunction
+    std::vector<CallFrame> callFrames;
+
+    while (true) {
+        const auto & instruction = chunk->code[programCounter++];
+
+        switch (instruction.op) {
+            case Bytecode::OpCode::CONSTANT: {
+                stack.push_back(chunk->constants[instruction.a]);
+            }
+                break;
+            case Bytecode::OpCode::LOAD: {
+                const auto & site = chunk->sites[instruction.c];
+                Address address;
+                address.depth = instruction.a;
+                address.slot = instruction.b;
+
+                auto value = environment->lookup(address);
+                if (!value) {
+                    printError(site.token, std::string("Error: ") + site.name +
+                                           std::string(" does not exist in this scope"));
+                }
+                stack.push_back(value);
+            }
+                break;
+            case Bytecode::OpCode::LOAD_FIELD: {
+                stack.back() = getField(chunk->sites[instruction.c], stack.back());
+            }
+                break;
+            case Bytecode::OpCode::STORE: {
+                environment->slots.at(instruction.a) = stack.back();
+                stack.pop_back();
+            }
+                break;
+            case Bytecode::OpCode::DUP: {
+                stack.push_back(stack.back());
+            }
+                break;
+            case Bytecode::OpCode::PRIMITIVE: {
+                auto op = static_cast<Operator::OperatorTypes>(instruction.a);
+                auto rightValue = stack.back();
+                stack.pop_back();
+                auto leftValue = stack.back();
+
+                if (Operations::isDivisionByZero(op, rightValue)) {
+                    error = true;
+
+                    printError(chunk->sites[instruction.c].token, "Error: Division by zero!");
+                }
+
+                auto resultValue = Operations::doPrimitive(op, leftValue, rightValue);
+                if (!resultValue) {
+                    const auto & token = chunk->sites[instruction.c].token;
+                    printError(token, std::string("Error: Binary operator requires primitive types: ") +
+                                      token.position.currentLineText());
+                }
+                stack.back() = resultValue;
+            }
+                break;
+            case Bytecode::OpCode::JUMP: {
+                programCounter = instruction.a;
+            }
+                break;
+            case Bytecode::OpCode::JUMP_IF_FALSE: {
+                auto conditionValue = stack.back();
+                stack.pop_back();
+                if (!conditionValue.boolData()) {
+                    programCounter = instruction.a;
+                }
+            }
+                break;
+            case Bytecode::OpCode::MATCH: {
+                const auto & matchJump = chunk->matches[instruction.a];
+                auto arm = matchJump.table->find(stack.back());
+                stack.pop_back();
+                programCounter = (arm >= 0) ? matchJump.armEntries[arm] : matchJump.noMatchEntry;
+            }
+                break;
+            case Bytecode::OpCode::MAKE_FUNCTION: {
+                const auto & functionEntry = chunk->functions[instruction.a];
+                const auto & function = functionEntry.function;
+
+                std::vector<std::string> parameterNames{};
+                std::transform(function->parameters.begin(), function->parameters.end(), std::back_inserter(parameterNames),
+                               [](const std::shared_ptr<Argument> & parameter) -> std::string { return parameter->name; });
+
+                auto functionValue = std::make_shared<Values::FunctionValue>(function->returnType,
+                                                                             parameterNames,
+                                                                             function->functionBody,
+                                                                             nullptr);
+
+                if (BuiltinDefinitions::isBuiltin(function->name)) {
+                    functionValue->isBuiltin = true;
+                    functionValue->builtinEnum = BuiltinDefinitions::getBuiltin(function->name);
+                } else {
+                    functionValue->functionBodyEnvironment = environment;
+                    Collector::track(environment);
+                }
+                if (function->memoized) {
+                    functionValue->memoCache = std::make_shared<MemoCache>();
+                }
+                functionValue->frameLayout = function->frameLayout;
+                functionValue->codeEntry = functionEntry.entry;
+                functionValue->name = function->name;
+
+                stack.push_back(functionValue);
+            }
+                break;
+            case Bytecode::OpCode::MAKE_TYPECLASS: {
+                stack.push_back(makeTypeclass(chunk->typeclasses[instruction.a]));
+            }
+                break;
+            case Bytecode::OpCode::MAKE_LIST: {
+                std::vector<Values::Value> listData(stack.end() - instruction.a, stack.end());
+                stack.resize(stack.size() - instruction.a);
+                stack.push_back(std::make_shared<Values::ListValue>(chunk->types[instruction.b], listData));
+            }
+                break;
+            case Bytecode::OpCode::MAKE_TUPLE: {
+                std::vector<Values::Value> tupleData(stack.end() - instruction.a, stack.end());
+                stack.resize(stack.size() - instruction.a);
+                stack.push_back(std::make_shared<Values::TupleValue>(chunk->types[instruction.b], tupleData));
+            }
+                break;
+            case Bytecode::OpCode::CALL:
+            case Bytecode::OpCode::TAIL_CALL: {
+                const auto & site = chunk->sites[instruction.c];
+                unsigned int argumentStart = stack.size() - instruction.a;
+                auto ident = stack.at(argumentStart - 1);
+
+                if (ident.dataType() == Types::DataTypes::TYPECLASS) {
+                    auto typeclassValue = constructTypeclass(ident, argumentStart);
+                    stack.resize(argumentStart - 1);
+                    stack.push_back(typeclassValue);
+                    break;
+                } else if (ident.dataType() == Types::DataTypes::LIST) {
+                    auto elementValue = indexList(site, ident, stack.at(argumentStart));
+                    stack.resize(argumentStart - 1);
+                    stack.push_back(elementValue);
+                    break;
+                }
+
+                // else has to be a function type
+
+                if (!site.name.empty()) {
+                    callStack.push(std::make_pair(site.name, site.token));
+                }
+
+                auto functionValue = ident.as<Values::FunctionValue>();
+                MemoCache::Arguments memoArguments;
+                if (functionValue->memoCache) {
+                    memoArguments.assign(stack.begin() + argumentStart, stack.end());
+                    auto cachedValue = functionValue->memoCache->find(memoArguments);
+                    if (cachedValue) {
+                        stack.resize(argumentStart - 1);
+                        stack.push_back(cachedValue);
+                        break;
+                    }
+                }
+
+                // a memo func keeps its call frame, which stores its result on return
+                bool replacesFrame = (instruction.op == Bytecode::OpCode::TAIL_CALL && !functionValue->isBuiltin &&
+                                      !functionValue->memoCache);
+                auto functionEnvironment = makeFrame(functionValue, argumentStart);
+                stack.resize(argumentStart - 1);
+
+                if (functionValue->isBuiltin) {
+                    if (profiler) {
+                        profiler->enter(functionValue->name, true);
+                    }
+                    stack.push_back(BuiltinImplementations::runBuiltin(site.token, functionValue, functionEnvironment, *this));
+                    if (profiler) {
+                        profiler->exit();
+                    }
+                    break;
+                }
+
+                if (profiler) {
+                    if (replacesFrame) {
+                        profiler->replace(functionValue->name);
+                    } else {
+                        profiler->enter(functionValue->name, false);
+                    }
+                }
+
+                if (!replacesFrame) {
+                    callFrames.emplace_back(programCounter, environment);
+                    if (functionValue->memoCache) {
+                        callFrames.back().memoCache = functionValue->memoCache;
+                        callFrames.back().memoArguments = std::move(memoArguments);
+                    }
+                }
+                environment = functionEnvironment;
+                programCounter = functionValue->codeEntry;
+            }
+                break;
+            case Bytecode::OpCode::PIPELINE: {
+                const auto & site = chunk->sites[instruction.c];
+                std::vector<Values::Value> arguments(stack.end() - instruction.a, stack.end());
+                stack.resize(stack.size() - instruction.a);
+
+                callStack.push(std::make_pair(site.name, site.token));
+                if (profiler) {
+                    profiler->enter(site.name, true);
+                }
+                stack.push_back(chunk->pipelines[instruction.b]->run(site.token, arguments, environment, *this));
+                if (profiler) {
+                    profiler->exit();
+                }
+            }
+                break;
+            case Bytecode::OpCode::RETURN: {
+                if (callFrames.empty()) {
+                    auto returnValue = stack.back();
+                    stack.pop_back();
+                    return returnValue;
+                }
+
+                if (profiler) {
+                    profiler->exit();
+                }
+
+                if (callFrames.back().memoCache && !error) {
+                    callFrames.back().memoCache->store(callFrames.back().memoArguments, stack.back());
+                }
+                programCounter = callFrames.back().returnAddress;
+                environment = callFrames.back().environment;
+                callFrames.pop_back();
+            }
+                break;
+            case Bytecode::OpCode::FAIL: {
+                const auto & site = chunk->sites[instruction.c];
+                printError(site.token, site.name);
+            }
+                break;
+        }
+    }
+}
+
+Values::Value
+VirtualMachine::getField(const Bytecode::Site & site, const Values::Value & value) {
+    if (value.dataType() == Types::DataTypes::TUPLE) {
+        auto tupleValue = value.as<Values::TupleValue>();
+        int tupleIndex = (site.fieldIndex >= 0) ? site.fieldIndex : std::stoi(site.field);
+        return tupleValue->tupleData.at(tupleIndex);
+    } else if (value.dataType() == Types::DataTypes::TYPECLASS) {
+        auto typeclassValue = value.as<Values::TypeclassValue>();
+        int fieldIndex = (site.fieldIndex >= 0) ? site.fieldIndex : typeclassValue->fieldIndex(site.field);
+        if (fieldIndex < 0 || fieldIndex >= static_cast<int>(typeclassValue->fields.size())) {
+            printError(site.token, std::string("Error: typeclass ") +
+                       site.name + std::string(" has no field ") +
+                       site.field);
+            return errorNullValue;
+        }
+        return typeclassValue->fields[fieldIndex];
+    }
+
+    return value;
+}
+
+Values::Value
+VirtualMachine::makeTypeclass(const std::shared_ptr<Typeclass> & typeclass) {
+    Values::Value initValue = std::make_shared<Values::Object>(std::make_shared<Types::UnknownType>());
+    Values::Fields fields(typeclass->fields.size(), initValue);
+
+    return std::make_shared<Values::TypeclassValue>(typeclass->returnType, std::move(fields));
+}
+
+Values::Value
+VirtualMachine::constructTypeclass(const Values::Value & typeclass, const unsigned int argumentStart) {
+    auto typeclassValue = typeclass.as<Values::TypeclassValue>();
+    auto typeclassType = std::static_pointer_cast<Types::TypeclassType>(typeclassValue->type);
+    Values::Fields typeclassFields(typeclassValue->fields);
+    for (unsigned int argumentIndex = 0; argumentStart + argumentIndex < stack.size(); ++argumentIndex) {
+        typeclassFields.at(argumentIndex) = stack.at(argumentStart + argumentIndex);
+    }
+    return std::make_shared<Values::TypeclassValue>(typeclassType, std::move(typeclassFields));
+}
+
+Values::Value
+VirtualMachine::indexList(const Bytecode::Site & site, const Values::Value & list, const Values::Value & index) {
+    unsigned int listIndex = index.intData();
+    auto listValue = list.as<Values::ListValue>();
+    if (listIndex >= listValue->listData.size()) {
+        printError(site.token, "Error: Out of bounds list access: " + site.token.position.currentLineText());
+        return errorNullValue;
+    }
+    return listValue->listData.at(listIndex);
+}
+
+Values::Environment
+VirtualMachine::makeFrame(const Values::FunctionValuePtr & functionValue, const unsigned int argumentStart) {
+    Values::Environment functionEnvironment = std::make_shared<Values::Frame>(functionValue->frameLayout,
+                                                                              functionValue->functionBodyEnvironment);
+    // parameters occupy the leading slots of the frame
+    std::copy(stack.begin() + argumentStart, stack.end(), functionEnvironment->slots.begin());
+    return functionEnvironment;
+}
+
+const std::string
+VirtualMachine::getStackTraceString() {
+    std::stringstream stackStream;
+    stackStream << "Fatal error occurred:\n";
+    for (unsigned int callIndex = 0; callIndex < callStack.size(); ++callIndex) {
+        const auto & call = callStack.recent(callIndex);
+        stackStream << "\tat \'" << call.first << "\' (Line: " << call.second.position.fileLine << ")\n";
+    }
+    if (callStack.dropped() > 0) {
+        stackStream << "\t... " << callStack.dropped() << " earlier calls\n";
+    }
+    return stackStream.str();
+}
+
+void
+VirtualMachine::printError(const Token & token, const std::string & errorMessage) {
+    error = true;
+
+    std::stringstream errorStream;
+    errorStream << "Line: " << token.position.fileLine
+                << ", Column: " << token.position.fileColumn << std::endl
+                << errorMessage << std::endl
+                << token.position.currentLineText() << std::endl;
+    ERROR(errorStream.str());
+    ERROR(getStackTraceString());
+
+    throw RuntimeException();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../../utils/logger.hpp"
+#include "../../defs/token.hpp"
+#include "../../defs/values.hpp"
+#include "../compiler/bytecode.hpp"
+#include "../interpreter/interpreter.hpp"
+#include "../interpreter/operations.hpp"
+#include "../builtin/builtinImplementations.hpp"
+#include "../runtime/evaluator.hpp"
+#include "../runtime/memoCache.hpp"
+#include "../runtime/profiler.hpp"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class VirtualMachine final : public Evaluator {
+    private:
+        class CallFrame {
+            public:
+                int returnAddress;
+                Values::Environment environment;
+                // of a call to a memo func, which stores its result on return
+                std::shared_ptr<MemoCache> memoCache;
+                MemoCache::Arguments memoArguments;
+
+                CallFrame(const int returnAddress, const Values::Environment & environment)
+                : returnAddress(returnAddress),
+                  environment(environment) { }
+        };
+
+        Bytecode::ChunkPtr chunk;
+        bool error = false;
+
+        Values::Value errorNullValue;
+
+        std::vector<Values::Value> stack;
+        CallStack callStack;
+        Profiler * profiler = nullptr; // only set on the evaluator a run starts with
+
+        Values::Value execute(int programCounter, Values::Environment environment);
+
+        Values::Value getField(const Bytecode::Site & site, const Values::Value & value);
+        Values::Value makeTypeclass(const std::shared_ptr<Typeclass> & typeclass);
+        Values::Value constructTypeclass(const Values::Value & typeclass, const unsigned int argumentStart);
+        Values::Value indexList(const Bytecode::Site & site, const Values::Value & list, const Values::Value & index);
+        Values::Environment makeFrame(const Values::FunctionValuePtr & functionValue, const unsigned int argumentStart);
+
+        const std::string getStackTraceString();
+        void printError(const Token & token, const std::string & errorMessage);
+
+    public:
+        explicit VirtualMachine(const Bytecode::ChunkPtr & chunk);
+
+        std::unique_ptr<Evaluator> fork() const override;
+
+        void run();
+        Values::Value applyFunction(const Token & token, const Values::FunctionValuePtr & functionValue, const std::vector<Values::Value> & arguments, Values::Environment & environment) override;
+
+        void setProfiler(Profiler * profiler) { this->profiler = profiler; }
+        bool errorOccurred() { return error; }
+};
@@ -1,6 +1,14 @@
 #pragma once
 
+class MatchTable;
+class Pipeline;
+
+namespace Values {
+    class StringValue;
+}
+
 #include "../utils/operator.hpp"
+#include "../utils/arena.hpp"
 
 #include "types.hpp"
 #include "token.hpp"
@@ -34,21 +42,34 @@ namespace Expressions {
             
             Expression()
             : token(Token(Token::TokenType::DELIM,
-                          FilePosition(-1, -1, "END"),
-                          std::string({}))),
+                          FilePosition(-1, -1, std::string_view("END")),
+                          std::string_view())),
               expType(ExpressionTypes::END),
-              returnType(std::make_shared<Types::NullType>()) { }
+              returnType(Types::nullType()) { }
             
-            static std::shared_ptr<Expression> End() {
-                return std::make_shared<Expression>();
+            static std::shared_ptr<Expression> End(const ArenaPtr & arena) {
+                return makeInArena<Expression>(arena);
             }
     };
 
     using ExpPtr = std::shared_ptr<Expression>;
 
+    // Location of a bound name: depth counts frames out from the running one,
+    // slot indexes into that frame. Negative depth means it could not be
+    // resolved lexically and is looked up by name at runtime.
+    class Address {
+        public:
+            int depth = -1;
+            int slot = -1;
+    };
+
+    // Names of the slots of one runtime frame, in slot order
+    using FrameLayout = std::shared_ptr<std::vector<std::string>>;
+
     class Argument : public Expression {
         public:
             std::string name;
+            int slot = -1;
 
             Argument(const Token & token,
                      const Types::TypePtr & returnType,
@@ -65,8 +86,15 @@ namespace Expressions {
 
             ExpPtr functionBody;
 
+            int slot = -1;
+            FrameLayout frameLayout;
+
             bool isBuiltin = false;
             BuiltinDefinitions::BuiltinEnums builtinEnum = BuiltinDefinitions::BuiltinEnums::BUILTINNUM;
+            // declared memo func, its results are cached by its arguments
+            bool memoized = false;
+            // no call to it can have an effect, set by the type checker
+            bool pure = false;
 
             Function(const Token & token, 
                      const Types::TypePtr & returnType,
@@ -86,6 +114,8 @@ namespace Expressions {
             std::vector<std::shared_ptr<Function>> functions;
             ExpPtr body;
 
+            FrameLayout frameLayout; // only set on the root program
+
             Program(const Token & token,
                     const std::vector<std::shared_ptr<Function>> & functions,
                     const ExpPtr & body)
@@ -98,6 +128,7 @@ namespace Expressions {
         public:
             const std::string ident;
             std::vector<std::shared_ptr<Argument>> fields{};
+            int slot = -1;
 
             Typeclass(const Token & token,
                       const std::string & ident,
@@ -111,6 +142,8 @@ namespace Expressions {
     class Literal : public Expression {
         public:
             std::variant<int, bool, char, std::string> data;
+            // set by the resolver for a string, the value every evaluation gives
+            std::shared_ptr<Values::StringValue> stringValue;
 
             Literal(const Token & token,
                     const Types::TypePtr & returnType,
@@ -137,7 +170,7 @@ namespace Expressions {
               data(std::variant<int, bool, char, std::string>(data)) { }
             
             explicit Literal(const Token & token)
-            : Expression(token, ExpressionTypes::LIT, std::make_shared<Types::NullType>()) { }
+            : Expression(token, ExpressionTypes::LIT, Types::nullType()) { }
 
             template<typename T>
             T getData() {
@@ -166,6 +199,7 @@ namespace Expressions {
             std::string ident;
             Types::TypePtr valueType; // return type would be for the afterLet
             ExpPtr value, afterLet;
+            int slot = -1;
 
             Let(const Token & token,
                 const std::string & ident,
@@ -183,6 +217,10 @@ namespace Expressions {
         public:
             std::string ident = "";
             std::string fieldIdent = "";
+            int fieldIndex = -1; // tuple index or typeclass field offset, set by the type checker
+            Address address;
+            // every function the name can hold is known to have no effect, set by the type checker
+            bool pure = false;
 
             Reference(const Token & token,
                       const Types::TypePtr & returnType,
@@ -219,6 +257,8 @@ namespace Expressions {
             ExpPtr ident;
             std::vector<ExpPtr> arguments;
             std::vector<Types::TypePtr> genericReplacementTypes{};
+            bool isTailCall = false; // last thing its function body does
+            std::shared_ptr<const Pipeline> pipeline; // set by the resolver if it is the outside of a chain of list builtins
 
             Application(const Token & token,
                         const ExpPtr & ident,
@@ -276,6 +316,8 @@ namespace Expressions {
         public:
             std::string ident;
             std::vector<std::shared_ptr<Case>> cases;
+            Address address;
+            std::shared_ptr<const MatchTable> table; // set by the resolver if the cases are literals
 
             Match(const Token & token,
                   const std::string & ident,
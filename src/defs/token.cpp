@@ -1,6 +1,6 @@
 #include "token.hpp"
 
-Token::Token(const TokenType tokenType, const FilePosition & filePosition, const std::string & tokenText) 
+Token::Token(const TokenType tokenType, const FilePosition & filePosition, const std::string_view & tokenText) 
 : type(tokenType), position(filePosition), text(tokenText) {
 
 }
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 class Token {
     public:
@@ -18,9 +19,11 @@ class Token {
         
         TokenType type = static_cast<TokenType>(0);
         FilePosition position;
-        std::string text{};
+        // a view into text kept by the SourceManager
+        std::string_view text{};
 
-        Token(const TokenType tokenType, const FilePosition & filePosition, const std::string & tokenText);
+        Token(const TokenType tokenType, const FilePosition & filePosition, const std::string_view & tokenText);
+        Token(const TokenType tokenType, const FilePosition & filePosition, std::string && tokenText) = delete;
         const std::string toString() const;
         static const std::string getTokenTypeAsString(const TokenType type);
 };
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <memory>
 #include <map>
+#include <mutex>
 
 namespace Expressions {
     class Expression;
@@ -21,6 +23,8 @@ namespace Types {
         FUNC,
         GEN,
         TYPECLASS,
+        SET,
+        MAP,
         UNKNOWN
     };
 
@@ -37,6 +41,8 @@ namespace Types {
             virtual bool compare(const std::shared_ptr<Type> & otherType) {
                 if (otherType == nullptr)
                     return false;
+                else if (otherType.get() == this)
+                    return true;
                 else if (otherType->dataType == DataTypes::UNKNOWN) {
                     otherType->dataType = dataType;
                     return true;
@@ -125,6 +131,8 @@ namespace Types {
             bool compare(const std::shared_ptr<Type> & otherType) override {
                 if (otherType == nullptr) {
                     return false;
+                } else if (otherType.get() == this) {
+                    return true;
                 } else if (otherType->dataType == DataTypes::UNKNOWN) {
                     otherType->dataType = dataType;
                     return true;
@@ -151,6 +159,69 @@ namespace Types {
 
     using ListTypePtr = std::shared_ptr<ListType>;
 
+    class SetType : public Type {
+        public:
+            TypePtr setType;
+
+            explicit SetType(const TypePtr & setType)
+            : Type(DataTypes::SET),
+              setType(setType) { }
+
+            const std::string toString() const override {
+                return std::string("Set[") + setType->toString() + std::string("]");
+            }
+
+            bool compare(const std::shared_ptr<Type> & otherType) override {
+                if (otherType == nullptr) {
+                    return false;
+                } else if (otherType.get() == this) {
+                    return true;
+                } else if (otherType->dataType == DataTypes::UNKNOWN) {
+                    otherType->dataType = dataType;
+                    return true;
+                }
+
+                return (otherType->dataType == DataTypes::SET) &&
+                       (setType->compare(std::static_pointer_cast<SetType>(otherType)->setType));
+            }
+    };
+
+    using SetTypePtr = std::shared_ptr<SetType>;
+
+    class MapType : public Type {
+        public:
+            TypePtr keyType;
+            TypePtr valueType;
+
+            MapType(const TypePtr & keyType, const TypePtr & valueType)
+            : Type(DataTypes::MAP),
+              keyType(keyType),
+              valueType(valueType) { }
+
+            const std::string toString() const override {
+                return std::string("Map[") + keyType->toString() + std::string(", ") + valueType->toString() + std::string("]");
+            }
+
+            bool compare(const std::shared_ptr<Type> & otherType) override {
+                if (otherType == nullptr) {
+                    return false;
+                } else if (otherType.get() == this) {
+                    return true;
+                } else if (otherType->dataType == DataTypes::UNKNOWN) {
+                    otherType->dataType = dataType;
+                    return true;
+                } else if (otherType->dataType != DataTypes::MAP) {
+                    return false;
+                }
+
+                auto otherMapType = std::static_pointer_cast<MapType>(otherType);
+                return keyType->compare(otherMapType->keyType) &&
+                       valueType->compare(otherMapType->valueType);
+            }
+    };
+
+    using MapTypePtr = std::shared_ptr<MapType>;
+
     class TupleType : public Type {
         public:
             std::vector<TypePtr> tupleTypes;
@@ -183,6 +254,8 @@ namespace Types {
             bool compare(const std::shared_ptr<Type> & otherType) override {
                 if (otherType == nullptr) {
                     return false;
+                } else if (otherType.get() == this) {
+                    return true;
                 } else if (dataType == DataTypes::UNKNOWN &&
                            otherType->dataType == DataTypes::TUPLE) {
                     tupleTypes = std::static_pointer_cast<TupleType>(otherType)->tupleTypes;
@@ -236,6 +309,103 @@ namespace Types {
     };
 
     using GenTypePtr = std::shared_ptr<GenType>;
+
+    // Names in scope while type checking, kept as a persistent AVL tree
+    // keyed by name. Copies share one tree and adding a name rebuilds only
+    // the path down to it, so entering a scope or keeping the scope of a
+    // function is a pointer copy rather than a copy of every name in it.
+    class Scope {
+        private:
+            class Node;
+            using NodePtr = std::shared_ptr<const Node>;
+
+            class Node {
+                public:
+                    const std::string name;
+                    const TypePtr type; // nullptr hides the name
+                    const NodePtr left;
+                    const NodePtr right;
+                    const int height;
+
+                    Node(const std::string & name, const TypePtr & type, const NodePtr & left, const NodePtr & right)
+                    : name(name),
+                      type(type),
+                      left(left),
+                      right(right),
+                      height(1 + std::max(heightOf(left), heightOf(right))) { }
+            };
+
+            NodePtr root;
+
+            static int heightOf(const NodePtr & node) { return (node) ? node->height : 0; }
+
+            static NodePtr makeNode(const std::string & name, const TypePtr & type, const NodePtr & left, const NodePtr & right) {
+                return std::make_shared<const Node>(name, type, left, right);
+            }
+
+            // node with the given children, rotated if their heights differ by more than one
+            static NodePtr balance(const std::string & name, const TypePtr & type, const NodePtr & left, const NodePtr & right) {
+                if (heightOf(left) > heightOf(right) + 1) {
+                    if (heightOf(left->left) >= heightOf(left->right)) {
+                        return makeNode(left->name, left->type, left->left, makeNode(name, type, left->right, right));
+                    }
+                    auto pivot = left->right;
+                    return makeNode(pivot->name, pivot->type,
+                                    makeNode(left->name, left->type, left->left, pivot->left),
+                                    makeNode(name, type, pivot->right, right));
+                } else if (heightOf(right) > heightOf(left) + 1) {
+                    if (heightOf(right->right) >= heightOf(right->left)) {
+                        return makeNode(right->name, right->type, makeNode(name, type, left, right->left), right->right);
+                    }
+                    auto pivot = right->left;
+                    return makeNode(pivot->name, pivot->type,
+                                    makeNode(name, type, left, pivot->left),
+                                    makeNode(right->name, right->type, pivot->right, right->right));
+                }
+                return makeNode(name, type, left, right);
+            }
+
+            static NodePtr insert(const NodePtr & node, const std::string & name, const TypePtr & type) {
+                if (node == nullptr) {
+                    return makeNode(name, type, nullptr, nullptr);
+                }
+
+                auto order = name.compare(node->name);
+                if (order < 0) {
+                    return balance(node->name, node->type, insert(node->left, name, type), node->right);
+                } else if (order > 0) {
+                    return balance(node->name, node->type, node->left, insert(node->right, name, type));
+                }
+                return makeNode(name, type, node->left, node->right);
+            }
+
+        public:
+            // type bound to name, nullptr if name is not in scope
+            TypePtr find(const std::string & name) const {
+                const Node * node = root.get();
+                while (node != nullptr) {
+                    auto order = name.compare(node->name);
+                    if (order == 0) {
+                        return node->type;
+                    }
+                    node = (order < 0) ? node->left.get() : node->right.get();
+                }
+                return nullptr;
+            }
+
+            // binds name in this scope only, copies made before keep their binding
+            void add(const std::string & name, const TypePtr & type) {
+                root = insert(root, name, type);
+            }
+
+            void remove(const std::string & name) {
+                if (find(name)) {
+                    add(name, nullptr);
+                }
+            }
+
+            void clear() { root = nullptr; }
+    };
     
     class FuncType : public Type {
         public:
@@ -245,7 +415,7 @@ namespace Types {
             TypePtr returnType;
 
             std::shared_ptr<Expressions::Expression> functionBody;
-            std::shared_ptr<std::map<std::string, TypePtr>> functionInnerEnvironment;
+            Scope functionInnerEnvironment;
 
             bool isBuiltin = false;
 
@@ -257,11 +427,6 @@ namespace Types {
               argumentTypes(argumentTypes),
               returnType(returnType) { }
 
-            ~FuncType() {
-                if (functionInnerEnvironment)
-                    functionInnerEnvironment->clear();
-            }
-            
             const std::string toString() const override {
                 std::string typeString("[");
 
@@ -297,6 +462,8 @@ namespace Types {
             bool compare(const std::shared_ptr<Type> & otherType) override {
                 if (otherType == nullptr) {
                     return false;
+                } else if (otherType.get() == this) {
+                    return true;
                 } else if (dataType == DataTypes::UNKNOWN &&
                            otherType->dataType == DataTypes::FUNC) {
                     auto funcType = std::static_pointer_cast<FuncType>(otherType);
@@ -357,6 +524,8 @@ namespace Types {
             bool compare(const std::shared_ptr<Type> & otherType) override {
                 if (otherType == nullptr)
                     return false;
+                else if (otherType.get() == this)
+                    return true;
 
                 auto dataTypeEnum = static_cast<int>(dataType);
                 auto otherTypeEnum = static_cast<int>(otherType->dataType);
@@ -380,6 +549,156 @@ namespace Types {
 
     using UnknownTypePtr = std::shared_ptr<UnknownType>;
 
+    // Shared type universe. The primitive types are immortal singletons and
+    // structurally equal lists, tuples, sets and maps of interned types share one node,
+    // so interned types compare equal by pointer. Only fully known types are
+    // interned: unification mutates unknown types in place, so those, generics,
+    // functions and typeclasses are always allocated per use.
+    inline const TypePtr & intType() { static const TypePtr type = std::make_shared<IntType>(); return type; }
+    inline const TypePtr & charType() { static const TypePtr type = std::make_shared<CharType>(); return type; }
+    inline const TypePtr & stringType() { static const TypePtr type = std::make_shared<StringType>(); return type; }
+    inline const TypePtr & boolType() { static const TypePtr type = std::make_shared<BoolType>(); return type; }
+    inline const TypePtr & nullType() { static const TypePtr type = std::make_shared<NullType>(); return type; }
+
+    class TypeTable {
+        public:
+            static TypeTable & instance() {
+                static TypeTable table;
+                return table;
+            }
+
+            // canonical node for type, nullptr if it can not be interned
+            TypePtr canonical(const TypePtr & type) {
+                if (type == nullptr) {
+                    return nullptr;
+                }
+
+                switch (type->dataType) {
+                    case DataTypes::INT: return intType();
+                    case DataTypes::CHAR: return charType();
+                    case DataTypes::STRING: return stringType();
+                    case DataTypes::BOOL: return boolType();
+                    case DataTypes::NULLVAL: return nullType();
+                    case DataTypes::LIST: {
+                        auto elementType = canonical(std::static_pointer_cast<ListType>(type)->listType);
+                        if (elementType == nullptr) {
+                            return nullptr;
+                        }
+                        return listOf(elementType);
+                    }
+                    case DataTypes::TUPLE: {
+                        std::vector<TypePtr> elementTypes;
+                        std::vector<const Type *> key;
+                        for (const auto & tupleElementType : std::static_pointer_cast<TupleType>(type)->tupleTypes) {
+                            auto elementType = canonical(tupleElementType);
+                            if (elementType == nullptr) {
+                                return nullptr;
+                            }
+                            elementTypes.push_back(elementType);
+                            key.push_back(elementType.get());
+                        }
+                        return tupleOf(elementTypes, key);
+                    }
+                    case DataTypes::SET: {
+                        auto elementType = canonical(std::static_pointer_cast<SetType>(type)->setType);
+                        if (elementType == nullptr) {
+                            return nullptr;
+                        }
+                        return setOf(elementType);
+                    }
+                    case DataTypes::MAP: {
+                        auto mapType = std::static_pointer_cast<MapType>(type);
+                        auto keyType = canonical(mapType->keyType);
+                        auto valueType = canonical(mapType->valueType);
+                        if (keyType == nullptr || valueType == nullptr) {
+                            return nullptr;
+                        }
+                        return mapOf(keyType, valueType);
+                    }
+                    default:
+                        return nullptr;
+                }
+            }
+
+            // elementType must already be canonical
+            TypePtr listOf(const TypePtr & elementType) {
+                std::lock_guard<std::mutex> lock(tableMutex);
+                auto & listType = listTypes[elementType.get()];
+                if (listType == nullptr) {
+                    listType = std::make_shared<ListType>(elementType);
+                }
+                return listType;
+            }
+
+        private:
+            std::mutex tableMutex;
+            // keyed by the canonical element nodes, which are never freed
+            std::map<const Type *, TypePtr> listTypes;
+            std::map<std::vector<const Type *>, TypePtr> tupleTypes;
+            std::map<const Type *, TypePtr> setTypes;
+            std::map<std::pair<const Type *, const Type *>, TypePtr> mapTypes;
+
+            TypeTable() = default;
+
+            TypePtr tupleOf(const std::vector<TypePtr> & elementTypes, const std::vector<const Type *> & key) {
+                std::lock_guard<std::mutex> lock(tableMutex);
+                auto & tupleType = tupleTypes[key];
+                if (tupleType == nullptr) {
+                    tupleType = std::make_shared<TupleType>(elementTypes);
+                }
+                return tupleType;
+            }
+
+            TypePtr setOf(const TypePtr & elementType) {
+                std::lock_guard<std::mutex> lock(tableMutex);
+                auto & setType = setTypes[elementType.get()];
+                if (setType == nullptr) {
+                    setType = std::make_shared<SetType>(elementType);
+                }
+                return setType;
+            }
+
+            TypePtr mapOf(const TypePtr & keyType, const TypePtr & valueType) {
+                std::lock_guard<std::mutex> lock(tableMutex);
+                auto & mapType = mapTypes[std::make_pair(keyType.get(), valueType.get())];
+                if (mapType == nullptr) {
+                    mapType = std::make_shared<MapType>(keyType, valueType);
+                }
+                return mapType;
+            }
+    };
+
+    // canonical node for type, or type itself if it can not be interned
+    inline TypePtr
+    intern(const TypePtr & type) {
+        auto canonicalType = TypeTable::instance().canonical(type);
+        return (canonicalType) ? canonicalType : type;
+    }
+
+    inline TypePtr
+    listOf(const TypePtr & elementType) {
+        auto canonicalElementType = TypeTable::instance().canonical(elementType);
+        if (canonicalElementType == nullptr) {
+            return std::make_shared<ListType>(elementType);
+        }
+        return TypeTable::instance().listOf(canonicalElementType);
+    }
+
+    inline TypePtr
+    tupleOf(const std::vector<TypePtr> & elementTypes) {
+        return intern(std::make_shared<TupleType>(elementTypes));
+    }
+
+    inline TypePtr
+    setOf(const TypePtr & elementType) {
+        return intern(std::make_shared<SetType>(elementType));
+    }
+
+    inline TypePtr
+    mapOf(const TypePtr & keyType, const TypePtr & valueType) {
+        return intern(std::make_shared<MapType>(keyType, valueType));
+    }
+
     inline bool
     isPrimitiveType(const TypePtr type) {
         if (type->dataType == DataTypes::INT ||
@@ -391,7 +710,75 @@ namespace Types {
         }
         return false;
     }
+
+    // whether a value of type can be or hold a function, as far as is known
+    inline bool
+    holdsFunctions(const TypePtr & type) {
+        if (type == nullptr) {
+            return true;
+        }
+
+        switch (type->dataType) {
+            case DataTypes::FUNC:
+            case DataTypes::UNKNOWN:
+                return true;
+            case DataTypes::LIST:
+                return holdsFunctions(std::static_pointer_cast<ListType>(type)->listType);
+            case DataTypes::SET:
+                return holdsFunctions(std::static_pointer_cast<SetType>(type)->setType);
+            case DataTypes::MAP: {
+                auto mapType = std::static_pointer_cast<MapType>(type);
+                return holdsFunctions(mapType->keyType) || holdsFunctions(mapType->valueType);
+            }
+            case DataTypes::TUPLE: {
+                const auto & tupleTypes = std::static_pointer_cast<TupleType>(type)->tupleTypes;
+                return std::any_of(tupleTypes.begin(), tupleTypes.end(), holdsFunctions);
+            }
+            case DataTypes::TYPECLASS: {
+                // a typeclass named before its fields are known could hold anything
+                const auto & fieldTypes = std::static_pointer_cast<TypeclassType>(type)->fieldTypes;
+                return fieldTypes.empty() ||
+                       std::any_of(fieldTypes.begin(), fieldTypes.end(),
+                                   [](const std::pair<std::string, TypePtr> & fieldType) { return holdsFunctions(fieldType.second); });
+            }
+            default:
+                return false;
+        }
+    }
+
+    // whether a value of type can be or hold a List, which can change in
+    // place, as far as is known; what a function closes over is not counted
+    inline bool
+    holdsLists(const TypePtr & type) {
+        if (type == nullptr) {
+            return true;
+        }
+
+        switch (type->dataType) {
+            case DataTypes::LIST:
+            case DataTypes::UNKNOWN:
+            case DataTypes::GEN:
+                return true;
+            case DataTypes::SET:
+                return holdsLists(std::static_pointer_cast<SetType>(type)->setType);
+            case DataTypes::MAP: {
+                auto mapType = std::static_pointer_cast<MapType>(type);
+                return holdsLists(mapType->keyType) || holdsLists(mapType->valueType);
+            }
+            case DataTypes::TUPLE: {
+                const auto & tupleTypes = std::static_pointer_cast<TupleType>(type)->tupleTypes;
+                return std::any_of(tupleTypes.begin(), tupleTypes.end(), holdsLists);
+            }
+            case DataTypes::TYPECLASS: {
+                const auto & fieldTypes = std::static_pointer_cast<TypeclassType>(type)->fieldTypes;
+                return fieldTypes.empty() ||
+                       std::any_of(fieldTypes.begin(), fieldTypes.end(),
+                                   [](const std::pair<std::string, TypePtr> & fieldType) { return holdsLists(fieldType.second); });
+            }
+            default:
+                return false;
+        }
+    }
 }
 
-using EnvironmentRaw = std::map<std::string, Types::TypePtr>;
-using Environment = std::shared_ptr<EnvironmentRaw>;
\ No newline at end of file
+using Environment = Types::Scope;
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "values.hpp"
+
+#include <mutex>
+
+namespace {
+    // taken to flatten any string, so the halves of a concatenation are
+    // never read while another thread lets go of them
+    std::mutex flattenMutex;
+}
+
+namespace Values {
+    StringValue::StringValue(const StringValuePtr & base, const std::size_t offset, const std::size_t length)
+    : Object(Types::stringType()),
+      length(length),
+      flat(true),
+      base(base),
+      offset(offset) { }
+
+    StringValue::StringValue(const StringValuePtr & left, const StringValuePtr & right)
+    : Object(Types::stringType()),
+      length(left->size() + right->size()),
+      flat(false),
+      left(left),
+      right(right) { }
+
+    StringValue::~StringValue() {
+        std::vector<StringValuePtr> pending;
+        if (left) {
+            pending.push_back(std::move(left));
+        }
+        if (right) {
+            pending.push_back(std::move(right));
+        }
+
+        // a part only this string held is taken apart here, rather than in
+        // its own destructor, so the depth of the chain is never on the stack
+        while (!pending.empty()) {
+            auto part = std::move(pending.back());
+            pending.pop_back();
+            if (part.use_count() == 1) {
+                if (part->left) {
+                    pending.push_back(std::move(part->left));
+                }
+                if (part->right) {
+                    pending.push_back(std::move(part->right));
+                }
+            }
+        }
+    }
+
+    StringValuePtr
+    StringValue::concat(const StringValuePtr & left, const StringValuePtr & right) {
+        if (left->empty()) {
+            return right;
+        } else if (right->empty()) {
+            return left;
+        }
+
+        if (left->size() + right->size() < MIN_SHARED_LENGTH) {
+            std::string characters;
+            characters.reserve(left->size() + right->size());
+            characters += left->view();
+            characters += right->view();
+            return std::make_shared<StringValue>(Types::stringType(), std::move(characters));
+        }
+        return std::make_shared<StringValue>(left, right);
+    }
+
+    StringValuePtr
+    StringValue::slice(const StringValuePtr & string, const std::size_t start, const std::size_t count) {
+        if (start == 0 && count == string->size()) {
+            return string;
+        }
+
+        auto characters = string->view();
+        if (count < MIN_SHARED_LENGTH) {
+            return std::make_shared<StringValue>(Types::stringType(), std::string(characters.substr(start, count)));
+        }
+
+        // a string holding its own characters, which a flattened concatenation now does
+        if (string->base) {
+            return std::make_shared<StringValue>(string->base, string->offset + start, count);
+        }
+        return std::make_shared<StringValue>(string, start, count);
+    }
+
+    // copies the parts of a concatenation, left to right, walking down into
+    // those not flattened yet instead of flattening each
+    void
+    StringValue::flatten() const {
+        std::lock_guard<std::mutex> lock(flattenMutex);
+        if (flat.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        std::string characters;
+        characters.reserve(length);
+        std::vector<const StringValue *> pending{right.get(), left.get()};
+        while (!pending.empty()) {
+            auto part = pending.back();
+            pending.pop_back();
+            if (part->flat.load(std::memory_order_relaxed)) {
+                characters += part->view();
+            } else {
+                pending.push_back(part->right.get());
+                pending.push_back(part->left.get());
+            }
+        }
+
+        text = std::move(characters);
+        flat.store(true, std::memory_order_release);
+        left.reset();
+        right.reset();
+    }
+}
@@ -1,145 +1,507 @@
 #pragma once
 
 class Builtin;
+class MemoCache;
 
 #include "expressions.hpp"
 #include "../core/builtin/builtinDefinitions.hpp"
 #include "types.hpp"
+#include "../utils/persistentHashMap.hpp"
+#include "../utils/persistentVector.hpp"
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace Values {
-    class Value {
+    // Objects and frames alive now, for -mem-stats. Only counted once
+    // counting is turned on, which has to happen before any are made.
+    class LiveCounts {
         public:
-            Types::TypePtr type;
+            static inline bool counting = false;
+            static inline std::atomic<long> objects{0};
+            static inline std::atomic<long> frames{0};
 
-            explicit Value(const Types::TypePtr & type)
-            : type(type) { }
+            static void add(std::atomic<long> & count, const long change) {
+                if (counting) {
+                    count.fetch_add(change, std::memory_order_relaxed);
+                }
+            }
     };
 
-    using ValuePtr = std::shared_ptr<Value>;
-    
-    using Environment = std::shared_ptr<std::map<std::string, Values::ValuePtr>>;
-
-    class IntValue : public Value {
+    // Base of every value that lives on the heap: strings, lists, tuples,
+    // functions and typeclasses
+    class Object {
         public:
-            int data = 0;
+            Types::TypePtr type;
+
+            explicit Object(const Types::TypePtr & type)
+            : type(type) {
+                LiveCounts::add(LiveCounts::objects, 1);
+            }
+
+            Object(const Object & other)
+            : type(other.type) {
+                LiveCounts::add(LiveCounts::objects, 1);
+            }
 
-            IntValue(const Types::TypePtr & type,
-                     const int & data)
-            : Value(type),
-              data(data) { }
+            virtual ~Object() {
+                LiveCounts::add(LiveCounts::objects, -1);
+            }
     };
 
-    using IntValuePtr = std::shared_ptr<IntValue>;
-    
-    class CharValue : public Value {
+    using ObjectPtr = std::shared_ptr<Object>;
+
+    // int, char, bool and null are held inline, anything else refers to an
+    // Object. A default constructed Value is empty, e.g. an unbound slot
+    class Value {
+        private:
+            enum class Tag : unsigned char {
+                EMPTY, INT, CHAR, BOOL, NULLVAL, OBJECT
+            };
+
+            Tag tag = Tag::EMPTY;
+            union {
+                int intValue;
+                char charValue;
+                bool boolValue;
+            };
+            ObjectPtr object;
+
+            explicit Value(const Tag tag)
+            : tag(tag),
+              intValue(0) { }
+
         public:
-            char data = (char)0;
+            Value()
+            : intValue(0) { }
+
+            template<class ObjectType>
+            Value(const std::shared_ptr<ObjectType> & object)
+            : tag((object) ? Tag::OBJECT : Tag::EMPTY),
+              intValue(0),
+              object(object) { }
+
+            static Value makeInt(const int data) { Value value(Tag::INT); value.intValue = data; return value; }
+            static Value makeChar(const char data) { Value value(Tag::CHAR); value.charValue = data; return value; }
+            static Value makeBool(const bool data) { Value value(Tag::BOOL); value.boolValue = data; return value; }
+            static Value makeNull() { return Value(Tag::NULLVAL); }
+
+            explicit operator bool() const { return tag != Tag::EMPTY; }
+
+            Types::DataTypes dataType() const {
+                switch (tag) {
+                    case Tag::INT: return Types::DataTypes::INT;
+                    case Tag::CHAR: return Types::DataTypes::CHAR;
+                    case Tag::BOOL: return Types::DataTypes::BOOL;
+                    case Tag::NULLVAL: return Types::DataTypes::NULLVAL;
+                    case Tag::OBJECT: return object->type->dataType;
+                    default: return Types::DataTypes::UNKNOWN;
+                }
+            }
+
+            // inline values have the interned primitive types
+            Types::TypePtr type() const {
+                static const Types::TypePtr unknownType = std::make_shared<Types::UnknownType>();
+
+                switch (tag) {
+                    case Tag::INT: return Types::intType();
+                    case Tag::CHAR: return Types::charType();
+                    case Tag::BOOL: return Types::boolType();
+                    case Tag::NULLVAL: return Types::nullType();
+                    case Tag::OBJECT: return object->type;
+                    default: return unknownType;
+                }
+            }
+
+            int intData() const { return intValue; }
+            char charData() const { return charValue; }
+            bool boolData() const { return boolValue; }
 
-            CharValue(const Types::TypePtr & type,
-                      const char & data)
-            : Value(type),
-              data(data) { }
+            template<class ObjectType>
+            std::shared_ptr<ObjectType> as() const {
+                return std::static_pointer_cast<ObjectType>(object);
+            }
+
+            // null unless the value refers to an Object; a reference, so that
+            // reading its use count does not change it
+            const ObjectPtr & pointer() const { return object; }
     };
 
-    using CharValuePtr = std::shared_ptr<CharValue>;
+    inline Value makeInt(const int data) { return Value::makeInt(data); }
+    inline Value makeChar(const char data) { return Value::makeChar(data); }
+    inline Value makeBool(const bool data) { return Value::makeBool(data); }
+    inline Value makeNull() { return Value::makeNull(); }
+
+    class Frame;
+
+    using Environment = std::shared_ptr<Frame>;
 
-    class StringValue : public Value {
+    class Frame {
         public:
-            std::string data;
+            std::vector<Value> slots;
+            Expressions::FrameLayout layout;
 
-            StringValue(const Types::TypePtr & type,
-                        const std::string & data)
-            : Value(type),
-              data(data) { }
+            Environment parent; // frame the running function was defined in
+
+            Frame(const Expressions::FrameLayout & layout,
+                  const Environment & parent)
+            : slots((layout) ? layout->size() : 0),
+              layout(layout),
+              parent(parent) {
+                LiveCounts::add(LiveCounts::frames, 1);
+            }
+
+            Frame(const Frame &) = delete;
+            Frame & operator=(const Frame &) = delete;
+
+            ~Frame() {
+                LiveCounts::add(LiveCounts::frames, -1);
+            }
+
+            void clear() {
+                slots.clear();
+                parent.reset();
+            }
+
+            // empty if the slot at address is unbound or not assigned yet
+            Value lookup(const Expressions::Address & address) const {
+                if (address.depth < 0) {
+                    return Value();
+                }
+
+                const Frame * frame = this;
+                for (int depth = 0; frame && depth < address.depth; ++depth) {
+                    frame = frame->parent.get();
+                }
+                return (frame) ? frame->slots.at(address.slot) : Value();
+            }
     };
 
+    // one value per field, at the offset of the field in the type's fieldTypes
+    using Fields = std::vector<Value>;
+
+    class StringValue;
+
     using StringValuePtr = std::shared_ptr<StringValue>;
 
-    class BoolValue : public Value {
-        public:
-            bool data = false;
-            
-            BoolValue(const Types::TypePtr & type,
-                      const bool & data)
-            : Value(type),
-              data(data) { }
-    };
+    // An immutable string, shared by every value holding it. It holds its
+    // characters itself, or is a slice of the characters another string
+    // holds, or is a concatenation of two strings. A concatenation only
+    // copies its halves into characters of its own the first time they are
+    // read, so building a string by repeated concat is linear in its length
+    // rather than quadratic. Slices and concatenations of a few characters
+    // are copied right away, since that costs less than sharing them.
+    class StringValue : public Object {
+        private:
+            // a slice or concatenation shorter than this is copied instead
+            static constexpr std::size_t MIN_SHARED_LENGTH = 32;
 
-    using BoolValuePtr = std::shared_ptr<BoolValue>;
+            std::size_t length;
+            // whether the characters can be read, from text or else from base;
+            // set once a concatenation is flattened
+            mutable std::atomic<bool> flat;
+            mutable std::string text;
+            StringValuePtr base; // for a slice, a string holding its own characters
+            std::size_t offset = 0;
+            // for a concatenation until it is flattened, only read under flattenMutex
+            mutable StringValuePtr left;
+            mutable StringValuePtr right;
+
+            void flatten() const;
 
-    class NullValue : public Value {
         public:
-            explicit NullValue(const Types::TypePtr & type)
-            : Value(type) { }
+            StringValue(const Types::TypePtr & type,
+                        std::string text)
+            : Object(type),
+              length(text.size()),
+              flat(true),
+              text(std::move(text)) { }
+
+            StringValue(const StringValuePtr & base, const std::size_t offset, const std::size_t length);
+            StringValue(const StringValuePtr & left, const StringValuePtr & right);
+
+            StringValue(const StringValue &) = delete;
+            StringValue & operator=(const StringValue &) = delete;
+
+            // releases a long chain of concatenations one at a time
+            ~StringValue();
+
+            static StringValuePtr concat(const StringValuePtr & left, const StringValuePtr & right);
+            // count characters from start, both in range
+            static StringValuePtr slice(const StringValuePtr & string, const std::size_t start, const std::size_t count);
+
+            // valid while the string is alive
+            std::string_view view() const {
+                if (!flat.load(std::memory_order_acquire)) {
+                    flatten();
+                }
+                return (base) ? base->view().substr(offset, length) : std::string_view(text);
+            }
+
+            std::size_t size() const { return length; }
+            bool empty() const { return length == 0; }
+            std::string str() const { return std::string(view()); }
     };
 
-    using NullValuePtr = std::shared_ptr<NullValue>;
+    // lists made from another one by the non-destructive builtins share all
+    // but O(log n) of its elements with it
+    using ListData = PersistentVector<Value>;
 
-    class ListValue : public Value {
+    class ListValue : public Object {
         public:
-            std::vector<ValuePtr> listData;
+            ListData listData;
 
             ListValue(const Types::TypePtr & type,
-                      const std::vector<ValuePtr> & listData)
-            : Value(type),
+                      const ListData & listData)
+            : Object(type),
               listData(listData) { }
     };
 
     using ListValuePtr = std::shared_ptr<ListValue>;
 
-    class TupleValue : public Value {
+    class TupleValue : public Object {
         public:
-            std::vector<ValuePtr> tupleData;
+            std::vector<Value> tupleData;
 
             TupleValue(const Types::TypePtr & type,
-                       const std::vector<ValuePtr> & tupleData)
-            : Value(type),
+                       const std::vector<Value> & tupleData)
+            : Object(type),
               tupleData(tupleData) { }
     };
 
     using TupleValuePtr = std::shared_ptr<TupleValue>;
 
-    class FunctionValue : public Value {
+    class FunctionValue : public Object {
         public:
             std::vector<std::string> parameterNames;
             Expressions::ExpPtr functionBody;
             Environment functionBodyEnvironment;
+            Expressions::FrameLayout frameLayout;
+            int codeEntry = -1; // offset of the compiled body, only used by the VM
+            std::string_view name; // of the func declaring it, points into the tree
 
             bool isBuiltin = false;
             BuiltinDefinitions::BuiltinEnums builtinEnum = BuiltinDefinitions::BuiltinEnums::BUILTINNUM;
+            std::shared_ptr<MemoCache> memoCache; // only for a memo func
 
             FunctionValue(const Types::TypePtr & type,
                           const std::vector<std::string> & parameterNames,
                           const Expressions::ExpPtr & functionBody,
                           const Environment & functionBodyEnvironment,
                           const bool & isBuiltin = false)
-            : Value(type),
+            : Object(type),
               parameterNames(parameterNames),
               functionBody(functionBody),
               functionBodyEnvironment(functionBodyEnvironment) { }
-            
-            ~FunctionValue() {
-                if (type->dataType == Types::DataTypes::FUNC) {
-                    if (std::static_pointer_cast<Types::FuncType>(type)->functionInnerEnvironment) {
-                        std::static_pointer_cast<Types::FuncType>(type)->functionInnerEnvironment->clear();
-                    }
-                }
-            }
     };
 
     using FunctionValuePtr = std::shared_ptr<FunctionValue>;
 
-    class TypeclassValue : public Value {
+    class TypeclassValue : public Object {
         public:
-            Environment fields;
+            Fields fields;
 
             TypeclassValue(const Types::TypePtr & type,
-                           const Environment & fields)
-            : Value(type),
-              fields(fields) { }
+                           Fields fields)
+            : Object(type),
+              fields(std::move(fields)) { }
+
+            // offset of the field named fieldIdent, -1 if the type has none
+            int fieldIndex(const std::string & fieldIdent) const {
+                const auto & fieldTypes = std::static_pointer_cast<Types::TypeclassType>(type)->fieldTypes;
+                for (unsigned int index = 0; index < fieldTypes.size(); ++index) {
+                    if (fieldTypes[index].first == fieldIdent) {
+                        return static_cast<int>(index);
+                    }
+                }
+                return -1;
+            }
     };
 
     using TypeclassValuePtr = std::shared_ptr<TypeclassValue>;
+
+    // structural over every kind of value, functions compare by identity
+    bool valuesEqual(const Value & value1, const Value & value2);
+    // equal values hash equal
+    std::size_t hashValue(const Value & value);
+
+    class ValueHash {
+        public:
+            std::size_t operator()(const Value & value) const { return hashValue(value); }
+    };
+
+    class ValueEqual {
+        public:
+            bool operator()(const Value & value1, const Value & value2) const { return valuesEqual(value1, value2); }
+    };
+
+    // a set maps each element to an empty value
+    using SetData = PersistentHashMap<Value, Value, ValueHash, ValueEqual>;
+    using MapData = PersistentHashMap<Value, Value, ValueHash, ValueEqual>;
+
+    class SetValue : public Object {
+        public:
+            SetData setData;
+
+            SetValue(const Types::TypePtr & type,
+                     const SetData & setData)
+            : Object(type),
+              setData(setData) { }
+    };
+
+    using SetValuePtr = std::shared_ptr<SetValue>;
+
+    class MapValue : public Object {
+        public:
+            MapData mapData;
+
+            MapValue(const Types::TypePtr & type,
+                     const MapData & mapData)
+            : Object(type),
+              mapData(mapData) { }
+    };
+
+    using MapValuePtr = std::shared_ptr<MapValue>;
+
+    inline std::size_t
+    combineHashes(std::size_t seed, const std::size_t hash) {
+        return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    inline bool
+    valuesEqual(const Value & value1, const Value & value2) {
+        if (value1.dataType() != value2.dataType()) {
+            return false;
+        }
+
+        switch (value1.dataType()) {
+            case Types::DataTypes::INT:
+                return value1.intData() == value2.intData();
+            case Types::DataTypes::CHAR:
+                return value1.charData() == value2.charData();
+            case Types::DataTypes::BOOL:
+                return value1.boolData() == value2.boolData();
+            case Types::DataTypes::NULLVAL:
+                return true;
+            case Types::DataTypes::STRING:
+                return value1.as<StringValue>()->view() == value2.as<StringValue>()->view();
+            case Types::DataTypes::LIST: {
+                const auto & listData1 = value1.as<ListValue>()->listData;
+                const auto & listData2 = value2.as<ListValue>()->listData;
+
+                if (listData1.sharesAllWith(listData2)) {
+                    return true;
+                } else if (listData1.size() != listData2.size()) {
+                    return false;
+                }
+                return std::equal(listData1.begin(), listData1.end(), listData2.begin(), ValueEqual());
+            }
+            case Types::DataTypes::TUPLE: {
+                const auto & tupleData1 = value1.as<TupleValue>()->tupleData;
+                const auto & tupleData2 = value2.as<TupleValue>()->tupleData;
+
+                return tupleData1.size() == tupleData2.size() &&
+                       std::equal(tupleData1.begin(), tupleData1.end(), tupleData2.begin(), ValueEqual());
+            }
+            case Types::DataTypes::SET: {
+                const auto & setData1 = value1.as<SetValue>()->setData;
+                const auto & setData2 = value2.as<SetValue>()->setData;
+
+                if (setData1.size() != setData2.size()) {
+                    return false;
+                }
+                bool equal = true;
+                setData1.forEach([&](const Value & element, const Value &) {
+                    equal = equal && setData2.contains(element);
+                });
+                return equal;
+            }
+            case Types::DataTypes::MAP: {
+                const auto & mapData1 = value1.as<MapValue>()->mapData;
+                const auto & mapData2 = value2.as<MapValue>()->mapData;
+
+                if (mapData1.size() != mapData2.size()) {
+                    return false;
+                }
+                bool equal = true;
+                mapData1.forEach([&](const Value & key, const Value & mappedValue) {
+                    auto otherMappedValue = (equal) ? mapData2.find(key) : nullptr;
+                    equal = otherMappedValue && valuesEqual(mappedValue, *otherMappedValue);
+                });
+                return equal;
+            }
+            case Types::DataTypes::TYPECLASS: {
+                auto typeclassValue1 = value1.as<TypeclassValue>();
+                auto typeclassValue2 = value2.as<TypeclassValue>();
+
+                // the same type lays its fields out the same way
+                if (typeclassValue1->type->toString() != typeclassValue2->type->toString() ||
+                    typeclassValue1->fields.size() != typeclassValue2->fields.size()) {
+                    return false;
+                }
+                return std::equal(typeclassValue1->fields.begin(), typeclassValue1->fields.end(), typeclassValue2->fields.begin(), valuesEqual);
+            }
+            case Types::DataTypes::FUNC:
+                return value1.as<Object>() == value2.as<Object>();
+            default:
+                return false;
+        }
+    }
+
+    inline std::size_t
+    hashValue(const Value & value) {
+        auto seed = static_cast<std::size_t>(value.dataType());
+
+        switch (value.dataType()) {
+            case Types::DataTypes::INT:
+                return combineHashes(seed, std::hash<int>()(value.intData()));
+            case Types::DataTypes::CHAR:
+                return combineHashes(seed, std::hash<char>()(value.charData()));
+            case Types::DataTypes::BOOL:
+                return combineHashes(seed, std::hash<bool>()(value.boolData()));
+            case Types::DataTypes::STRING:
+                return combineHashes(seed, std::hash<std::string_view>()(value.as<StringValue>()->view()));
+            case Types::DataTypes::LIST:
+                for (const auto & element : value.as<ListValue>()->listData) {
+                    seed = combineHashes(seed, hashValue(element));
+                }
+                return seed;
+            case Types::DataTypes::TUPLE:
+                for (const auto & element : value.as<TupleValue>()->tupleData) {
+                    seed = combineHashes(seed, hashValue(element));
+                }
+                return seed;
+            case Types::DataTypes::SET: {
+                // summed so that the order the elements are stored in does not matter
+                std::size_t elementsHash = 0;
+                value.as<SetValue>()->setData.forEach([&elementsHash](const Value & element, const Value &) {
+                    elementsHash += hashValue(element);
+                });
+                return combineHashes(seed, elementsHash);
+            }
+            case Types::DataTypes::MAP: {
+                std::size_t entriesHash = 0;
+                value.as<MapValue>()->mapData.forEach([&entriesHash](const Value & key, const Value & mappedValue) {
+                    entriesHash += combineHashes(hashValue(key), hashValue(mappedValue));
+                });
+                return combineHashes(seed, entriesHash);
+            }
+            case Types::DataTypes::TYPECLASS: {
+                auto typeclassValue = value.as<TypeclassValue>();
+                seed = combineHashes(seed, std::hash<std::string>()(typeclassValue->type->toString()));
+                for (const auto & field : typeclassValue->fields) {
+                    seed = combineHashes(seed, hashValue(field));
+                }
+                return seed;
+            }
+            case Types::DataTypes::FUNC:
+                return combineHashes(seed, std::hash<Object *>()(value.as<Object>().get()));
+            default:
+                return seed;
+        }
+    }
 }
\ No newline at end of file
@@ -1,108 +1,15 @@
 #include <string>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
 #include "core/lexer/lexer.hpp"
-#include "core/parser/parser.hpp"
-#include "core/typeChecker/typeChecker.hpp"
-#include "core/cpsConverter/cpsConverter.hpp"
-#include "core/interpreter/interpreter.hpp"
-#include "core/builtin/builtinImplementations.hpp"
+#include "core/runtime/bantRuntime.hpp"
 
+#include "utils/allocationCounter.hpp"
 #include "utils/logger.hpp"
-
-void
-displayExceptionError(const int & phase) {
-    std::string errorExitMessage = "Unexpected error occurred";
-    switch (phase) {
-        case 0:
-            errorExitMessage += std::string(" during lexing");
-            break;
-        case 1:
-            errorExitMessage += std::string(" during parsing");
-            break;
-        case 2:
-            errorExitMessage += std::string(" during type checking");
-            break;
-        case 3:
-            errorExitMessage += std::string(" during interpretation");
-            break;
-        default:
-            break;
-    }
-    errorExitMessage += std::string(", exiting");
-
-    ERROR(errorExitMessage);
-}
-
-void
-runBant(const std::string & sourceStream, const bool & runWithBuiltins, const bool & runWithCPSPhase) {
-    int phase = 0;
-    try {
-        HEADER("Building...");
-
-        std::string lexerStream{sourceStream};
-
-        if (runWithBuiltins) {
-            lexerStream = BuiltinDefinitions::builtinDefinitions + lexerStream;
-        }
-
-        auto lexer = Lexer(lexerStream);
-        auto tokenStream = lexer.makeTokenStream();
-
-        if (lexer.errorOccurred()) {
-            ERROR("One or more errors occurred during lexing, exiting");
-            return;
-        }
-
-        phase++;
-
-        auto parser = Parser(tokenStream);
-        auto tree = parser.makeTree();
-
-        if (parser.errorOccurred()) {
-            ERROR("One or more errors occurred during parsing, exiting");
-            return;
-        }
-
-        phase++;
-
-        auto typeChecker = TypeChecker(tree);
-        typeChecker.check();
-
-        if (typeChecker.errorOccurred()) {
-            ERROR("One or more errors occurred during type checking, exiting");
-            return;
-        }
-
-        if (runWithCPSPhase) {
-            auto cpsConverter = CPSConverter(tree);
-            cpsConverter.convert();
-        }
-
-        HEADER("Successful Build, Running...");
-
-        phase++;
-        
-        auto interpreter = Interpreter(tree);
-        BuiltinImplementations::interpreter = interpreter;
-        interpreter.run();
-
-        if (interpreter.errorOccurred()) {
-            ERROR("One or more errors occurred at runtime, exiting");
-            return;
-        }
-    } catch (HaltException & haltException) {
-        return;
-    } catch (RuntimeException & runtimeException) {
-        ERROR("Exiting.");
-        return;
-    } catch (std::runtime_error & runtimeError) {
-        displayExceptionError(phase);
-    } catch (std::logic_error & logicError) {
-        displayExceptionError(phase);
-    }
-}
+#include "utils/output.hpp"
+#include "utils/threadPool.hpp"
 
 char *
 getCmdOption(char ** begin, char ** end, const std::string & option) {
@@ -118,13 +25,34 @@ cmdOptionExists(char ** begin, char ** end, const std::string & option) {
     return std::find(begin, end, option) != end;
 }
 
+// Runs each script named in input, one path per line, on the same runtime,
+// so a script run before is not built again. After a script's output comes
+// a line "--- ok <path>" or "--- error <path>". Blank lines and lines
+// starting with # are skipped.
+void
+runScripts(BantRuntime & runtime, std::istream & input) {
+    std::string scriptPath;
+    while (std::getline(input, scriptPath)) {
+        auto end = scriptPath.find_last_not_of(" \t\r");
+        scriptPath.erase((end == std::string::npos) ? 0 : end + 1);
+        scriptPath.erase(0, scriptPath.find_first_not_of(" \t"));
+        if (scriptPath.empty() || scriptPath.front() == '#') {
+            continue;
+        }
+
+        auto sourceStream = Lexer::readFile(scriptPath);
+        auto succeeded = !sourceStream.empty() && runtime.run(sourceStream);
+        Output::write(std::string("--- ") + ((succeeded) ? "ok " : "error ") + scriptPath + '\n');
+        Output::flush();
+    }
+}
+
 int
 main(int argc, char ** argv) {
+    Output::buffer();
     std::string sourceStream;
 
-    Logger::getInstance();
-
-    bool runWithBuiltins = true, runWithCPSPhase = false;
+    RunOptions options;
     std::string filePath;
     if (argc == 1) {
         ERROR("Error: Source file required");
@@ -132,17 +60,75 @@ main(int argc, char ** argv) {
     }
     
     if (cmdOptionExists(argv, argv + argc, "-d")) { // Debug
-        Logger::getInstance().setLevel(DEBUG);
+        options.debug = true;
     }
     
     if (cmdOptionExists(argv, argv + argc, "-nb")) { // No Builtins
-        runWithBuiltins = false;
+        options.runWithBuiltins = false;
     }
 
     if (cmdOptionExists(argv, argv + argc, "-c")) { // Use CPS Phase
-        runWithCPSPhase = true;
+        options.runWithCPSPhase = true;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-O1")) { // Fold constants, drop dead lets
+        options.optimizationLevel = 1;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-O2")) { // Also inline small functions
+        options.optimizationLevel = 2;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-vm")) { // Run compiled bytecode
+        options.runWithVM = true;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-j")) { // Threads the parallel builtins run on
+        auto threadCount = getCmdOption(argv, argv + argc, "-j");
+        ThreadPool::setThreadCount((threadCount) ? static_cast<unsigned int>(std::max(1, std::atoi(threadCount))) : 1);
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-profile")) { // Time each function, optionally naming the collapsed stacks file
+        options.profile = true;
+        auto profilePath = getCmdOption(argv, argv + argc, "-profile");
+        if (profilePath && profilePath[0] != '-') {
+            options.profilePath = profilePath;
+        }
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-mem-stats")) { // Report live objects, peak bytes and collections after each run
+        options.memStats = true;
+        Values::LiveCounts::counting = true;
+        AllocationCounter::trackLiveBytes();
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-phase-times")) { // Report the time each phase took and peak memory after each run
+        options.phaseTimes = true;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-no-cache")) { // Rebuild even if the compiled program is cached
+        options.useCache = false;
     }
     
+    if (cmdOptionExists(argv, argv + argc, "-serve")) { // Run the scripts named on stdin as they arrive
+        auto runtime = BantRuntime(options);
+        runScripts(runtime, std::cin);
+        return 0;
+    }
+
+    if (cmdOptionExists(argv, argv + argc, "-batch")) { // Run the scripts named in a manifest file
+        auto manifestPath = getCmdOption(argv, argv + argc, "-batch");
+        std::ifstream manifest((manifestPath) ? manifestPath : "");
+        if (!manifest.is_open()) {
+            ERROR(std::string("Error: Could not open manifest: ") + ((manifestPath) ? manifestPath : ""));
+            exit(2);
+        }
+
+        auto runtime = BantRuntime(options);
+        runScripts(runtime, manifest);
+        return 0;
+    }
+
     if (cmdOptionExists(argv, argv + argc, "-f")) { // File Path
         filePath = std::string(getCmdOption(argv, argv + argc, "-f"));
     }
@@ -157,5 +143,6 @@ main(int argc, char ** argv) {
     if (sourceStream.empty())
         exit(3);
     
-    runBant(sourceStream, runWithBuiltins, runWithCPSPhase);
+    auto runtime = BantRuntime(options);
+    runtime.run(sourceStream);
 }
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "allocationCounter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+    thread_local std::size_t allocationCount = 0;
+    thread_local std::size_t allocatedByteCount = 0;
+
+    std::atomic<bool> tracking{false};
+    // signed: a block allocated before tracking began may be freed after
+    std::atomic<long long> liveByteCount{0};
+    std::atomic<long long> peakLiveByteCount{0};
+
+    // what free will hand back, where the allocator can say
+    std::size_t
+    usableSize(void * allocation) {
+#if defined(__GLIBC__)
+        return malloc_usable_size(allocation);
+#else
+        (void) allocation;
+        return 0;
+#endif
+    }
+
+    void
+    addLiveBytes(std::size_t size) {
+        auto change = static_cast<long long>(size);
+        auto live = liveByteCount.fetch_add(change, std::memory_order_relaxed) + change;
+        auto peak = peakLiveByteCount.load(std::memory_order_relaxed);
+        while (live > peak && !peakLiveByteCount.compare_exchange_weak(peak, live, std::memory_order_relaxed)) { }
+    }
+
+    void
+    release(void * allocation) {
+        if (allocation && tracking.load(std::memory_order_relaxed)) {
+            liveByteCount.fetch_sub(static_cast<long long>(usableSize(allocation)), std::memory_order_relaxed);
+        }
+        std::free(allocation);
+    }
+}
+
+std::size_t
+AllocationCounter::allocations() {
+    return allocationCount;
+}
+
+std::size_t
+AllocationCounter::allocatedBytes() {
+    return allocatedByteCount;
+}
+
+void
+AllocationCounter::trackLiveBytes() {
+    tracking.store(true);
+}
+
+bool
+AllocationCounter::tracksLiveBytes() {
+    return tracking.load(std::memory_order_relaxed);
+}
+
+std::size_t
+AllocationCounter::liveBytes() {
+    return static_cast<std::size_t>(std::max(0ll, liveByteCount.load(std::memory_order_relaxed)));
+}
+
+std::size_t
+AllocationCounter::peakLiveBytes() {
+    return static_cast<std::size_t>(std::max(0ll, peakLiveByteCount.load(std::memory_order_relaxed)));
+}
+
+void
+AllocationCounter::resetPeakLiveBytes() {
+    peakLiveByteCount.store(liveByteCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// the array and nothrow forms all allocate through this one
+void *
+operator new(std::size_t size) {
+    ++allocationCount;
+    allocatedByteCount += size;
+    if (void * allocation = std::malloc((size > 0) ? size : 1)) {
+        if (tracking.load(std::memory_order_relaxed)) {
+            addLiveBytes(usableSize(allocation));
+        }
+        return allocation;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void * allocation) noexcept {
+    release(allocation);
+}
+
+void
+operator delete(void * allocation, std::size_t) noexcept {
+    release(allocation);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocations made so far by the calling thread. Every operator new
+// counts itself here, so the difference between two readings is what the
+// code run in between allocated.
+//
+// Once tracking is turned on, the bytes held by every thread are also
+// followed as they are allocated and freed, along with the most they have
+// come to. That takes an atomic update per allocation, so it is off unless
+// asked for.
+namespace AllocationCounter {
+    std::size_t allocations();
+    std::size_t allocatedBytes();
+
+    void trackLiveBytes();
+    bool tracksLiveBytes();
+    std::size_t liveBytes();
+    std::size_t peakLiveBytes();
+    // from here on the peak counts up from what is live now
+    void resetPeakLiveBytes();
+}
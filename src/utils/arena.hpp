@@ -0,0 +1,88 @@
+#pragma once
+
+#include "sourceManager.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Bump allocator for the nodes of one compilation unit. Nodes are laid out
+// next to each other in large blocks, and the blocks are all freed at once
+// when the arena and every node made from it are gone. The source text
+// their tokens point into is freed along with them.
+class Arena {
+    private:
+        static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+        SourceManager sourceManager;
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        std::byte * next = nullptr;
+        std::size_t remaining = 0;
+        std::size_t allocatedBytes = 0;
+
+    public:
+        Arena() = default;
+        Arena(const Arena &) = delete;
+        Arena & operator=(const Arena &) = delete;
+
+        void * allocate(const std::size_t size, const std::size_t alignment) {
+            std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(next) % alignment) % alignment;
+            if (next == nullptr || padding + size > remaining) {
+                const std::size_t blockSize = std::max(BLOCK_SIZE, size + alignment);
+                blocks.emplace_back(new std::byte[blockSize]);
+                next = blocks.back().get();
+                remaining = blockSize;
+                padding = (alignment - reinterpret_cast<std::uintptr_t>(next) % alignment) % alignment;
+            }
+
+            void * allocation = next + padding;
+            next += padding + size;
+            remaining -= padding + size;
+            allocatedBytes += size;
+            return allocation;
+        }
+
+        std::size_t bytesAllocated() const { return allocatedBytes; }
+
+        SourceManager & sources() { return sourceManager; }
+};
+
+using ArenaPtr = std::shared_ptr<Arena>;
+
+// Hands out arena memory to std::allocate_shared. Every allocation keeps
+// the arena alive, so a node that outlives its compilation unit, such as
+// a function held by a cached chunk, stays valid.
+template<typename T>
+class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        ArenaPtr arena;
+
+        explicit ArenaAllocator(const ArenaPtr & arena) : arena(arena) { }
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U> & other) : arena(other.arena) { }
+
+        T * allocate(const std::size_t count) {
+            return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, const std::size_t) noexcept { }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U> & other) const { return arena == other.arena; }
+
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U> & other) const { return arena != other.arena; }
+};
+
+// std::make_shared for nodes that live in arena
+template<typename T, typename... Arguments>
+std::shared_ptr<T>
+makeInArena(const ArenaPtr & arena, Arguments &&... arguments) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Arguments>(arguments)...);
+}
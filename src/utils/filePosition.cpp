@@ -1,4 +1,4 @@
 #include "filePosition.hpp"
 
-FilePosition::FilePosition(const int line, const int column, const std::string & text) 
-: fileLine(line), fileColumn(column), currentLineText(text) { }
\ No newline at end of file
+FilePosition::FilePosition(const int line, const int column, const std::string_view & text) 
+: fileLine(line), fileColumn(column), lineText(text) { }
\ No newline at end of file
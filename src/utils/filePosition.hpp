@@ -1,11 +1,16 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 class FilePosition {
     public:
         int fileLine, fileColumn = 0;
-        std::string currentLineText = "";
-        
-        FilePosition(const int line, const int column, const std::string & text);
+        // the line up to the token, a view into text kept by the SourceManager
+        std::string_view lineText{};
+
+        FilePosition(const int line, const int column, const std::string_view & text);
+        FilePosition(const int line, const int column, std::string && text) = delete;
+
+        const std::string currentLineText() const { return std::string(lineText); }
 };
\ No newline at end of file
@@ -8,9 +8,11 @@
 #include <iostream>
 #include <stdarg.h>
 
-#define LOG(level, ...) Logger::getInstance().log(std::string(__FILE__), std::to_string(__LINE__), std::string(__FUNCTION__), level, __VA_ARGS__)
+#include "output.hpp"
+
+#define LOG(level, ...) Logger::current().log(std::string(__FILE__), std::to_string(__LINE__), std::string(__FUNCTION__), level, __VA_ARGS__)
 #define ERROR(errorString) Logger::error(errorString)
-#define HEADER(title) Logger::getInstance().header(title)
+#define HEADER(title) Logger::current().header(title)
 
 enum Level {
     INFO,
@@ -20,22 +22,41 @@ enum Level {
     DEBUG
 };
 
+// Each BantRuntime owns a logger and binds it to its thread while it runs,
+// so a program's debug output follows its own runtime's level. Outside of
+// any runtime the default logger, which stays at INFO, is current.
 class Logger final {
     private:
-        Logger() : logLevel(INFO) { }
-        virtual ~Logger() { }
-
         Level logLevel;
 
         static constexpr int LOG_BUFFER_SIZE = 1024;
         const std::string headerString = "==============================";
 
-    public:
-        static Logger & getInstance() {
-            static Logger logger;
+        static Logger *& boundLogger() {
+            static Logger defaultLogger;
+            thread_local Logger * logger = &defaultLogger;
             return logger;
         }
 
+    public:
+        Logger() : logLevel(INFO) { }
+
+        // logger bound to the calling thread
+        static Logger & current() { return *boundLogger(); }
+
+        // makes logger current on this thread for the life of the scope
+        class Scope {
+            private:
+                Logger * previousLogger;
+
+            public:
+                explicit Scope(Logger & logger) : previousLogger(boundLogger()) { boundLogger() = &logger; }
+                ~Scope() { boundLogger() = previousLogger; }
+
+                Scope(const Scope &) = delete;
+                Scope & operator=(const Scope &) = delete;
+        };
+
         void setLevel(const Level & level) noexcept { logLevel = level; }
         const Level getLevel() const noexcept { return logLevel; }
 
@@ -79,7 +100,7 @@ class Logger final {
         }
 
         static void error(const std::string & errorString) noexcept {
-            std::cout << "\033[1;31m" << errorString << "\033[0m" << std::endl;
+            Output::write(std::string("\033[1;31m") + errorString + "\033[0m\n");
         }
 
         void header(const std::string & title) const noexcept {
@@ -0,0 +1,60 @@
+#include "mappedFile.hpp"
+
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BANT_MAPPED_FILES 1
+#endif
+
+namespace {
+    constexpr std::size_t READ_CHUNK_SIZE = 1 << 16;
+}
+
+MappedFile::MappedFile(const std::string & path) {
+#if defined(BANT_MAPPED_FILES)
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        struct stat status;
+        if (::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+            auto size = static_cast<std::size_t>(status.st_size);
+            void * address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                ::madvise(address, size, MADV_SEQUENTIAL);
+                mapping = address;
+                mappingSize = size;
+                contents = std::string_view(static_cast<const char *>(address), size);
+                opened = true;
+            }
+        }
+        ::close(descriptor);
+        if (opened) {
+            return;
+        }
+    }
+#endif
+
+    // empty files, pipes, and systems without mmap
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    char chunk[READ_CHUNK_SIZE];
+    while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0) {
+        buffer.append(chunk, static_cast<std::size_t>(file.gcount()));
+    }
+    contents = buffer;
+    opened = true;
+}
+
+MappedFile::~MappedFile() {
+#if defined(BANT_MAPPED_FILES)
+    if (mapping) {
+        ::munmap(mapping, mappingSize);
+    }
+#endif
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// The contents of a file, read without copying them where the system can
+// map the file into memory, and read into a buffer in large chunks where
+// it cannot. The view stays valid for the life of the MappedFile.
+class MappedFile {
+    private:
+        void * mapping = nullptr;
+        std::size_t mappingSize = 0;
+        std::string buffer; // the contents, when not mapped
+        std::string_view contents;
+        bool opened = false;
+
+    public:
+        explicit MappedFile(const std::string & path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        bool isOpen() const { return opened; }
+        std::string_view data() const { return contents; }
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <array>
 
@@ -12,7 +13,7 @@ namespace Operator {
     };
 
     inline OperatorTypes
-    getOperator(const std::string & text) {
+    getOperator(const std::string_view & text) {
         OperatorTypes op = OperatorTypes::NONE;
         if (text == "+") op = OperatorTypes::PLUS;
         else if (text == "-") op = OperatorTypes::MINUS;
@@ -39,13 +40,13 @@ namespace Operator {
     }
 
     inline bool
-    isUnaryOperator(const std::string & op) {
-        return (op == std::string("+") || op == std::string("-") || op == std::string("!"));
+    isUnaryOperator(const std::string_view & op) {
+        return (op == "+" || op == "-" || op == "!");
     }
 
     inline bool
-    isBinaryOperator(const std::string & op, int min) {
-        static std::array<std::string, 14> ops = {
+    isBinaryOperator(const std::string_view & op, int min) {
+        static constexpr std::array<std::string_view, 14> ops = {
             "+", "-", "*", "/", "%", "&&", "||",
             "<", ">", "!", "==", "!=", "<=", ">="
         };
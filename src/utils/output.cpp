@@ -0,0 +1,25 @@
+#include "output.hpp"
+
+#include <iostream>
+#include <mutex>
+
+namespace {
+    std::mutex outputMutex;
+}
+
+void
+Output::buffer() {
+    std::ios::sync_with_stdio(false);
+}
+
+void
+Output::write(const std::string & text) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void
+Output::flush() {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout.flush();
+}
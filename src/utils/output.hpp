@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// The standard output of Bant programs and their errors. std::cout is
+// taken off its sync with stdio, so that it writes in blocks rather than
+// going through stdio on every write, and it is flushed when the process
+// exits, when a program halts, and before stdin is read or a report is
+// written to stderr. Writes are serialized, since builtins run on the
+// workers of the parallel builtins can print too.
+namespace Output {
+    // before anything is written or read
+    void buffer();
+
+    void write(const std::string & text);
+    void flush();
+}
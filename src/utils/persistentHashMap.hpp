@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Hash array mapped trie with value semantics and structural sharing.
+// Each level consumes five bits of the key's hash, so lookup, insert and
+// erase touch O(log32 n) nodes and a copy is one pointer. As with
+// PersistentVector, nodes are copied on write only while another copy
+// still refers to them.
+template<typename K, typename V, typename Hash, typename KeyEqual>
+class PersistentHashMap {
+    private:
+        static constexpr unsigned int BITS = 5;
+        static constexpr std::size_t HASH_BITS = sizeof(std::size_t) * 8;
+
+        class Node;
+        using NodePtr = std::shared_ptr<Node>;
+
+        // a leaf holds every entry whose key hashes to hash, a branch holds
+        // one child per set bit of bitmap, in bit order
+        class Node {
+            public:
+                std::uint32_t bitmap = 0;
+                std::vector<NodePtr> children;
+                std::size_t hash = 0;
+                std::vector<std::pair<K, V>> entries;
+
+                bool isLeaf() const { return children.empty(); }
+        };
+
+        NodePtr root;
+        std::size_t entryCount = 0;
+
+        static unsigned int bitOf(const std::size_t hash, const std::size_t shift) {
+            return (shift < HASH_BITS) ? static_cast<unsigned int>((hash >> shift) & 31) : 0;
+        }
+
+        // position in children of the child for bit
+        static std::size_t childIndex(const std::uint32_t bitmap, const unsigned int bit) {
+            auto below = bitmap & ((std::uint32_t(1) << bit) - 1);
+            std::size_t count = 0;
+            for (; below; below &= below - 1) {
+                ++count;
+            }
+            return count;
+        }
+
+        static NodePtr makeLeaf(const std::size_t hash, const K & key, const V & value) {
+            auto leaf = std::make_shared<Node>();
+            leaf->hash = hash;
+            leaf->entries.emplace_back(key, value);
+            return leaf;
+        }
+
+        static void detach(NodePtr & node) {
+            if (node.use_count() > 1) {
+                node = std::make_shared<Node>(*node);
+            }
+        }
+
+        // true if key was not in the map before
+        static bool insert(NodePtr & node, const std::size_t shift, const std::size_t hash, const K & key, const V & value) {
+            if (!node) {
+                node = makeLeaf(hash, key, value);
+                return true;
+            }
+
+            if (node->isLeaf()) {
+                if (node->hash == hash) {
+                    detach(node);
+                    for (auto & entry : node->entries) {
+                        if (KeyEqual()(entry.first, key)) {
+                            entry.second = value;
+                            return false;
+                        }
+                    }
+                    node->entries.emplace_back(key, value);
+                    return true;
+                }
+
+                // the leaf moves one level down, under a branch for this level
+                auto branch = std::make_shared<Node>();
+                branch->bitmap = std::uint32_t(1) << bitOf(node->hash, shift);
+                branch->children.push_back(node);
+                node = branch;
+            } else {
+                detach(node);
+            }
+
+            auto bit = bitOf(hash, shift);
+            auto index = childIndex(node->bitmap, bit);
+            if (node->bitmap & (std::uint32_t(1) << bit)) {
+                return insert(node->children[index], shift + BITS, hash, key, value);
+            }
+            node->bitmap |= std::uint32_t(1) << bit;
+            node->children.insert(node->children.begin() + index, makeLeaf(hash, key, value));
+            return true;
+        }
+
+        // key must be in the map
+        static void erase(NodePtr & node, const std::size_t shift, const std::size_t hash, const K & key) {
+            detach(node);
+            if (node->isLeaf()) {
+                for (auto entry = node->entries.begin(); entry != node->entries.end(); ++entry) {
+                    if (KeyEqual()(entry->first, key)) {
+                        node->entries.erase(entry);
+                        break;
+                    }
+                }
+                if (node->entries.empty()) {
+                    node = nullptr;
+                }
+                return;
+            }
+
+            auto bit = bitOf(hash, shift);
+            auto index = childIndex(node->bitmap, bit);
+            erase(node->children[index], shift + BITS, hash, key);
+            if (!node->children[index]) {
+                node->children.erase(node->children.begin() + index);
+                node->bitmap &= ~(std::uint32_t(1) << bit);
+            }
+
+            // a lone leaf is found by its hash at any depth, so it can move up
+            if (node->children.empty()) {
+                node = nullptr;
+            } else if (node->children.size() == 1 && node->children.front()->isLeaf()) {
+                node = node->children.front();
+            }
+        }
+
+        template<class Visitor>
+        static void visit(const Node * node, Visitor & visitor) {
+            if (!node) {
+                return;
+            }
+            for (const auto & entry : node->entries) {
+                visitor(entry.first, entry.second);
+            }
+            for (const auto & child : node->children) {
+                visit(child.get(), visitor);
+            }
+        }
+
+    public:
+        std::size_t size() const { return entryCount; }
+        bool empty() const { return entryCount == 0; }
+
+        // value bound to key, nullptr if key is not in the map
+        const V * find(const K & key) const {
+            auto hash = Hash()(key);
+            const Node * node = root.get();
+            for (std::size_t shift = 0; node && !node->isLeaf(); shift += BITS) {
+                auto bit = bitOf(hash, shift);
+                if (!(node->bitmap & (std::uint32_t(1) << bit))) {
+                    return nullptr;
+                }
+                node = node->children[childIndex(node->bitmap, bit)].get();
+            }
+
+            if (node && node->hash == hash) {
+                for (const auto & entry : node->entries) {
+                    if (KeyEqual()(entry.first, key)) {
+                        return &entry.second;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        bool contains(const K & key) const { return find(key) != nullptr; }
+
+        // binds key to value, replacing any earlier binding
+        void insert(const K & key, const V & value) {
+            if (insert(root, 0, Hash()(key), key, value)) {
+                ++entryCount;
+            }
+        }
+
+        void erase(const K & key) {
+            if (contains(key)) {
+                erase(root, 0, Hash()(key), key);
+                --entryCount;
+            }
+        }
+
+        // calls visitor(key, value) for every entry, in no particular order
+        template<class Visitor>
+        void forEach(Visitor visitor) const {
+            visit(root.get(), visitor);
+        }
+};
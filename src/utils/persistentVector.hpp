@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Sequence with value semantics and structural sharing. Elements sit in
+// small leaves under an AVL-balanced tree of sizes, so indexing, insert,
+// erase, concatenation and slicing are O(log n) and a copy is one pointer.
+// Nodes are copied on write only while another copy still refers to them,
+// so updating a vector nothing else shares is done in place.
+template<typename T>
+class PersistentVector {
+    private:
+        static constexpr std::size_t LEAF_SIZE = 32;
+
+        class Node;
+        using NodePtr = std::shared_ptr<Node>;
+
+        class Node {
+            public:
+                NodePtr left;
+                NodePtr right;
+                std::vector<T> elements; // only used by leaves
+                std::size_t size = 0;
+                int height = 1;
+
+                bool isLeaf() const { return !left && !right; }
+        };
+
+        NodePtr root;
+
+        static std::size_t sizeOf(const NodePtr & node) { return (node) ? node->size : 0; }
+        static int heightOf(const NodePtr & node) { return (node) ? node->height : 0; }
+
+        static NodePtr makeLeaf(std::vector<T> elements) {
+            if (elements.empty()) {
+                return nullptr;
+            }
+            auto leaf = std::make_shared<Node>();
+            leaf->size = elements.size();
+            leaf->elements = std::move(elements);
+            return leaf;
+        }
+
+        static NodePtr makeNode(const NodePtr & left, const NodePtr & right) {
+            if (!left) {
+                return right;
+            } else if (!right) {
+                return left;
+            }
+            auto node = std::make_shared<Node>();
+            node->left = left;
+            node->right = right;
+            node->size = left->size + right->size;
+            node->height = 1 + std::max(left->height, right->height);
+            return node;
+        }
+
+        // node over left and right, rotated if their heights differ by more than one
+        static NodePtr balance(const NodePtr & left, const NodePtr & right) {
+            if (heightOf(left) > heightOf(right) + 1) {
+                if (heightOf(left->left) >= heightOf(left->right)) {
+                    return makeNode(left->left, makeNode(left->right, right));
+                }
+                return makeNode(makeNode(left->left, left->right->left),
+                                makeNode(left->right->right, right));
+            } else if (heightOf(right) > heightOf(left) + 1) {
+                if (heightOf(right->right) >= heightOf(right->left)) {
+                    return makeNode(makeNode(left, right->left), right->right);
+                }
+                return makeNode(makeNode(left, right->left->left),
+                                makeNode(right->left->right, right->right));
+            }
+            return makeNode(left, right);
+        }
+
+        static NodePtr concat(const NodePtr & left, const NodePtr & right) {
+            if (!left) {
+                return right;
+            } else if (!right) {
+                return left;
+            } else if (left->isLeaf() && right->isLeaf() && left->size + right->size <= LEAF_SIZE) {
+                auto elements = left->elements;
+                elements.insert(elements.end(), right->elements.begin(), right->elements.end());
+                return makeLeaf(std::move(elements));
+            } else if (heightOf(left) > heightOf(right) + 1) {
+                return balance(left->left, concat(left->right, right));
+            } else if (heightOf(right) > heightOf(left) + 1) {
+                return balance(concat(left, right->left), right->right);
+            }
+            return makeNode(left, right);
+        }
+
+        // node holds [0, index), the result holds [index, size)
+        static NodePtr split(NodePtr & node, const std::size_t index) {
+            if (!node || index >= node->size) {
+                return nullptr;
+            } else if (index == 0) {
+                return std::move(node);
+            } else if (node->isLeaf()) {
+                auto rightLeaf = makeLeaf(std::vector<T>(node->elements.begin() + index, node->elements.end()));
+                node = makeLeaf(std::vector<T>(node->elements.begin(), node->elements.begin() + index));
+                return rightLeaf;
+            }
+
+            auto left = node->left;
+            auto right = node->right;
+            if (index < left->size) {
+                auto rightPart = split(left, index);
+                node = left;
+                return concat(rightPart, right);
+            }
+            auto rightPart = split(right, index - left->size);
+            node = concat(left, right);
+            return rightPart;
+        }
+
+        static NodePtr fromElements(const std::vector<T> & elements, const std::size_t begin, const std::size_t end) {
+            if (end - begin <= LEAF_SIZE) {
+                return makeLeaf(std::vector<T>(elements.begin() + begin, elements.begin() + end));
+            }
+            auto middle = begin + (end - begin) / 2;
+            return makeNode(fromElements(elements, begin, middle), fromElements(elements, middle, end));
+        }
+
+        // gives this path its own copy of node before it is changed
+        static void detach(NodePtr & node) {
+            if (node.use_count() > 1) {
+                node = std::make_shared<Node>(*node);
+            }
+        }
+
+        // node is detached and its children were just changed
+        static void rebalance(NodePtr & node) {
+            if (!node->left || !node->right) {
+                node = (node->left) ? node->left : node->right;
+            } else if (std::abs(node->left->height - node->right->height) > 1) {
+                node = balance(node->left, node->right);
+            } else {
+                node->size = node->left->size + node->right->size;
+                node->height = 1 + std::max(node->left->height, node->right->height);
+            }
+        }
+
+        static void insert(NodePtr & node, const std::size_t index, const T & value) {
+            if (!node) {
+                node = makeLeaf(std::vector<T>{value});
+                return;
+            }
+
+            detach(node);
+            if (node->isLeaf()) {
+                node->elements.insert(node->elements.begin() + index, value);
+                node->size = node->elements.size();
+                if (node->size > LEAF_SIZE) {
+                    auto half = node->elements.begin() + node->size / 2;
+                    node = makeNode(makeLeaf(std::vector<T>(node->elements.begin(), half)),
+                                    makeLeaf(std::vector<T>(half, node->elements.end())));
+                }
+                return;
+            }
+
+            if (index < node->left->size) {
+                insert(node->left, index, value);
+            } else {
+                insert(node->right, index - node->left->size, value);
+            }
+            rebalance(node);
+        }
+
+        static void erase(NodePtr & node, const std::size_t index) {
+            detach(node);
+            if (node->isLeaf()) {
+                node->elements.erase(node->elements.begin() + index);
+                node->size = node->elements.size();
+                if (node->size == 0) {
+                    node = nullptr;
+                }
+                return;
+            }
+
+            if (index < node->left->size) {
+                erase(node->left, index);
+            } else {
+                erase(node->right, index - node->left->size);
+            }
+            rebalance(node);
+        }
+
+        static void set(NodePtr & node, const std::size_t index, const T & value) {
+            detach(node);
+            if (node->isLeaf()) {
+                node->elements[index] = value;
+            } else if (index < node->left->size) {
+                set(node->left, index, value);
+            } else {
+                set(node->right, index - node->left->size, value);
+            }
+        }
+
+        template<typename Visit>
+        static void forEachLeaf(const Node * node, const Visit & visit) {
+            if (!node) {
+                return;
+            } else if (node->isLeaf()) {
+                visit(node->elements.data(), node->elements.size());
+                return;
+            }
+            forEachLeaf(node->left.get(), visit);
+            forEachLeaf(node->right.get(), visit);
+        }
+
+        // leaf holding index, and the position of index in it
+        static const Node * findLeaf(const Node * node, std::size_t & index) {
+            while (!node->isLeaf()) {
+                if (index < node->left->size) {
+                    node = node->left.get();
+                } else {
+                    index -= node->left->size;
+                    node = node->right.get();
+                }
+            }
+            return node;
+        }
+
+    public:
+        // walks the leaves in order; keeps the tree it walks alive, so
+        // changing the vector while iterating leaves the iteration as it was
+        class Iterator {
+            private:
+                NodePtr root;
+                const Node * leaf = nullptr;
+                std::size_t leafIndex = 0;
+                std::size_t index = 0;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const T *;
+                using reference = const T &;
+
+                Iterator(const NodePtr & root, const std::size_t index)
+                : root(root),
+                  leafIndex(index),
+                  index(index) {
+                    if (index < sizeOf(root)) {
+                        leaf = findLeaf(root.get(), leafIndex);
+                    }
+                }
+
+                reference operator*() const { return leaf->elements[leafIndex]; }
+                pointer operator->() const { return &leaf->elements[leafIndex]; }
+
+                Iterator & operator++() {
+                    ++index;
+                    if (++leafIndex == leaf->elements.size() && index < root->size) {
+                        leafIndex = index;
+                        leaf = findLeaf(root.get(), leafIndex);
+                    }
+                    return *this;
+                }
+
+                Iterator operator++(int) {
+                    auto previous = *this;
+                    ++(*this);
+                    return previous;
+                }
+
+                bool operator==(const Iterator & other) const { return index == other.index; }
+                bool operator!=(const Iterator & other) const { return index != other.index; }
+        };
+
+        PersistentVector() = default;
+
+        PersistentVector(const std::vector<T> & elements)
+        : root((elements.empty()) ? nullptr : fromElements(elements, 0, elements.size())) { }
+
+        std::size_t size() const { return sizeOf(root); }
+        bool empty() const { return !root; }
+
+        const T & at(std::size_t index) const {
+            if (index >= size()) {
+                throw std::out_of_range("PersistentVector::at");
+            }
+            return findLeaf(root.get(), index)->elements[index];
+        }
+
+        Iterator begin() const { return Iterator(root, 0); }
+        Iterator end() const { return Iterator(nullptr, size()); }
+
+        std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+        // calls visit(elements, count) with each leaf's elements, in order,
+        // for loops that run over a contiguous array at a time
+        template<typename Visit>
+        void forEachLeaf(const Visit & visit) const { forEachLeaf(root.get(), visit); }
+
+        // true if other is this vector or an unchanged copy of it
+        bool sharesAllWith(const PersistentVector & other) const { return root == other.root; }
+
+        // index may be size(), which appends
+        void insert(const std::size_t index, const T & value) { insert(root, index, value); }
+        void erase(const std::size_t index) { erase(root, index); }
+        void set(const std::size_t index, const T & value) { set(root, index, value); }
+
+        void pushFront(const T & value) { insert(0, value); }
+        void pushBack(const T & value) { insert(size(), value); }
+        void popFront() { erase(0); }
+        void popBack() { erase(size() - 1); }
+
+        void append(const PersistentVector & other) { root = concat(root, other.root); }
+
+        // elements [begin, end)
+        PersistentVector slice(const std::size_t begin, const std::size_t end) const {
+            PersistentVector result;
+            result.root = root;
+            split(result.root, end);
+            result.root = split(result.root, begin);
+            return result;
+        }
+};
@@ -44,7 +44,7 @@ void PrettyPrint::print(ExpPtr expression) {
 }
 
 void PrettyPrint::printProgram(ExpPtr expression) {
-    auto program = std::static_pointer_cast<Program>(expression);
+    auto program = static_cast<Program *>(expression.get());
     printLine("PROGRAM");
     
     spaceCount++;
@@ -69,7 +69,7 @@ void PrettyPrint::printProgram(ExpPtr expression) {
 }
 
 void PrettyPrint::printFunctionDefinition(ExpPtr expression) {
-    auto function = std::static_pointer_cast<Function>(expression);
+    auto function = static_cast<Function *>(expression.get());
     
     printLine("FUNCTION");
     spaceCount++;
@@ -111,7 +111,7 @@ void PrettyPrint::printFunctionDefinition(ExpPtr expression) {
 }
 
 void PrettyPrint::printLiteral(ExpPtr expression) {
-    auto literal = std::static_pointer_cast<Literal>(expression);
+    auto literal = static_cast<Literal *>(expression.get());
 
     if (literal->returnType->dataType == Types::DataTypes::INT)
         print("INT LITERAL: " + std::to_string(literal->getData<int>()));
@@ -125,7 +125,7 @@ void PrettyPrint::printLiteral(ExpPtr expression) {
 }
 
 void PrettyPrint::printPrimitive(ExpPtr expression) {
-    auto primitive = std::static_pointer_cast<Primitive>(expression);
+    auto primitive = static_cast<Primitive *>(expression.get());
 
     printLine("PRIMITIVE");
     spaceCount++;
@@ -169,7 +169,7 @@ void PrettyPrint::printPrimitive(ExpPtr expression) {
 }
 
 void PrettyPrint::printLet(ExpPtr expression) {
-    auto let = std::static_pointer_cast<Let>(expression);
+    auto let = static_cast<Let *>(expression.get());
 
     printLine("LET");
     spaceCount++;
@@ -190,7 +190,7 @@ void PrettyPrint::printLet(ExpPtr expression) {
 }
 
 void PrettyPrint::printReference(ExpPtr expression) {
-    auto reference = std::static_pointer_cast<Reference>(expression);
+    auto reference = static_cast<Reference *>(expression.get());
 
     printLine("REFERENCE");
     spaceCount++;
@@ -199,7 +199,7 @@ void PrettyPrint::printReference(ExpPtr expression) {
 }
 
 void PrettyPrint::printBranch(ExpPtr expression) {
-    auto branch = std::static_pointer_cast<Branch>(expression);
+    auto branch = static_cast<Branch *>(expression.get());
 
     printLine("BRANCH");
     spaceCount++;
@@ -221,7 +221,7 @@ void PrettyPrint::printBranch(ExpPtr expression) {
 }
 
 void PrettyPrint::printTypeclass(ExpPtr expression) {
-    auto typeclass = std::static_pointer_cast<Typeclass>(expression);
+    auto typeclass = static_cast<Typeclass *>(expression.get());
 
     printLine("TYPECLASS: " + typeclass->ident);
     
@@ -241,7 +241,7 @@ void PrettyPrint::printTypeclass(ExpPtr expression) {
 }
 
 void PrettyPrint::printApplication(ExpPtr expression) {
-    auto application = std::static_pointer_cast<Application>(expression);
+    auto application = static_cast<Application *>(expression.get());
 
     printLine("APPLICATION");
     spaceCount++;
@@ -283,7 +283,7 @@ void PrettyPrint::printApplication(ExpPtr expression) {
 }
 
 void PrettyPrint::printListDefinition(ExpPtr expression) {
-    auto listDefinition = std::static_pointer_cast<ListDefinition>(expression);
+    auto listDefinition = static_cast<ListDefinition *>(expression.get());
 
     printLine("LIST DEFINITION");
 
@@ -303,7 +303,7 @@ void PrettyPrint::printListDefinition(ExpPtr expression) {
 }
 
 void PrettyPrint::printTupleDefinition(ExpPtr expression) {
-    auto tupleDefinition = std::static_pointer_cast<TupleDefinition>(expression);
+    auto tupleDefinition = static_cast<TupleDefinition *>(expression.get());
 
     printLine("TUPLE DEFINITION");
 
@@ -323,7 +323,7 @@ void PrettyPrint::printTupleDefinition(ExpPtr expression) {
 }
 
 void PrettyPrint::printMatch(ExpPtr expression) {
-    auto match = std::static_pointer_cast<Match>(expression);
+    auto match = static_cast<Match *>(expression.get());
 
     printLine("MATCH: " + match->ident);
 
@@ -343,7 +343,7 @@ void PrettyPrint::printMatch(ExpPtr expression) {
 }
 
 void PrettyPrint::printCase(ExpPtr expression) {
-    auto casePtr = std::static_pointer_cast<Case>(expression);
+    auto casePtr = static_cast<Case *>(expression.get());
 
     printLine("CASE");
     spaceCount++;
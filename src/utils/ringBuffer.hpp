@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Keeps the last Capacity entries pushed, overwriting the oldest
+template<typename EntryType, std::size_t Capacity>
+class RingBuffer {
+    private:
+        std::vector<EntryType> entries;
+        std::size_t next = 0;
+        std::size_t pushed = 0;
+
+    public:
+        RingBuffer() {
+            entries.reserve(Capacity);
+        }
+
+        void push(const EntryType & entry) {
+            if (entries.size() < Capacity) {
+                entries.push_back(entry);
+            } else {
+                entries[next] = entry;
+            }
+            next = (next + 1) % Capacity;
+            ++pushed;
+        }
+
+        std::size_t size() const { return entries.size(); }
+
+        // entries pushed before the ones still held
+        std::size_t dropped() const { return pushed - entries.size(); }
+
+        // 0 is the most recent entry
+        const EntryType & recent(const std::size_t index) const {
+            return entries[(next + Capacity - 1 - index) % Capacity];
+        }
+};
@@ -0,0 +1,12 @@
+#include "sourceManager.hpp"
+
+std::string_view
+SourceManager::intern(std::string && text) {
+    auto interned = internedSources.find(text);
+    if (interned != internedSources.end())
+        return *interned;
+
+    const std::string_view source = sources.emplace_back(std::move(text));
+    internedSources.insert(source);
+    return source;
+}
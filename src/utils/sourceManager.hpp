@@ -0,0 +1,24 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// Owns the source text the tokens of one built program point into. Each
+// distinct text is kept once, so copying a token copies no text. It
+// belongs to the arena of the program's nodes, and is freed with it once
+// the program is no longer kept.
+class SourceManager final {
+    private:
+        std::deque<std::string> sources;
+        std::unordered_set<std::string_view> internedSources;
+
+    public:
+        SourceManager() = default;
+        SourceManager(const SourceManager &) = delete;
+        SourceManager & operator=(const SourceManager &) = delete;
+
+        std::string_view intern(std::string && text);
+        std::string_view intern(const std::string_view & text) { return intern(std::string(text)); }
+};
@@ -0,0 +1,177 @@
+#include "threadPool.hpp"
+
+#include <algorithm>
+
+namespace {
+    // set while this thread runs ranges of a job, nested calls then stay on it
+    thread_local bool insideJob = false;
+}
+
+unsigned int ThreadPool::requestedThreadCount = 0;
+
+void
+ThreadPool::setThreadCount(unsigned int threadCount) {
+    requestedThreadCount = threadCount;
+}
+
+ThreadPool &
+ThreadPool::instance() {
+    static ThreadPool pool((requestedThreadCount > 0) ? requestedThreadCount
+                                                      : std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    for (unsigned int index = 0; index < threadCount; ++index) {
+        participants.push_back(std::make_unique<Participant>());
+    }
+    // participant 0 is whichever thread calls parallelFor
+    for (unsigned int index = 1; index < threadCount; ++index) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, index);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    for (auto & thread : threads) {
+        thread.join();
+    }
+}
+
+void
+ThreadPool::parallelFor(std::size_t count, const Body & body) {
+    if (count == 0) {
+        return;
+    } else if (insideJob || participants.size() == 1) {
+        body(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(callMutex);
+
+    // a few ranges per participant leaves room to even out uneven elements
+    Job currentJob;
+    currentJob.body = &body;
+    currentJob.grain = std::max<std::size_t>(1, count / (participants.size() * 8));
+    currentJob.remaining = count;
+
+    auto share = count / participants.size();
+    for (std::size_t index = 0; index < participants.size(); ++index) {
+        auto begin = index * share;
+        auto end = (index + 1 == participants.size()) ? count : begin + share;
+        if (begin < end) {
+            std::lock_guard<std::mutex> lock(participants[index]->rangesMutex);
+            participants[index]->ranges.push_back(Range{begin, end});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        job = &currentJob;
+        ++generation;
+    }
+    jobCondition.notify_all();
+
+    runJob(currentJob, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        job = nullptr;
+        idleCondition.wait(lock, [this] { return activeThreads == 0; });
+    }
+
+    if (currentJob.exception) {
+        std::rethrow_exception(currentJob.exception);
+    }
+}
+
+void
+ThreadPool::workerLoop(unsigned int index) {
+    unsigned long long seenGeneration = 0;
+    while (true) {
+        Job * currentJob = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [this, seenGeneration] { return stopping || (job && generation != seenGeneration); });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            currentJob = job;
+            ++activeThreads;
+        }
+
+        runJob(*currentJob, index);
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            --activeThreads;
+        }
+        idleCondition.notify_all();
+    }
+}
+
+void
+ThreadPool::runJob(Job & currentJob, unsigned int index) {
+    insideJob = true;
+    Range range;
+    while (currentJob.remaining > 0) {
+        if (!takeRange(index, range)) {
+            // the last ranges are still running elsewhere
+            std::this_thread::yield();
+            continue;
+        }
+
+        while (range.end - range.begin > currentJob.grain) {
+            auto middle = range.begin + (range.end - range.begin) / 2;
+            {
+                std::lock_guard<std::mutex> lock(participants[index]->rangesMutex);
+                participants[index]->ranges.push_back(Range{middle, range.end});
+            }
+            range.end = middle;
+        }
+
+        if (!currentJob.failed) {
+            try {
+                (*currentJob.body)(range.begin, range.end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(currentJob.exceptionMutex);
+                if (!currentJob.exception) {
+                    currentJob.exception = std::current_exception();
+                }
+                currentJob.failed = true;
+            }
+        }
+        currentJob.remaining -= range.end - range.begin;
+    }
+    insideJob = false;
+}
+
+// newest range on our own deque, else the oldest on someone else's
+bool
+ThreadPool::takeRange(unsigned int index, Range & range) {
+    {
+        auto & own = *participants[index];
+        std::lock_guard<std::mutex> lock(own.rangesMutex);
+        if (!own.ranges.empty()) {
+            range = own.ranges.back();
+            own.ranges.pop_back();
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < participants.size(); ++offset) {
+        auto & victim = *participants[(index + offset) % participants.size()];
+        std::lock_guard<std::mutex> lock(victim.rangesMutex);
+        if (!victim.ranges.empty()) {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
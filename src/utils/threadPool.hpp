@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads that share out the indices of one parallelFor at a time.
+// Every participant, the calling thread included, keeps a deque of index
+// ranges: it halves the range it takes down to the grain size, pushing the
+// upper halves onto its own deque, and once that is empty steals the oldest
+// and so largest range left on another participant's deque.
+class ThreadPool {
+    public:
+        using Body = std::function<void(std::size_t begin, std::size_t end)>;
+
+        // takes effect if called before the pool is first used, 0 picks one
+        // participant per hardware thread
+        static void setThreadCount(unsigned int threadCount);
+        static ThreadPool & instance();
+
+        // number of threads that run a parallelFor, the caller included
+        unsigned int size() const { return static_cast<unsigned int>(participants.size()); }
+
+        // runs body over every index in [0, count) and returns once all have
+        // run. The first exception body throws is rethrown here, ranges not
+        // yet started when it was thrown are skipped. Called again from
+        // inside body it runs the whole range on the calling thread.
+        void parallelFor(std::size_t count, const Body & body);
+
+        ~ThreadPool();
+
+    private:
+        class Range {
+            public:
+                std::size_t begin;
+                std::size_t end;
+        };
+
+        class Participant {
+            public:
+                std::mutex rangesMutex;
+                std::deque<Range> ranges;
+        };
+
+        class Job {
+            public:
+                const Body * body = nullptr;
+                std::size_t grain = 1;
+                std::atomic<std::size_t> remaining{0};
+                std::atomic<bool> failed{false};
+                std::exception_ptr exception;
+                std::mutex exceptionMutex;
+        };
+
+        static unsigned int requestedThreadCount;
+
+        std::vector<std::unique_ptr<Participant>> participants;
+        std::vector<std::thread> threads;
+
+        std::mutex callMutex; // one parallelFor at a time
+        std::mutex jobMutex;
+        std::condition_variable jobCondition;
+        std::condition_variable idleCondition;
+        Job * job = nullptr;
+        unsigned long long generation = 0;
+        unsigned int activeThreads = 0;
+        bool stopping = false;
+
+        explicit ThreadPool(unsigned int threadCount);
+
+        void workerLoop(unsigned int index);
+        void runJob(Job & job, unsigned int index);
+        bool takeRange(unsigned int index, Range & range);
+};
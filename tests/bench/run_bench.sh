@@ -0,0 +1,167 @@
+#!/bin/bash
+
+# Times each benchmark program phase by phase and compares the totals, and
+# peak memory, against baseline.json. Run from tests/bench, or through
+# make bench from the repository root.
+#
+#   ./run_bench.sh [-r repetitions] [-w warmups] [-t threshold%] [-f "bant flags"] [-u] [bench ...]
+#
+# Each benchmark runs warmups times unrecorded, then repetitions times with
+# -phase-times. A phase's time is its median over the repetitions, the
+# total the median of the runs' sums, and the peak RSS the largest seen.
+# A total more than threshold% and NOISE_MS over the baseline, or a peak
+# RSS more than threshold% over it, is a regression, which makes the exit
+# status 1. With -u the baseline is
+# rewritten from this run instead. Benchmarks are named by their file
+# without .bnt; by default every one in this directory runs.
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NONE='\033[0m'
+
+BANT_PATH="../../build/bant"
+BASELINE_PATH="baseline.json"
+PHASES="lex parse typecheck cps optimize resolve compile run"
+# a slower total within this many milliseconds of the baseline is noise
+NOISE_MS=2
+
+REPETITIONS=5
+WARMUPS=1
+THRESHOLD=10
+BANT_FLAGS=""
+UPDATE=false
+
+while getopts "r:w:t:f:u" option; do
+	case $option in
+		r) REPETITIONS=$OPTARG ;;
+		w) WARMUPS=$OPTARG ;;
+		t) THRESHOLD=$OPTARG ;;
+		f) BANT_FLAGS=$OPTARG ;;
+		u) UPDATE=true ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+BENCHES="$*"
+if [[ -z "$BENCHES" ]]; then
+	BENCHES=$(ls *.bnt | sed 's/\.bnt$//')
+fi
+
+if [[ ! -x "$BANT_PATH" ]]; then
+	echo -e "${RED}No bant binary at ${BANT_PATH}, build it first${NONE}"
+	exit 2
+fi
+
+# median of the numbers on stdin, one a line
+function median {
+	sort -n | awk '{ values[NR] = $1 } END {
+		if (NR == 0) { exit }
+		if (NR % 2) { print values[(NR + 1) / 2] } else { printf "%.3f\n", (values[NR / 2] + values[NR / 2 + 1]) / 2 }
+	}'
+}
+
+# the number stored under key for bench in the baseline, empty if none
+function baselineValue {
+	grep "^  \"$1\":" "$BASELINE_PATH" 2>/dev/null | grep -o "\"$2\": [0-9.]*" | awk '{ print $2 }'
+}
+
+# whether value is more than THRESHOLD percent, and more than noise, over base
+function regressed {
+	awk -v value="$1" -v base="$2" -v threshold="$THRESHOLD" -v noise="$3" 'BEGIN { exit !(base > 0 && value > base * (1 + threshold / 100) && value - base > noise) }'
+}
+
+function change {
+	awk -v value="$1" -v base="$2" 'BEGIN { if (base > 0) { printf "%+.1f%%", (value - base) / base * 100 } else { print "-" } }'
+}
+
+baselineFlags=$(grep -o '"flags": "[^"]*"' "$BASELINE_PATH" 2>/dev/null | sed 's/"flags": "\(.*\)"/\1/')
+if [[ "$UPDATE" = false && -f "$BASELINE_PATH" && "$baselineFlags" != "$BANT_FLAGS" ]]; then
+	echo -e "${YELLOW}Baseline was taken with flags \"${baselineFlags}\", not \"${BANT_FLAGS}\"${NONE}"
+fi
+
+echo -e "${YELLOW}BENCHMARKS${NONE} (${WARMUPS} warmup, ${REPETITIONS} repetitions, bant ${BANT_FLAGS:-without flags})"
+printf "%-20s" "bench"
+for phase in $PHASES; do
+	printf "%11s" "$phase"
+done
+printf "%11s%10s%12s%10s\n" "total ms" "change" "peak kB" "change"
+
+NUM_REGRESSIONS=0
+baselineEntries=()
+for bench in $BENCHES; do
+	if [[ ! -f "${bench}.bnt" ]]; then
+		echo -e "${RED}No benchmark ${bench}.bnt${NONE}"
+		exit 2
+	fi
+
+	for ((run = 0; run < WARMUPS; ++run)); do
+		$BANT_PATH $BANT_FLAGS -no-cache -f "${bench}.bnt" >/dev/null 2>&1
+	done
+
+	reports=""
+	failed=false
+	for ((run = 0; run < REPETITIONS; ++run)); do
+		report=$($BANT_PATH $BANT_FLAGS -no-cache -phase-times -f "${bench}.bnt" 2>&1 >/dev/null)
+		if [[ $? -ne 0 || "$report" != *"phase run"* ]]; then
+			failed=true
+			break
+		fi
+		reports+="run ${run}"$'\n'"${report}"$'\n'
+	done
+
+	if [[ "$failed" = true ]]; then
+		echo -e "${RED}${bench} did not run to the end${NONE}"
+		((NUM_REGRESSIONS++))
+		continue
+	fi
+
+	printf "%-20s" "$bench"
+	entry="  \"${bench}\": {"
+	for phase in $PHASES; do
+		phaseTime=$(echo "$reports" | awk -v phase="$phase" '$1 == "phase" && $2 == phase { print $3 }' | median)
+		printf "%11s" "${phaseTime:--}"
+		if [[ -n "$phaseTime" ]]; then
+			entry+="\"${phase}\": ${phaseTime}, "
+		fi
+	done
+
+	total=$(echo "$reports" | awk '$1 == "run" { if (started) printf "%.3f\n", sum; sum = 0; started = 1 } $1 == "phase" { sum += $3 } END { printf "%.3f\n", sum }' | median)
+	peakRss=$(echo "$reports" | awk '$1 == "peak_rss_kb" && $2 > peak { peak = $2 } END { print peak }')
+	entry+="\"total\": ${total}, \"peak_rss_kb\": ${peakRss}}"
+	baselineEntries+=("$entry")
+
+	baseTotal=$(baselineValue "$bench" total)
+	baseRss=$(baselineValue "$bench" peak_rss_kb)
+	printf "%11s%10s%12s%10s" "$total" "$(change "$total" "$baseTotal")" "$peakRss" "$(change "$peakRss" "$baseRss")"
+
+	if [[ "$UPDATE" = false ]] && { regressed "$total" "$baseTotal" "$NOISE_MS" || regressed "$peakRss" "$baseRss" 0; }; then
+		echo -e "  ${RED}REGRESSED${NONE}"
+		((NUM_REGRESSIONS++))
+	else
+		echo ""
+	fi
+done
+
+if [[ "$UPDATE" = true ]]; then
+	{
+		echo "{"
+		echo "  \"flags\": \"${BANT_FLAGS}\","
+		for ((index = 0; index < ${#baselineEntries[@]}; ++index)); do
+			separator=$([[ $index -lt $((${#baselineEntries[@]} - 1)) ]] && echo ",")
+			echo "${baselineEntries[$index]}${separator}"
+		done
+		echo "}"
+	} > "$BASELINE_PATH"
+	echo -e "${GREEN}Baseline written to ${BASELINE_PATH}${NONE}"
+	exit 0
+fi
+
+echo ""
+if [[ $NUM_REGRESSIONS -eq 0 ]]; then
+	echo -e "${GREEN}NO REGRESSIONS${NONE} (threshold ${THRESHOLD}%)"
+	exit 0
+fi
+echo -e "${RED}NUMBER REGRESSED: ${NUM_REGRESSIONS}${NONE} (threshold ${THRESHOLD}%)"
+exit 1
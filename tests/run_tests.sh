@@ -6,6 +6,7 @@ YELLOW='\033[1;33m'
 NONE='\033[0m'
 
 BANT_PATH="../build/bant"
+BANT_FLAGS=""
 DEBUG=false
 
 RUN_ARITH=false
@@ -22,9 +23,11 @@ RUN_ALL=false
 NUM_SUCCESSES=0
 NUM_FAILURES=0
 
+# optional fifth argument is the flag the source is passed with, -f by default
 function test {
 	sourcePath="$1/$2"
-	ret=$(echo -e "$($BANT_PATH -f $sourcePath)")
+	sourceFlag="${5:--f}"
+	ret=$(echo -e "$($BANT_PATH $BANT_FLAGS $sourceFlag $sourcePath)")
 	exp=$(echo -e "$3")
 	if [[ "$ret" == "$exp" ]] || [[ "$3" = "Error" && "${ret,,}" = *"${3,,}"* ]]; then
 		echo -e "${GREEN}\tPASSED${NONE}  $4"
@@ -84,6 +87,8 @@ function string_char_tests {
 	test $stringCharPath "string_question_escape.bnt" "question?test" "String question escape"
 	test $stringCharPath "string_normally_excluded_character.bnt" "~@$&|^," "Accept normally excluded characters"
 	test $stringCharPath "string_comment_char.bnt" "#test" "Comment delimiter in string"
+	test $stringCharPath "string_builder.bnt" "start 0987\n654321098765432\n321098\n1\ntrue\ntrue" "Strings built by repeated concat, sliced and indexed"
+	test $stringCharPath "substr_out_of_range.bnt" "Error" "Reject substr range past the end of the string"
 	echo ""
 }
 
@@ -120,6 +125,7 @@ function match_tests {
 	matchPath="./match_tests"
 	echo -e "${YELLOW}\tcorrect${NONE}"
 	test $matchPath "match_case_below_any.bnt" "Error" "Match case below any"
+	test $matchPath "match_literal_arms.bnt" "50\n24\n26\n340\n2" "Dense, sparse, char, string and bool literal arms"
 	echo ""
 	#echo -e "${YELLOW}\terror${NONE}"
 	#echo ""
@@ -147,19 +153,44 @@ function builtins_tests {
 	echo -e "${YELLOW}\tprintList - correct${NONE}"
 	test $builtinsPath "print_nested_list.bnt" "(((1, 2), (3, 4, 5)), ((6), (7)))" "nested list"
 	echo ""
+	echo -e "${YELLOW}\tlist updates - correct${NONE}"
+	test $builtinsPath "persistent_list_versions.bnt" "4950\n5900\n1000\n21" "earlier versions unchanged"
+	echo ""
+	echo -e "${YELLOW}\tint list kernels - correct${NONE}"
+	test $builtinsPath "int_list_kernels.bnt" "4220\n-1000\n1000\n-1000\n1000\n0\ntrue" "sum, min, max, sorts and reverse of a long list"
+	echo ""
+	echo -e "${YELLOW}\tfused pipelines - correct${NONE}"
+	test $builtinsPath "fused_pipelines.bnt" "15664\n2050333330\n(4, 16)\n4\n16\n36\n3" "chains of map, filter, generate, foldl, sum and foreach"
+	test $builtinsPath "fused_pipelines_effects.bnt" "0\n1\n2\n0\n100\n200\n(0, 100, 200)" "chain whose functions print runs step after step"
+	echo ""
 	echo -e "${YELLOW}\tfold - correct${NONE}"
 	test "${builtinsPath}" "foldr_string.bnt" "ABCz" "foldr string"
 	test "${builtinsPath}" "foldl_string.bnt" "zABC" "foldl string"
 	echo ""
+	echo -e "${YELLOW}\tparallel - correct${NONE}"
+	test $builtinsPath "parallel_builtins.bnt" "1050666640\n1050666640\nzABCDE" "same results as serial builtins"
+	echo ""
+	echo -e "${YELLOW}\tfile I/O - correct${NONE}"
+	test $builtinsPath "file_io.bnt" "true\n1000\nline 1\nline 1000\n100\n8893" "writeFile lines, read back with readLines and readFile"
+	rm -f bant_file_io_test.txt
+	echo ""
+	echo -e "${YELLOW}\tfile I/O - error${NONE}"
+	test $builtinsPath "read_missing_file.bnt" "Error" "readLines of a missing file"
+	echo ""
 	echo -e "${YELLOW}\tzip - correct${NONE}"
 	test $builtinsPath "zip_int_char.bnt" "((1, 'a'), (2, 'b'), (3, 'c'))" "int and char"
 	echo ""
 	echo -e "${YELLOW}\tunion - correct${NONE}"
 	test "${builtinsPath}" "union_int.bnt" "(1, 2, 3, 4, 5, 6)" "int"
+	test "${builtinsPath}" "union_string.bnt" "(\"b\", \"a\", \"c\")" "string"
 	echo ""
 	echo -e "${YELLOW}\tintersect - correct${NONE}"
 	test "${builtinsPath}" "intersection_int.bnt" "(2, 3, 4, 6)" "int"
 	echo ""
+	echo -e "${YELLOW}\tSet and Map - correct${NONE}"
+	test "${builtinsPath}" "set_of_lists.bnt" "2\ntrue\nfalse\ntrue" "set of lists"
+	test "${builtinsPath}" "map_string_int.bnt" "2\n5\nfalse\n2" "map from string to int"
+	echo ""
 	echo -e "${YELLOW}\tequals - correct${NONE}"
 	test "${builtinsPath}/equals" "equals_list_int.bnt" "false\ntrue" "int lists"
 	test "${builtinsPath}/equals" "equals_tuple.bnt" "false\nfalse\ntrue" "Tuples"
@@ -174,11 +205,26 @@ function func_tests {
 	test $functionPath "recursive_func.bnt" "0" "Recursive function"
 	test $functionPath "mutually_recursive.bnt" "-1" "Mutually recursive functions"
 	test $functionPath "mutually_recursive_separate_scope.bnt" "-1" "Mutually recursive functions, in separate program expression blocks"
+	test $functionPath "forward_reference_nested.bnt" "106" "Nested function calling one declared in a later block"
+	test $functionPath "deep_tail_recursion.bnt" "100000\nfalse" "Deep self and mutual tail recursion"
+	test $functionPath "inline_shadowing.bnt" "20\n19" "Calls to functions using an outer name shadowed at the call site"
 	test $functionPath "func_list_return.bnt" "3" "List of func - call"
 	test $functionPath "fib.bnt" "34" "Fibonacci, check that arguments are passed by value (copy)"
+	test $functionPath "diamond_import.bnt" "7\n5" "Two imported files importing the same file"
+	test $functionPath "batch.manifest" "4\n--- ok func_tests/batch_fresh_state.bnt\n34\n--- ok func_tests/fib.bnt\n4\n--- ok func_tests/batch_fresh_state.bnt\n34\n--- ok func_tests/fib.bnt" "Batch of scripts, each run from a fresh state" "-batch"
+	test $functionPath "batch_builtin_error.manifest" "4\n--- ok func_tests/batch_fresh_state.bnt\n\033[1;31mLine: 1, Column: 22\nError: Invalid range: printString(substr(\"abcdef\"\nprintString(substr(\"abcdef\"\n\033[0m\n\033[1;31mExiting.\033[0m\n--- error string_char_tests/substr_out_of_range.bnt\n34\n--- ok func_tests/fib.bnt" "Batch goes on past a script stopped by a builtin error" "-batch"
+	test $functionPath "deep_tail_recursion.bnt" "100000\nfalse" "Profiling leaves program output unchanged" "-profile /tmp/bant_test_profile.folded -f"
+	test $functionPath "closure_cycles.bnt" "25005000\n15\n13" "Closures over frames collected while others are in use"
+	test $functionPath "closure_cycles.bnt" "25005000\n15\n13" "Memory report leaves program output unchanged" "-mem-stats -f"
+	test $functionPath "memo_fib.bnt" "1134903170\n102334155\n267914296" "Memo funcs, one cache per closure"
+	echo ""
+	echo -e "${YELLOW}\terror${NONE}"
+	test $functionPath "import_cycle.bnt" "Error" "Reject files importing each other"
+	test $functionPath "memo_io.bnt" "Error" "Reject memo func reaching I/O through the functions it calls"
+	test $functionPath "memo_io_val.bnt" "Error" "Reject memo func reaching I/O through a function held in a val"
+	test $functionPath "memo_captured_list.bnt" "Error" "Reject memo func reading a List from outside it"
+	test $functionPath "memo_sort_reverse.bnt" "Error" "Reject memo func calling builtins that sort or reverse a list in place"
 	echo ""
-	#echo -e "${YELLOW}\terror${NONE}"
-	#echo ""
 }
 
 function template_tests {
@@ -204,6 +250,7 @@ function typeclass_tests {
 	echo -e "${YELLOW}\tcorrect${NONE}"
 	test $typeclassPath "car.bnt" "2020\nHonda Civic" "Car"
 	test $typeclassPath "point.bnt" "2" "Point"
+	test $typeclassPath "typeclass_field_offsets.bnt" "500500\n14\ntrue\nAda" "Typeclass fields by offset"
 	echo ""
 	echo -e "${YELLOW}\terror${NONE}"
 	test $typeclassPath "typeclass_match_generic_type.bnt" "Error" "Reject mismatch typeclass for generic parameter"
@@ -251,6 +298,10 @@ do
 	if [[ "$var" == "-c" ]]; then
 		RUN_TYPECLASS=true
 	fi
+
+	if [[ "$var" == "-vm" || "$var" == "-O1" || "$var" == "-O2" ]]; then
+		BANT_FLAGS="$BANT_FLAGS $var"
+	fi
 done
 
 if [[ "$RUN_ARITH" = false && 